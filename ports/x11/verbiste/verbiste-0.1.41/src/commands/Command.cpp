@@ -34,8 +34,11 @@ namespace verbiste {
 
 Command::Command(const string &conjugationFilename,
                  const string &verbsFilename,
-                 FrenchVerbDictionary::Language _lang) throw (logic_error)
-  : fvd(new FrenchVerbDictionary(conjugationFilename, verbsFilename, false, _lang)),
+                 FrenchVerbDictionary::Language _lang,
+                 bool loadDictionary) throw (logic_error)
+  : fvd(loadDictionary
+        ? new FrenchVerbDictionary(conjugationFilename, verbsFilename, false, _lang)
+        : NULL),
                 // command-line tools do not tolerate missing accents
     lang(_lang)
 {
@@ -56,9 +59,6 @@ Command::run(int argc, char *argv[]) throw()
 
     try
     {
-        if (fvd == NULL)
-            throw logic_error("fvd is NULL");
-
         for (;;)
         {
             string inputWord;
@@ -114,9 +114,25 @@ int Command::listAllInfinitives(std::ostream &out) const
 {
     (void) getFrenchVerbDictionary();  // to check that fvd is not null
 
-    for (VerbTable::const_iterator it = fvd->beginKnownVerbs();
-                                  it != fvd->endKnownVerbs(); ++it)
-        out << it->first << '\n';
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
+        out << knownVerbs.getInfinitive(id) << '\n';
+
+    return EXIT_SUCCESS;
+}
+
+
+int Command::listVerbsOfTemplate(std::ostream &out,
+                                 const std::string &templateName) const
+                                                throw (std::logic_error)
+{
+    (void) getFrenchVerbDictionary();  // to check that fvd is not null
+
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    unsigned templateId = knownVerbs.findTemplate(templateName);
+    size_t numVerbs = knownVerbs.getNumVerbsOfTemplate(templateId);
+    for (size_t i = 0; i < numVerbs; ++i)
+        out << knownVerbs.getInfinitive(knownVerbs.getVerbOfTemplate(templateId, i)) << '\n';
 
     return EXIT_SUCCESS;
 }
@@ -53,13 +53,17 @@ public:
                                     defines all the known verbs and their
                                     corresponding template
         @param  lang                language of the dictionary
+        @param  loadDictionary      if false, the dictionary is not loaded
+                                    and fvd is NULL: the derived class
+                                    processes the words without it
         @throws std::logic_error    error message related to a failure to
                                     construct the FrenchVerbDictionary
                                     object
     */
     Command(const std::string &conjugationFilename,
             const std::string &verbsFilename,
-            FrenchVerbDictionary::Language lang) throw (std::logic_error);
+            FrenchVerbDictionary::Language lang,
+            bool loadDictionary = true) throw (std::logic_error);
 
     /** Destroys the Verbiste dictionary object.
     */
@@ -100,6 +104,19 @@ public:
     */
     int listAllInfinitives(std::ostream &out) const throw (std::logic_error);
 
+    /** Prints the name of every known verb that uses a template
+        to the designated text stream, in increasing order.
+        Each printed infinitive is separated by a newline sequence.
+        @param  templateName    name of the template (e.g., "aim:er")
+        @returns EXIT_SUCCESS or EXIT_FAILURE
+        @throws        std::logic_error error message indicating that
+                                        the constructor failed to create
+                                        the dictionary object
+    */
+    int listVerbsOfTemplate(std::ostream &out,
+                            const std::string &templateName) const
+                                                throw (std::logic_error);
+
     /** Returns the value of the named environment variable.
         @param      name                non-empty name of the variable
         @param      defaultValue        optional default value to return
@@ -121,6 +138,7 @@ protected:
 
 
     /** Instance of the Verbiste dictionary to use to process the words.
+        NULL if the constructor was asked not to load it.
     */
     FrenchVerbDictionary *fvd;
 
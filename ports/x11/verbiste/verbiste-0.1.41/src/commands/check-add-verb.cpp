@@ -0,0 +1,116 @@
+#include <verbiste/FrenchVerbDictionary.h>
+#include <verbiste/MultiLanguageIndex.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+using namespace std;
+using namespace verbiste;
+
+
+static int numFailures = 0;
+
+
+static void
+check(bool condition, const char *description)
+{
+    if (!condition)
+    {
+        cerr << "check-add-verb: failed: " << description << endl;
+        ++numFailures;
+    }
+}
+
+
+static bool
+hasTemplate(const FrenchVerbDictionary &fvd,
+            const string &infinitive, const string &templateName)
+{
+    vector<string> names;
+    fvd.getKnownVerbs().getTemplateNames(infinitive, names);
+    return find(names.begin(), names.end(), templateName) != names.end();
+}
+
+
+static bool
+deconjugatesTo(const FrenchVerbDictionary &fvd,
+               const string &conjugatedVerb, const string &infinitive)
+{
+    vector<InflectionDesc> results;
+    fvd.deconjugate(conjugatedVerb, results);
+    for (vector<InflectionDesc>::const_iterator it = results.begin();
+                                                it != results.end(); ++it)
+        if (it->infinitive == infinitive)
+            return true;
+    return false;
+}
+
+
+static void
+checkAddVerb(FrenchVerbDictionary &fvd)
+{
+    // Templates whose radical is empty.
+    try
+    {
+        fvd.addVerb("avoir", ":avoir", false);
+        fvd.addVerb("aller", ":aller", false);
+    }
+    catch (const logic_error &e)
+    {
+        cerr << "check-add-verb: " << e.what() << endl;
+        ++numFailures;
+    }
+    check(deconjugatesTo(fvd, "eussiez", "avoir"), "avoir before rebuild");
+    fvd.rebuildVerbIndex();
+    check(deconjugatesTo(fvd, "eussiez", "avoir"), "avoir after rebuild");
+    check(deconjugatesTo(fvd, "irions", "aller"), "aller after rebuild");
+
+    // Invalid UTF-8 is reported as a logic_error.
+    bool rejected = false;
+    try
+    {
+        fvd.addVerb("\xff\xfe" "er", "aim:er", false);
+    }
+    catch (const logic_error &)
+    {
+        rejected = true;
+    }
+    check(rejected, "invalid UTF-8 rejected");
+
+    // "mater" is also the unaccented form of "mâter": changing the
+    // template of the latter must keep the former.
+    check(fvd.getVerbTemplateSet("mâter").count("aim:er") == 1, "deprecated template set");
+    fvd.addVerb("mâter", "est:er", false);
+    fvd.rebuildVerbIndex();
+    check(fvd.getVerbTemplateSet("mâter").count("est:er") == 1, "deprecated template set updated");
+    check(size_t(distance(fvd.beginKnownVerbs(), fvd.endKnownVerbs()))
+          == fvd.getKnownVerbs().size(), "deprecated verb table");
+    check(hasTemplate(fvd, "mater", "aim:er"), "mater kept");
+    check(hasTemplate(fvd, "mâter", "est:er"), "mâter changed");
+    check(!hasTemplate(fvd, "mâter", "aim:er"), "mâter template removed");
+    check(deconjugatesTo(fvd, "materions", "mater"), "mater deconjugated");
+    check(deconjugatesTo(fvd, "aimions", "aimer"), "other verbs kept");
+}
+
+
+int
+main()
+{
+    FrenchVerbDictionary fvd(true);
+    checkAddVerb(fvd);
+
+    // The compiled dictionary loads its indexes, and only fills the
+    // trie of its radicals when its verbs change.
+    //
+    FrenchVerbDictionary compiled(FrenchVerbDictionary::FRENCH, true);
+    {
+        vector<const FrenchVerbDictionary *> dictionaries(1, &compiled);
+        MultiLanguageIndex index(dictionaries);
+        check(index.findDictionaries("aimions") == 1, "compiled radicals merged");
+    }
+    checkAddVerb(compiled);
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace verbiste;
+
+
+static int numFailures = 0;
+
+
+static void
+check(bool condition, const string &description)
+{
+    if (!condition)
+    {
+        cerr << "check-compiled-data: failed: " << description << endl;
+        ++numFailures;
+    }
+}
+
+
+// Checks that the compiled dictionary ranks the same verbs, in the same
+// order, as the dictionary that loads the XML files and the frequency file.
+//
+static void
+checkFrequencyRanks(FrenchVerbDictionary::Language lang)
+{
+    const string code = FrenchVerbDictionary::getLanguageCode(lang);
+    string conjFN, verbsFN;
+    FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
+    FrenchVerbDictionary xml(conjFN, verbsFN, false, lang);
+    FrenchVerbDictionary compiled(lang, false);
+
+    const size_t numRanked = xml.getKnownVerbs().getNumRankedVerbs();
+    check(compiled.getKnownVerbs().getNumRankedVerbs() == numRanked,
+          code + ": number of ranked verbs");
+
+    vector<string> xmlVerbs, compiledVerbs;
+    xml.getMostFrequentVerbs(numRanked, xmlVerbs);
+    compiled.getMostFrequentVerbs(numRanked, compiledVerbs);
+    check(compiledVerbs == xmlVerbs, code + ": order of the ranked verbs");
+    for (size_t i = 0; i < xmlVerbs.size(); ++i)
+        check(compiled.getFrequencyRank(xmlVerbs[i]) == xml.getFrequencyRank(xmlVerbs[i]),
+              code + ": rank of " + xmlVerbs[i]);
+}
+
+
+int
+main()
+{
+    checkFrequencyRanks(FrenchVerbDictionary::FRENCH);
+    checkFrequencyRanks(FrenchVerbDictionary::ITALIAN);
+    checkFrequencyRanks(FrenchVerbDictionary::GREEK);
+
+    // The distribution has frequencies for French.
+    //
+    FrenchVerbDictionary compiled(FrenchVerbDictionary::FRENCH, false);
+    check(compiled.hasVerbFrequencies(), "fr: compiled frequencies");
+
+    return numFailures == 0 ? 0 : 1;
+}
@@ -1,4 +1,5 @@
 #include <verbiste/FrenchVerbDictionary.h>
+#include <verbiste/DictionaryHolder.h>
 
 void dummy()
 {
@@ -6,6 +7,8 @@ void dummy()
 
     FrenchVerbDictionary fvd0(true);
     FrenchVerbDictionary fvd1("", "", true, FrenchVerbDictionary::GREEK);
+    FrenchVerbDictionary fvd2(FrenchVerbDictionary::ITALIAN, false);
+    DictionaryHolder holder("", "", false, FrenchVerbDictionary::FRENCH);
 }
 
 int main()
@@ -22,6 +22,9 @@
 
 #include "gui/conjugation.h"
 #include "verbiste/FrenchVerbDictionary.h"
+#include "verbiste/ConjugationCache.h"
+#include "verbiste/DeconjugationResults.h"
+#include "verbiste/DictionaryHolder.h"
 
 #include <libintl.h>
 #include <locale.h>
@@ -35,14 +38,25 @@ class ConsoleApp
 {
 public:
 
-    ConsoleApp(verbiste::FrenchVerbDictionary &_fvd)
-    :   fvd(_fvd),
-        includePronouns(false)
+    ConsoleApp(verbiste::DictionaryHolder &_holder)
+    :   holder(_holder),
+        fvdHandle(),
+        includePronouns(false),
+        reloadRequested(false),
+        cache(NULL)
     {
     }
 
+    ~ConsoleApp()
+    {
+        delete cache;
+    }
+
     void processCommand(const string &utf8Command)
     {
+        refreshDictionary();
+        const verbiste::FrenchVerbDictionary &fvd = *fvdHandle;
+
         string lowerCaseUTF8Command = fvd.wideToUTF8(
                                         fvd.tolowerWide(
                                           fvd.utf8ToWide(utf8Command)));
@@ -57,38 +71,59 @@ public:
             includePronouns = false;
             return;
         }
+        if (lowerCaseUTF8Command == "/reload")
+        {
+            // The current dictionary keeps serving the commands
+            // until the new one is loaded.
+            if (holder.isReloading())
+            {
+                cerr << PACKAGE_FULL_NAME << ": reload already in progress" << endl;
+                return;
+            }
+            try
+            {
+                reloadRequested = holder.startReload() || reloadRequested;
+            }
+            catch (const logic_error &e)
+            {
+                cerr << PACKAGE_FULL_NAME << ": reload failed: " << e.what() << endl;
+            }
+            return;
+        }
 
         bool isItalian = (fvd.getLanguage() == verbiste::FrenchVerbDictionary::ITALIAN);
 
         /*
             For each possible deconjugation, take the infinitive form and
-            obtain its complete conjugation.
+            obtain its complete conjugation.  The other inflections of
+            the same verb would give the same conjugation.
         */
-        vector<InflectionDesc> v;
-        fvd.deconjugate(lowerCaseUTF8Command, v);
+        verbiste::DeconjugationResults results;
+        results.setUniqueLemmas(true);
+        fvd.deconjugate(lowerCaseUTF8Command, results);
 
         string prevUTF8Infinitive;
         size_t numPages = 0;
 
         cout << "<result input='" << utf8Command << "'>\n";
 
-        for (vector<InflectionDesc>::const_iterator it = v.begin();
-                                                    it != v.end(); it++)
+        for (size_t r = 0; r < results.size(); r++)
         {
-            const InflectionDesc &d = *it;
-
-            VVVS conjug;
-            getConjugation(fvd, d.infinitive, d.templateName, conjug, includePronouns);
-
-            if (conjug.size() == 0           // if no tenses
-                || conjug[0].size() == 0     // if no infinitive tense
-                || conjug[0][0].size() == 0  // if no person in inf. tense
-                || conjug[0][0][0].empty())  // if infinitive string empty
+            // The pronouns are always generated, then shown or not.
+            verbiste::ConjugationCache::Handle handle =
+                    cache->getConjugation(results.getInfinitive(r),
+                                          results.getTemplateName(r), true);
+            const ConjugationBuffer &conjug = *handle;
+
+            if (conjug.getNumTenses() == 0              // if no tenses
+                || conjug.getNumPersons(0) == 0         // if no infinitive tense
+                || conjug.getNumForms(0, 0) == 0        // if no person in inf. tense
+                || conjug.getFormLength(0, 0, 0) == 0)  // if infinitive string empty
             {
                 continue;
             }
 
-            string utf8Infinitive = conjug[0][0][0];
+            string utf8Infinitive = conjug.getForm(0, 0, 0);
 
             if (utf8Infinitive == prevUTF8Infinitive)
                 continue;
@@ -97,8 +132,7 @@ public:
             numPages++;
 
             int i = 0;
-            for (VVVS::const_iterator t = conjug.begin();
-                                    t != conjug.end(); t++, i++)
+            for (size_t t = 0; t < conjug.getNumTenses(); t++, i++)
             {
                 if (i == 1)
                     i = 4;
@@ -114,11 +148,12 @@ public:
                     continue;
 
                 string utf8Persons = createTableCellText(
-                                                fvd,
-                                                *t,
+                                                conjug,
+                                                t,
                                                 lowerCaseUTF8Command,
                                                 "*",
-                                                "");
+                                                "",
+                                                includePronouns);
 
                 cout << "<tense name='" << utf8TenseName << "'>\n";
                 cout << utf8Persons << "\n";
@@ -136,9 +171,40 @@ public:
 
 private:
 
-    verbiste::FrenchVerbDictionary &fvd;
+    // Switches to the holder's current dictionary if it has been
+    // reloaded since the last command.
+    //
+    void refreshDictionary()
+    {
+        if (reloadRequested && !holder.isReloading())
+        {
+            reloadRequested = false;
+            string errorMessage;
+            if (!holder.waitForReload(errorMessage))
+                cerr << PACKAGE_FULL_NAME << ": reload failed: " << errorMessage << endl;
+        }
+
+        verbiste::DictionaryHolder::Handle h = holder.get();
+        if (!fvdHandle.isNull()
+                && h.getGenerationNumber() == fvdHandle.getGenerationNumber())
+            return;
+
+        delete cache;  // its tables come from the previous dictionary
+        cache = NULL;
+        fvdHandle = h;
+        cache = new verbiste::ConjugationCache(*fvdHandle, 256);
+        (void) cache->prewarm(64, true);  // the most frequent verbs, if known
+    }
+
+    verbiste::DictionaryHolder &holder;
+    verbiste::DictionaryHolder::Handle fvdHandle;  // dictionary in use
     bool includePronouns;
+    bool reloadRequested;
+    verbiste::ConjugationCache *cache;  // the same verbs are often requested
 
+    // Forbidden operations:
+    ConsoleApp(const ConsoleApp &);
+    ConsoleApp &operator = (const ConsoleApp &);
 };
 
 
@@ -152,7 +218,7 @@ main(int /*argc*/, char * /*argv*/[])
 
     using namespace verbiste;
 
-    FrenchVerbDictionary *fvd;
+    DictionaryHolder *holder;
     try
     {
         const char *langCode = getenv("VERBISTE_LANG");
@@ -165,7 +231,7 @@ main(int /*argc*/, char * /*argv*/[])
             lang = FrenchVerbDictionary::FRENCH;
 
         FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
-        fvd = new FrenchVerbDictionary(conjFN, verbsFN, true, lang);  // may throw
+        holder = new DictionaryHolder(conjFN, verbsFN, true, lang);  // may throw
     }
     catch(logic_error &e)
     {
@@ -173,7 +239,7 @@ main(int /*argc*/, char * /*argv*/[])
         return EXIT_FAILURE;
     }
 
-    ConsoleApp app(*fvd);
+    ConsoleApp app(*holder);
 
     string utf8Command;
     while (getline(cin, utf8Command))
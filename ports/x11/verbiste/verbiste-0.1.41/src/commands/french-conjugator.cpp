@@ -59,6 +59,8 @@ static struct option knownOptions[] =
     { "template",       required_argument,      NULL, 'e' },
     { "pronouns",       no_argument,            NULL, 'p' },
     { "all-infinitives",no_argument,            NULL, 'i' },
+    { "verbs-of-template",required_argument,    NULL, 'b' },
+    { "stats",          no_argument,            NULL, 'S' },
 
     { NULL, 0, NULL, 0 }  // marks the end
 };
@@ -162,47 +164,9 @@ ConjugatorCommand::displayConjugation(FrenchVerbDictionary &fvd,
 
         string radical = FrenchVerbDictionary::getRadical(infinitive, tname);
 
-        if (lang == FrenchVerbDictionary::FRENCH || lang == FrenchVerbDictionary::ITALIAN)
-        {
-            displayTense(fvd, radical, templ, INFINITIVE_MODE, PRESENT_TENSE);
-
-            displayTense(fvd, radical, templ, INDICATIVE_MODE, PRESENT_TENSE);
-            displayTense(fvd, radical, templ, INDICATIVE_MODE, IMPERFECT_TENSE);
-            displayTense(fvd, radical, templ, INDICATIVE_MODE, FUTURE_TENSE);
-            displayTense(fvd, radical, templ, INDICATIVE_MODE, PAST_TENSE);
-
-            displayTense(fvd, radical, templ, CONDITIONAL_MODE, PRESENT_TENSE);
-
-            displayTense(fvd, radical, templ, SUBJUNCTIVE_MODE, PRESENT_TENSE);
-            displayTense(fvd, radical, templ, SUBJUNCTIVE_MODE, IMPERFECT_TENSE);
-
-            displayTense(fvd, radical, templ, IMPERATIVE_MODE, PRESENT_TENSE);
-
-            displayTense(fvd, radical, templ, PARTICIPLE_MODE, PRESENT_TENSE);
-            displayTense(fvd, radical, templ, PARTICIPLE_MODE, PAST_TENSE);
-        }
-        if (lang == FrenchVerbDictionary::ITALIAN)
-            displayTense(fvd, radical, templ, GERUND_MODE, PRESENT_TENSE);
-
-        if (lang == FrenchVerbDictionary::GREEK)
-        {
-            displayTense(fvd, radical, templ, PRESENT_INDICATIVE, ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_INDICATIVE, PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_SUBJUNCTIVE, ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_SUBJUNCTIVE, PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_IMPERATIVE, IMPERATIVE_ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_IMPERATIVE, IMPERATIVE_PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PRESENT_GERUND, PRESENT_TENSE);
-            displayTense(fvd, radical, templ, PAST_IMPERFECT_INDICATIVE, ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_IMPERFECT_INDICATIVE, PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_INDICATIVE, ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_INDICATIVE, PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_SUBJUNCTIVE, ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_SUBJUNCTIVE, PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_IMPERATIVE, IMPERATIVE_ACTIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_IMPERATIVE, IMPERATIVE_PASSIVE_TENSE);
-            displayTense(fvd, radical, templ, PAST_PERFECT_INFINITIVE, PAST_PERFECT);
-        }
+        for (const ModeTense *mt = FrenchVerbDictionary::getConjugationTenses(lang);
+                                                mt->mode != INVALID_MODE; ++mt)
+            displayTense(fvd, radical, templ, mt->mode, mt->tense);
     }
     catch (logic_error &e)
     {
@@ -215,28 +179,24 @@ ConjugatorCommand::displayConjugation(FrenchVerbDictionary &fvd,
 void
 ConjugatorCommand::processInputWord(const string &inputWord)
 {
-    const char *tname = (reqTemplate.empty() ? NULL : reqTemplate.c_str());
-    const std::set<std::string> *templateSet = NULL;
-    std::set<std::string> singleton;
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    VerbRecordTable::VerbId id = VerbRecordTable::NO_VERB;
+    size_t numTemplates = 1;
 
-    if (tname == NULL)  // if no specific template requested
-    {
-        // Use the template associated with the verb, if known:
-        templateSet = &fvd->getVerbTemplateSet(inputWord);
-    }
-    else
+    if (reqTemplate.empty())  // if no specific template requested
     {
-        singleton.insert(tname);
-        templateSet = &singleton;
+        // Use the templates associated with the verb, if known:
+        id = knownVerbs.find(inputWord);
+        numTemplates = knownVerbs.getNumTemplates(id);
     }
 
-    for (std::set<std::string>::const_iterator it = templateSet->begin();
-                                               it != templateSet->end(); ++it)
+    for (size_t i = 0; i < numTemplates; ++i)
     {
-        if (it != templateSet->begin())
+        if (i != 0)
             cout << "-\n";  // separate conjugations
 
-        const string &tname = *it;
+        const string &tname = (id == VerbRecordTable::NO_VERB
+                               ? reqTemplate : knownVerbs.getTemplateName(id, i));
         const TemplateSpec *templ = fvd->getTemplate(tname);
 
         if (templ != NULL)
@@ -286,6 +246,11 @@ displayHelp()
 "--template=T       Use template T to conjugate the verbs\n"
 "--pronouns         Include pronouns in the displayed conjugation\n"
 "--all-infinitives  Print the names of all known verbs, one per line (unsorted)\n"
+"--verbs-of-template=T\n"
+"                   Print the names of the known verbs that use template T,\n"
+"                   one per line (sorted)\n"
+"--stats            Print the load times and the query statistics of the\n"
+"                   dictionary to the standard error output at the end\n"
 "\n"
 "See the " << commandName << "(1) manual page for details.\n"
 "\n"
@@ -305,6 +270,8 @@ main(int argc, char *argv[])
     string reqTemplate;
     bool includePronouns = false;
     bool listAllInfinitives = false;
+    bool printStats = false;
+    string verbsOfTemplate;
     string langCode = "fr";
 
     #if defined(ENABLE_NLS) && defined(HAVE_GETOPT_LONG)
@@ -370,6 +337,14 @@ main(int argc, char *argv[])
                     listAllInfinitives = true;
                     break;
 
+                case 'b':
+                    verbsOfTemplate = optarg;
+                    break;
+
+                case 'S':
+                    printStats = true;
+                    break;
+
                 default:
                     displayHelp();
                     return EXIT_FAILURE;
@@ -402,6 +377,17 @@ main(int argc, char *argv[])
         if (listAllInfinitives)
             return cmd.listAllInfinitives(cout);
 
+        if (!verbsOfTemplate.empty())
+        {
+            if (cmd.getFrenchVerbDictionary().getTemplate(verbsOfTemplate) == NULL)
+            {
+                cerr << commandName << ": invalid conjugation template "
+                                                << verbsOfTemplate << "\n";
+                return EXIT_FAILURE;
+            }
+            return cmd.listVerbsOfTemplate(cout, verbsOfTemplate);
+        }
+
         cmd.reqMode = reqMode;
         cmd.reqTense = reqTense;
         cmd.reqTemplate = reqTemplate;
@@ -415,7 +401,14 @@ main(int argc, char *argv[])
             return EXIT_FAILURE;
         }
 
-        return cmd.run(argc - optind, argv + optind);
+        if (!printStats)
+            return cmd.run(argc - optind, argv + optind);
+
+        DictionaryStats &stats = cmd.getFrenchVerbDictionary().getStats();
+        stats.setEnabled(true);
+        int status = cmd.run(argc - optind, argv + optind);
+        stats.print(cerr);
+        return status;
     }
     catch (const exception &e)
     {
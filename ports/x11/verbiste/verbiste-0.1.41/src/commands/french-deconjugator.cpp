@@ -23,6 +23,10 @@
 
 #include "Command.h"
 
+#include <verbiste/PhraseAnalyzer.h>
+#include <verbiste/DeconjugationResults.h>
+#include <verbiste/SharedDictionary.h>
+
 #ifdef ENABLE_NLS
 #ifdef HAVE_GETOPT_LONG
 #include <unistd.h>
@@ -37,6 +41,7 @@
 
 #include <iostream>
 #include <vector>
+#include <stdlib.h>
 #include <string.h>
 
 using namespace std;
@@ -53,6 +58,11 @@ static struct option knownOptions[] =
     { "version",         no_argument,       NULL, 'v' },
     { "lang",            required_argument, NULL, 'l' },
     { "all-infinitives", no_argument,       NULL, 'i' },
+    { "phrases",         no_argument,       NULL, 'p' },
+    { "limit",           required_argument, NULL, 'n' },
+    { "unique",          no_argument,       NULL, 'u' },
+    { "shared",          no_argument,       NULL, 's' },
+    { "stats",           no_argument,       NULL, 'S' },
 
     { NULL, 0, NULL, 0 }  // marks the end
 };
@@ -63,21 +73,59 @@ class DeconjugatorCommand : public Command
 {
 public:
 
+    // If 'sharedName' is not empty, the words are deconjugated with
+    // the shared image of that name, and the dictionary is not loaded.
+    //
     DeconjugatorCommand(const string &conjugationFilename,
                         const string &verbsFilename,
-                        FrenchVerbDictionary::Language lang) throw(logic_error)
-      : Command(conjugationFilename, verbsFilename, lang)
+                        FrenchVerbDictionary::Language lang,
+                        bool analyzePhrases,
+                        size_t _limit,
+                        bool _uniqueLemmas,
+                        const string &sharedName) throw(logic_error)
+      : Command(conjugationFilename, verbsFilename, lang, sharedName.empty()),
+        sharedDictionary(sharedName.empty()
+                         ? NULL
+                         : SharedDictionary::open(sharedName,
+                                                  conjugationFilename, verbsFilename,
+                                                  false, lang)),
+        phraseAnalyzer(analyzePhrases ? new PhraseAnalyzer(*fvd) : NULL),
+        results(),
+        sharedResults(),
+        limit(_limit),
+        uniqueLemmas(_uniqueLemmas)
     {
+        results.setLimit(limit);
+        results.setUniqueLemmas(uniqueLemmas);
     }
 
     virtual ~DeconjugatorCommand()
     {
+        delete phraseAnalyzer;
+        delete sharedDictionary;
     }
 
 protected:
 
     virtual void processInputWord(const std::string &inputWord);
 
+private:
+
+    void processInputPhrase(const std::string &inputPhrase);
+    void processSharedInputWord(const std::string &inputWord);
+    static void printAnalysis(const std::string &infinitive,
+                              const ModeTensePersonNumber &mtpn);
+
+    SharedDictionary *sharedDictionary;  // NULL if fvd is used
+    PhraseAnalyzer *phraseAnalyzer;  // NULL if words are deconjugated alone
+    DeconjugationResults results;  // reused for each word
+    vector<InflectionDesc> sharedResults;  // reused for each word
+    size_t limit;
+    bool uniqueLemmas;
+
+    // Forbidden operations:
+    DeconjugatorCommand(const DeconjugatorCommand &);
+    DeconjugatorCommand &operator = (const DeconjugatorCommand &);
 };
 
 
@@ -85,22 +133,117 @@ protected:
 void
 DeconjugatorCommand::processInputWord(const string &inputWord)
 {
-    // Analyze the word and get the results in a vector:
-    vector<InflectionDesc> v;
-    fvd->deconjugate(inputWord, v);
+    if (phraseAnalyzer != NULL)
+    {
+        processInputPhrase(inputWord);
+        return;
+    }
+    if (sharedDictionary != NULL)
+    {
+        processSharedInputWord(inputWord);
+        return;
+    }
+
+    // Analyze the word and get the ranked results:
+    fvd->deconjugate(inputWord, results);
 
+    for (size_t i = 0; i < results.size(); i++)
+        printAnalysis(results.getInfinitive(i), results.getModeTensePersonNumber(i));
+    cout << endl;
+}
 
-    for (vector<InflectionDesc>::const_iterator it = v.begin();
+
+// Ranks and filters the analyses like DeconjugationResults: the correct
+// spellings first, then the most frequent verbs, the order of the
+// dictionary being kept otherwise.  Since missing accents are not
+// tolerated, the radicals are always correct.
+//
+void
+DeconjugatorCommand::processSharedInputWord(const string &inputWord)
+{
+    sharedResults.clear();
+    sharedDictionary->deconjugate(inputWord, sharedResults);
+
+    vector<unsigned> ranks(sharedResults.size(), VerbRecordTable::NO_RANK);
+    if (sharedResults.size() > 1)
+        for (size_t i = 0; i < sharedResults.size(); ++i)
+            ranks[i] = sharedDictionary->getFrequencyRank(sharedResults[i].infinitive);
+
+    vector<size_t> order;
+    for (size_t i = 0; i < sharedResults.size(); ++i)
+    {
+        const InflectionDesc &d = sharedResults[i];
+        size_t j = order.size();
+        while (j > 0)
+        {
+            const InflectionDesc &prev = sharedResults[order[j - 1]];
+            if (d.mtpn.correct != prev.mtpn.correct
+                    ? !d.mtpn.correct
+                    : ranks[i] >= ranks[order[j - 1]])
+                break;
+            --j;
+        }
+        order.insert(order.begin() + j, i);
+    }
+
+    size_t numPrinted = 0;
+    for (size_t k = 0; k < order.size() && (limit == 0 || numPrinted < limit); ++k)
+    {
+        const InflectionDesc &d = sharedResults[order[k]];
+        bool seen = false;
+        for (size_t j = 0; j < k && uniqueLemmas && !seen; ++j)
+        {
+            const InflectionDesc &prev = sharedResults[order[j]];
+            seen = (prev.infinitive == d.infinitive && prev.templateName == d.templateName);
+        }
+        if (seen)
+            continue;
+        printAnalysis(d.infinitive, d.mtpn);
+        ++numPrinted;
+    }
+    cout << endl;
+}
+
+
+//static
+void
+DeconjugatorCommand::printAnalysis(const string &infinitive,
+                                   const ModeTensePersonNumber &mtpn)
+{
+    cout
+        << infinitive
+        << ", " << FrenchVerbDictionary::getModeName(mtpn.mode)
+        << ", " << FrenchVerbDictionary::getTenseName(mtpn.tense)
+        << ", " << int(mtpn.person)
+        << ", " << (mtpn.plural ? "plural" : "singular")
+        << "\n";
+}
+
+
+// Prints the main verb of each analysis of the phrase, with the mode,
+// tense, person and number of the phrase.  A compound form is
+// followed by the infinitive of its auxiliary.
+//
+void
+DeconjugatorCommand::processInputPhrase(const string &inputPhrase)
+{
+    vector<PhraseDesc> v;
+    (void) phraseAnalyzer->analyze(inputPhrase, v);
+
+    for (vector<PhraseDesc>::const_iterator it = v.begin();
                                             it != v.end(); it++)
     {
-        const InflectionDesc &d = *it;
+        const PhraseDesc &d = *it;
+        const ModeTensePersonNumber &mtpn = d.getModeTensePersonNumber();
         cout
-            << d.infinitive
-            << ", " << FrenchVerbDictionary::getModeName(d.mtpn.mode)
-            << ", " << FrenchVerbDictionary::getTenseName(d.mtpn.tense)
-            << ", " << int(d.mtpn.person)
-            << ", " << (d.mtpn.plural ? "plural" : "singular")
-            << "\n";
+            << d.verb.infinitive
+            << ", " << FrenchVerbDictionary::getModeName(mtpn.mode)
+            << ", " << FrenchVerbDictionary::getTenseName(mtpn.tense)
+            << ", " << int(mtpn.person)
+            << ", " << (mtpn.plural ? "plural" : "singular");
+        if (d.isCompound())
+            cout << ", " << d.auxiliary.infinitive;
+        cout << "\n";
     }
     cout << endl;
 }
@@ -139,6 +282,17 @@ displayHelp()
 "--lang=L           Select language L (fr for French, it for Italian)\n"
 "                   Default is French.\n"
 "--all-infinitives  Print the names of all known verbs, one per line (unsorted)\n"
+"--phrases          Analyze phrases like \"qu'ils aient\" or \"tu es allé\":\n"
+"                   the subordinator, the pronouns and the auxiliary are\n"
+"                   taken into account\n"
+"--limit=N          Print at most N analyses of each word\n"
+"--unique           Print only the best analysis of each infinitive\n"
+"--shared           Share the deconjugation index with the other processes\n"
+"                   of the user that use this option, instead of loading\n"
+"                   the dictionary (see VERBISTE_SHARED_NAME)\n"
+"--stats            Print the load times and the query statistics of the\n"
+"                   dictionary to the standard error output at the end\n"
+"                   (ignores --shared)\n"
 "\n"
 "See the " << commandName << "(1) manual page for details.\n"
 "\n"
@@ -151,6 +305,11 @@ main(int argc, char *argv[])
 {
     setlocale(LC_CTYPE, "");
     bool listAllInfinitives = false;
+    bool analyzePhrases = false;
+    size_t limit = 0;
+    bool uniqueLemmas = false;
+    bool useSharedDictionary = false;
+    bool printStats = false;
     string langCode = "fr";
 
     #if defined(ENABLE_NLS) && defined(HAVE_GETOPT_LONG)
@@ -188,6 +347,35 @@ main(int argc, char *argv[])
                 listAllInfinitives = true;
                 break;
 
+            case 'p':
+                analyzePhrases = true;
+                break;
+
+            case 'n':
+            {
+                char *end;
+                long n = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || n < 0)
+                {
+                    cerr << commandName << ": invalid limit " << optarg << "\n";
+                    return EXIT_FAILURE;
+                }
+                limit = size_t(n);
+                break;
+            }
+
+            case 'u':
+                uniqueLemmas = true;
+                break;
+
+            case 's':
+                useSharedDictionary = true;
+                break;
+
+            case 'S':
+                printStats = true;
+                break;
+
             default:
                 displayHelp();
                 return EXIT_FAILURE;
@@ -209,12 +397,26 @@ main(int argc, char *argv[])
         string conjFN, verbsFN;
         FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
 
-        DeconjugatorCommand cmd(conjFN, verbsFN, lang);
+        // The shared image only serves to deconjugate single words,
+        // and has no statistics.
+        string sharedName;
+        if (useSharedDictionary && !analyzePhrases && !listAllInfinitives && !printStats)
+            sharedName = SharedDictionary::getDefaultName(lang, false);
+
+        DeconjugatorCommand cmd(conjFN, verbsFN, lang, analyzePhrases,
+                                limit, uniqueLemmas, sharedName);
 
         if (listAllInfinitives)
             return cmd.listAllInfinitives(cout);
 
-        return cmd.run(argc - optind, argv + optind);
+        if (!printStats)
+            return cmd.run(argc - optind, argv + optind);
+
+        DictionaryStats &stats = cmd.getFrenchVerbDictionary().getStats();
+        stats.setEnabled(true);
+        int status = cmd.run(argc - optind, argv + optind);
+        stats.print(cerr);
+        return status;
     }
     catch (const exception &e)
     {
@@ -0,0 +1,1472 @@
+/*  $Id$
+    verbiste-bench.cpp - Microbenchmarks for the library's hot paths
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+/*  Run with "make bench".  Every benchmark works on a corpus that is
+    derived deterministically from the XML data files (every Nth known
+    verb, in dictionary order), so two runs on the same data measure
+    the same work.
+
+    For each benchmark, the following is reported:
+    - ns/op: mean wall time per operation;
+    - allocs/op: mean number of calls to operator new per operation;
+    - p50 and p99: median and 99th percentile of the per-operation
+      wall times (the cost of reading the clock is subtracted).
+*/
+
+#include <verbiste/FrenchVerbDictionary.h>
+#include <verbiste/ConjugationCache.h>
+#include <verbiste/DeconjugationResults.h>
+#include <verbiste/MultiLanguageIndex.h>
+#include <verbiste/SharedDictionary.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <locale.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace verbiste;
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Allocation counting
+//
+// The replaceable global allocation functions are overridden so that
+// every operator new call made by this program or by the library is
+// counted.
+//
+
+static unsigned long numAllocations = 0;
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#else
+#define BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#endif
+
+// Keeps GCC from inlining malloc() and free() into the callers of the
+// allocation functions, where it would warn that they do not match.
+#ifdef __GNUC__
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+
+BENCH_NOINLINE void *
+operator new(size_t size) BENCH_THROW_BAD_ALLOC
+{
+    ++numAllocations;
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+
+BENCH_NOINLINE void *
+operator new [] (size_t size) BENCH_THROW_BAD_ALLOC
+{
+    return operator new(size);
+}
+
+
+BENCH_NOINLINE void
+operator delete(void *p) throw()
+{
+    free(p);
+}
+
+
+BENCH_NOINLINE void
+operator delete [] (void *p) throw()
+{
+    free(p);
+}
+
+
+#ifdef __cpp_sized_deallocation
+
+void
+operator delete(void *p, size_t) throw()
+{
+    operator delete(p);
+}
+
+
+void
+operator delete [] (void *p, size_t) throw()
+{
+    operator delete [] (p);
+}
+
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Timing
+//
+
+typedef unsigned long long Nanoseconds;
+
+
+static Nanoseconds
+now()
+{
+    #ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return Nanoseconds(ts.tv_sec) * 1000000000ULL + Nanoseconds(ts.tv_nsec);
+    #else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return Nanoseconds(tv.tv_sec) * 1000000000ULL + Nanoseconds(tv.tv_usec) * 1000ULL;
+    #endif
+}
+
+
+// Returns the typical cost of a call to now(), which is subtracted from
+// each measured latency.
+//
+static Nanoseconds
+measureClockOverhead()
+{
+    const size_t n = 1000;
+    vector<Nanoseconds> samples;
+    samples.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        Nanoseconds t0 = now();
+        Nanoseconds t1 = now();
+        samples.push_back(t1 - t0);
+    }
+    sort(samples.begin(), samples.end());
+    return samples[n / 2];
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Cache misses
+//
+
+// Counts the L1 data cache read misses of this process with the
+// hardware performance counters, where the kernel and the processor
+// provide them (not in most virtual machines).
+//
+class CacheMissCounter
+{
+public:
+
+    CacheMissCounter()
+      : fd(-1)
+    {
+        #ifdef __linux__
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D
+                      | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                      | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = int(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        #endif
+    }
+
+    ~CacheMissCounter()
+    {
+        if (fd != -1)
+            close(fd);
+    }
+
+    bool isAvailable() const { return fd != -1; }
+
+    void start()
+    {
+        #ifdef __linux__
+        if (fd != -1)
+        {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        #endif
+    }
+
+    // Returns the number of misses since start().
+    //
+    unsigned long long stop()
+    {
+        unsigned long long count = 0;
+        #ifdef __linux__
+        if (fd != -1)
+        {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd, &count, sizeof(count)) != ssize_t(sizeof(count)))
+                count = 0;
+        }
+        #endif
+        return count;
+    }
+
+private:
+    int fd;
+
+    // Forbidden operations:
+    CacheMissCounter(const CacheMissCounter &);
+    CacheMissCounter &operator = (const CacheMissCounter &);
+};
+
+
+// Set-associative cache with least-recently-used replacement, which
+// counts the misses of a sequence of accesses to memory blocks.
+// Gives a reproducible estimate where the hardware counters are not
+// available.
+//
+class SimulatedCache
+{
+public:
+
+    SimulatedCache(size_t numSets, size_t _numWays)
+      : sets(numSets), numWays(_numWays), numMisses(0)
+    {
+    }
+
+    void access(size_t line)
+    {
+        list<size_t> &set = sets[line % sets.size()];
+        list<size_t>::iterator it = find(set.begin(), set.end(), line);
+        if (it != set.end())
+        {
+            set.splice(set.begin(), set, it);  // most recently used first
+            return;
+        }
+        ++numMisses;
+        set.push_front(line);
+        if (set.size() > numWays)
+            set.pop_back();
+    }
+
+    unsigned long getNumMisses() const { return numMisses; }
+
+private:
+    vector< list<size_t> > sets;
+    size_t numWays;
+    unsigned long numMisses;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmark harness
+//
+
+/** One microbenchmark.
+    A derived class prepares its inputs in setUp() and implements
+    runOp(), which performs one operation; the harness calls runOp()
+    with op numbers 0, 1, 2, etc.
+*/
+class Benchmark
+{
+public:
+
+    Benchmark(const string &_name, size_t _numOps)
+      : name(_name), numOps(_numOps)
+    {
+    }
+
+    virtual ~Benchmark()
+    {
+    }
+
+    virtual void setUp()
+    {
+    }
+
+    virtual void runOp(size_t opNo) = 0;
+
+    virtual void tearDown()
+    {
+    }
+
+    // Called after the results have been printed, to print
+    // additional indented lines.
+    //
+    virtual void printDetails() const
+    {
+    }
+
+    const string name;
+    size_t numOps;
+
+private:
+    // Forbidden operations:
+    Benchmark(const Benchmark &);
+    Benchmark &operator = (const Benchmark &);
+};
+
+
+static Nanoseconds clockOverhead = 0;
+
+
+static void
+printHeader()
+{
+    cout << left << setw(24) << "benchmark"
+         << right << setw(10) << "ops"
+         << setw(14) << "ns/op"
+         << setw(12) << "allocs/op"
+         << setw(14) << "p50(ns)"
+         << setw(14) << "p99(ns)"
+         << "\n";
+}
+
+
+static void
+runBenchmark(Benchmark &b)
+{
+    b.setUp();
+
+    if (b.numOps == 0)
+    {
+        b.tearDown();
+        return;
+    }
+
+    // Warm up the caches with a few operations that are not measured.
+    for (size_t i = 0; i < b.numOps && i < 10; ++i)
+        b.runOp(i);
+
+    vector<Nanoseconds> latencies;
+    latencies.reserve(b.numOps);
+
+    unsigned long allocsBefore = numAllocations;
+    for (size_t i = 0; i < b.numOps; ++i)
+    {
+        Nanoseconds t0 = now();
+        b.runOp(i);
+        Nanoseconds t1 = now();
+        Nanoseconds d = t1 - t0;
+        latencies.push_back(d > clockOverhead ? d - clockOverhead : 0);
+    }
+    // The reserve() above guarantees that push_back() did not allocate.
+    unsigned long allocs = numAllocations - allocsBefore;
+
+    b.tearDown();
+
+    Nanoseconds total = 0;
+    for (vector<Nanoseconds>::const_iterator it = latencies.begin();
+                                             it != latencies.end(); ++it)
+        total += *it;
+
+    sort(latencies.begin(), latencies.end());
+    size_t n = latencies.size();
+    Nanoseconds p50 = latencies[(n - 1) * 50 / 100];
+    Nanoseconds p99 = latencies[(n - 1) * 99 / 100];
+
+    cout << left << setw(24) << b.name
+         << right << setw(10) << n
+         << setw(14) << fixed << setprecision(1) << double(total) / n
+         << setw(12) << setprecision(2) << double(allocs) / n
+         << setw(14) << p50
+         << setw(14) << p99
+         << endl;
+
+    b.printDetails();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Corpus
+//
+
+static const size_t VERB_SAMPLING_INTERVAL = 16;
+
+// Number of verbs that are requested more often than the others by
+// GetConjugationBenchmark.
+//
+static const size_t NUM_FREQUENT_VERBS = 32;
+
+
+// Words that are not verb forms, so that the deconjugation benchmark
+// also measures failed lookups.
+//
+static const char *nonVerbs[] =
+{
+    "maison", "rapidement", "le", "de", "et", "chat", "bonjour",
+    "table", "avec", "pour", "xyzzy", "anticonstitutionnellement",
+    NULL
+};
+
+
+class Corpus
+{
+public:
+
+    struct Verb
+    {
+        string infinitive;
+        string templateName;
+        string radical;
+        const TemplateSpec *templ;
+        bool aspirateH;
+    };
+
+    vector<Verb> verbs;
+    vector<Verb> frequentVerbs;  // empty if the dictionary has no frequencies
+    vector<string> utf8Words;
+    vector<wstring> wideWords;
+    vector<string> utf8NonVerbs;  // near misses of utf8Words
+
+    void build(FrenchVerbDictionary &fvd)
+    {
+        bool isItalian = (fvd.getLanguage() == FrenchVerbDictionary::ITALIAN);
+        const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+        for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
+        {
+            if (id % VERB_SAMPLING_INTERVAL != 0)
+                continue;
+
+            for (size_t t = 0; t < knownVerbs.getNumTemplates(id); ++t)
+            {
+                Verb v;
+                v.infinitive = knownVerbs.getInfinitive(id);
+                v.templateName = knownVerbs.getTemplateName(id, t);
+                v.radical = FrenchVerbDictionary::getRadical(v.infinitive, v.templateName);
+                v.templ = fvd.getTemplate(v.templateName);
+                v.aspirateH = fvd.isVerbStartingWithAspirateH(v.infinitive);
+                if (v.templ == NULL)
+                    continue;
+                verbs.push_back(v);
+
+                for (size_t j = 0; verbiste_valid_modes_and_tenses[j].mode != VERBISTE_INVALID_MODE; ++j)
+                {
+                    vector< vector<string> > conjug;
+                    fvd.generateTense(v.radical, *v.templ,
+                                      Mode(verbiste_valid_modes_and_tenses[j].mode),
+                                      Tense(verbiste_valid_modes_and_tenses[j].tense),
+                                      conjug, false, v.aspirateH, isItalian);
+                    for (size_t p = 0; p < conjug.size(); ++p)
+                        for (size_t k = 0; k < conjug[p].size(); ++k)
+                            if (!conjug[p][k].empty())
+                                utf8Words.push_back(conjug[p][k]);
+                }
+            }
+        }
+
+        // The most frequent verbs, from the most frequent one.
+        vector<string> infinitives;
+        fvd.getMostFrequentVerbs(NUM_FREQUENT_VERBS, infinitives);
+        for (vector<string>::const_iterator it = infinitives.begin();
+                                            it != infinitives.end(); ++it)
+        {
+            VerbRecordTable::VerbId id = knownVerbs.find(*it);
+            for (size_t t = 0; t < knownVerbs.getNumTemplates(id); ++t)
+            {
+                Verb v;
+                v.infinitive = *it;
+                v.templateName = knownVerbs.getTemplateName(id, t);
+                v.radical = FrenchVerbDictionary::getRadical(v.infinitive, v.templateName);
+                v.templ = fvd.getTemplate(v.templateName);
+                v.aspirateH = fvd.isVerbStartingWithAspirateH(v.infinitive);
+                if (v.templ != NULL)
+                    frequentVerbs.push_back(v);
+            }
+        }
+
+        for (size_t i = 0; nonVerbs[i] != NULL; ++i)
+            utf8Words.push_back(nonVerbs[i]);
+
+        for (vector<string>::const_iterator it = utf8Words.begin();
+                                            it != utf8Words.end(); ++it)
+            wideWords.push_back(fvd.utf8ToWide(*it));
+
+        // Each verb form with an extra letter, or without its last
+        // (ASCII) letter, unless that is also a verb form.
+        vector<InflectionDesc> results;
+        for (vector<string>::const_iterator it = utf8Words.begin();
+                                            it != utf8Words.end(); ++it)
+        {
+            string candidates[2] = { *it + "x", string() };
+            if (it->length() > 1 && (unsigned char) (*it)[it->length() - 1] < 0x80)
+                candidates[1].assign(*it, 0, it->length() - 1);
+            for (size_t c = 0; c < 2; ++c)
+            {
+                if (candidates[c].empty())
+                    continue;
+                results.clear();
+                fvd.deconjugate(candidates[c], results);
+                if (results.empty())
+                    utf8NonVerbs.push_back(candidates[c]);
+            }
+        }
+    }
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Benchmarks
+//
+
+// Constructs a dictionary from the XML files, or from the data
+// compiled into the library if 'compiled' is true.
+//
+class ConstructionBenchmark : public Benchmark
+{
+public:
+
+    ConstructionBenchmark(const string &name, FrenchVerbDictionary::Language _lang,
+                          bool _includeWithoutAccents, bool _compiled, size_t numOps)
+      : Benchmark(name, numOps),
+        lang(_lang),
+        includeWithoutAccents(_includeWithoutAccents),
+        compiled(_compiled)
+    {
+        FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
+    }
+
+    virtual void runOp(size_t)
+    {
+        if (compiled)
+            FrenchVerbDictionary d(lang, includeWithoutAccents);
+        else
+            FrenchVerbDictionary d(conjFN, verbsFN, includeWithoutAccents, lang);
+    }
+
+private:
+    FrenchVerbDictionary::Language lang;
+    bool includeWithoutAccents;
+    bool compiled;
+    string conjFN, verbsFN;
+};
+
+
+// Trie whose virtual callback adds up the user data of the prefixes found.
+//
+class CountingTrie : public Trie<int, char>
+{
+public:
+
+    CountingTrie()
+      : Trie<int, char>(true),
+        sum(0)
+    {
+    }
+
+    virtual void onFoundPrefixWithUserData(const string &,
+                                           string::size_type,
+                                           const int *userData) const throw()
+    {
+        sum += *userData;
+    }
+
+    mutable unsigned long sum;
+};
+
+
+// Visitor that does the same work as CountingTrie::onFoundPrefixWithUserData().
+//
+class PrefixCounter
+{
+public:
+
+    PrefixCounter()
+      : sum(0)
+    {
+    }
+
+    void operator () (const string &, string::size_type, const int *userData)
+    {
+        sum += *userData;
+    }
+
+    unsigned long sum;
+};
+
+
+// Searches a trie either with Trie::get(), which calls a virtual function
+// for each prefix found, or with Trie::forEachPrefix(), which calls
+// a visitor that can be inlined.
+//
+class TrieGetBenchmark : public Benchmark
+{
+public:
+
+    TrieGetBenchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus,
+                     bool _useVisitor)
+      : Benchmark(_useVisitor ? "trie-for-each-prefix" : "trie-get",
+                  _corpus.utf8Words.size() * 4),
+        fvd(_fvd),
+        corpus(_corpus),
+        useVisitor(_useVisitor),
+        trie(NULL),
+        counter()
+    {
+    }
+
+    // Builds a trie of all known verb radicals, keyed on UTF-8 strings
+    // like the one that the dictionary uses internally.
+    //
+    virtual void setUp()
+    {
+        trie = new CountingTrie();
+        const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+        for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
+        {
+            for (size_t t = 0; t < knownVerbs.getNumTemplates(id); ++t)
+            {
+                string radical = FrenchVerbDictionary::getRadical(knownVerbs.getInfinitive(id),
+                                                        knownVerbs.getTemplateName(id, t));
+                int **userData = trie->getUserDataPointer(radical);
+                if (*userData == NULL)
+                    *userData = new int(0);
+                ++**userData;
+            }
+        }
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        const string &word = corpus.utf8Words[opNo % corpus.utf8Words.size()];
+        if (useVisitor)
+            (void) trie->forEachPrefix(word, counter);
+        else
+            (void) trie->get(word);
+    }
+
+    virtual void tearDown()
+    {
+        delete trie;
+        trie = NULL;
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    bool useVisitor;
+    CountingTrie *trie;
+    PrefixCounter counter;
+};
+
+
+// Searches an automaton of all known verb radicals, with its hot states
+// relocated or in the order of its construction, and reports the cache
+// misses of both layouts.
+// The words of the corpus are taken in a scattered order, as in a
+// text, rather than verb by verb.
+//
+class DawgLayoutBenchmark : public Benchmark
+{
+public:
+
+    DawgLayoutBenchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus,
+                        bool _hotFirst)
+      : Benchmark(_hotFirst ? "dawg-hot-first" : "dawg-build-order",
+                  _corpus.utf8Words.size() * 4),
+        fvd(_fvd),
+        corpus(_corpus),
+        hotFirst(_hotFirst),
+        dawg(),
+        counter()
+    {
+    }
+
+    virtual void setUp()
+    {
+        Trie<int, char> trie(true);
+        const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+        for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
+        {
+            for (size_t t = 0; t < knownVerbs.getNumTemplates(id); ++t)
+            {
+                string radical = FrenchVerbDictionary::getRadical(knownVerbs.getInfinitive(id),
+                                                        knownVerbs.getTemplateName(id, t));
+                int **userData = trie.getUserDataPointer(radical);
+                if (*userData == NULL)
+                    *userData = new int(0);
+                ++**userData;
+            }
+        }
+        dawg.build(trie, hotFirst);
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        (void) dawg.forEachPrefix(getWord(opNo), counter);
+    }
+
+    virtual void printDetails() const
+    {
+        // 32 KiB, 8 ways, 64-byte lines, like the L1 data cache of
+        // most x86 processors.
+        const size_t lineSize = 64;
+        SimulatedCache cache(64, 8);
+        vector<size_t> lines, distinctLines;
+        for (size_t opNo = 0; opNo < numOps; ++opNo)
+        {
+            lines.clear();
+            dawg.getCacheLines(getWord(opNo), lineSize, lines);
+            for (vector<size_t>::const_iterator it = lines.begin(); it != lines.end(); ++it)
+                cache.access(*it);
+            distinctLines.insert(distinctLines.end(), lines.begin(), lines.end());
+        }
+        sort(distinctLines.begin(), distinctLines.end());
+        distinctLines.erase(unique(distinctLines.begin(), distinctLines.end()),
+                            distinctLines.end());
+
+        cout << "  automaton: " << dawg.getNumStates() << " states, "
+             << dawg.computeMemoryConsumption() << " bytes; "
+             << distinctLines.size() << " lines read; simulated L1 misses/op "
+             << setprecision(3) << double(cache.getNumMisses()) / numOps;
+
+        CacheMissCounter hardwareCounter;
+        if (hardwareCounter.isAvailable())
+        {
+            PrefixCounter c;
+            hardwareCounter.start();
+            for (size_t opNo = 0; opNo < numOps; ++opNo)
+                (void) dawg.forEachPrefix(getWord(opNo), c);
+            unsigned long long misses = hardwareCounter.stop();
+            cout << "; L1 misses/op " << double(misses) / numOps;
+        }
+        cout << "\n";
+    }
+
+private:
+    // Visits the words of the corpus in a scattered order: 7919 is
+    // a prime number that does not divide the size of the corpus.
+    //
+    const string &getWord(size_t opNo) const
+    {
+        const size_t n = corpus.utf8Words.size();
+        size_t step = (n % 7919 == 0 ? 1 : 7919);
+        return corpus.utf8Words[(opNo * step) % n];
+    }
+
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    bool hotFirst;
+    Dawg<int, char> dawg;
+    PrefixCounter counter;
+};
+
+
+// With 'withStats', the queries are counted and timed, which gives
+// the cost of DictionaryStats.
+//
+class DeconjugateBenchmark : public Benchmark
+{
+public:
+
+    DeconjugateBenchmark(const string &name, FrenchVerbDictionary &_fvd,
+                         const Corpus &_corpus,
+                         FrenchVerbDictionary::DeconjugationStrategy _strategy,
+                         bool _withStats = false)
+      : Benchmark(name, _corpus.utf8Words.size() * 2),
+        fvd(_fvd),
+        corpus(_corpus),
+        strategy(_strategy),
+        savedStrategy(_fvd.getDeconjugationStrategy()),
+        withStats(_withStats),
+        results()
+    {
+    }
+
+    virtual void setUp()
+    {
+        fvd.setDeconjugationStrategy(strategy);
+        fvd.getStats().setEnabled(withStats);
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        results.clear();
+        fvd.deconjugate(corpus.utf8Words[opNo % corpus.utf8Words.size()], results);
+    }
+
+    virtual void tearDown()
+    {
+        fvd.setDeconjugationStrategy(savedStrategy);
+        fvd.getStats().setEnabled(false);
+    }
+
+private:
+    FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    FrenchVerbDictionary::DeconjugationStrategy strategy, savedStrategy;
+    bool withStats;
+    vector<InflectionDesc> results;
+};
+
+
+// Deconjugates the words of the corpus into a DeconjugationResults
+// object, then forms the infinitive of each result that it keeps,
+// as a program that displays them would.
+//
+class DeconjugateRankedBenchmark : public Benchmark
+{
+public:
+
+    DeconjugateRankedBenchmark(const string &name, const FrenchVerbDictionary &_fvd,
+                               const Corpus &_corpus, size_t limit, bool uniqueLemmas)
+      : Benchmark(name, _corpus.utf8Words.size()),
+        fvd(_fvd),
+        corpus(_corpus),
+        results(),
+        infinitive()
+    {
+        results.setLimit(limit);
+        results.setUniqueLemmas(uniqueLemmas);
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        fvd.deconjugate(corpus.utf8Words[opNo], results);
+        for (size_t i = 0; i < results.size(); ++i)
+            infinitive = results.getInfinitive(i);
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    DeconjugationResults results;
+    string infinitive;
+};
+
+
+// Deconjugates strings that are not verb forms, most of which the
+// verb form filter rejects without searching the indexes.
+//
+class DeconjugateNonVerbsBenchmark : public Benchmark
+{
+public:
+
+    DeconjugateNonVerbsBenchmark(FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("deconjugate-non-verbs", _corpus.utf8NonVerbs.size()),
+        fvd(_fvd),
+        corpus(_corpus),
+        results()
+    {
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        results.clear();
+        fvd.deconjugate(corpus.utf8NonVerbs[opNo], results);
+    }
+
+    // Prints the proportion of the strings that the filter lets through.
+    // Since none of them is a verb form, that is its false positive rate.
+    //
+    virtual void printDetails() const
+    {
+        const BloomFilter &filter = fvd.getVerbFormFilter();
+        if (!filter.isBuilt())
+            return;
+        size_t numPassed = 0;
+        for (vector<string>::const_iterator it = corpus.utf8NonVerbs.begin();
+                                            it != corpus.utf8NonVerbs.end(); ++it)
+            if (filter.mayContain(*it))
+                ++numPassed;
+        cout << "  filter: " << filter.getNumKeys() << " forms, "
+             << filter.computeMemoryConsumption() << " bytes, false positives "
+             << setprecision(2) << 100.0 * numPassed / corpus.utf8NonVerbs.size()
+             << "% (expected " << 100 * filter.getExpectedFalsePositiveRate() << "%)\n";
+    }
+
+private:
+    FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    vector<InflectionDesc> results;
+};
+
+
+// Maps the image of a dictionary that another process has published,
+// as a program started with french-deconjugator --shared does.
+// The image is published in a temporary file.
+//
+class SharedAttachBenchmark : public Benchmark
+{
+public:
+
+    SharedAttachBenchmark(FrenchVerbDictionary::Language _lang, size_t numOps)
+      : Benchmark("shared-attach", numOps),
+        lang(_lang),
+        name()
+    {
+        FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
+    }
+
+    virtual void setUp()
+    {
+        char pid[32];
+        snprintf(pid, sizeof(pid), "%lu", (unsigned long) getpid());
+        name = string("/tmp/verbiste-bench-") + pid + ".image";
+        delete SharedDictionary::open(name, conjFN, verbsFN, false, lang);
+    }
+
+    virtual void runOp(size_t)
+    {
+        delete SharedDictionary::open(name, conjFN, verbsFN, false, lang);
+    }
+
+    virtual void tearDown()
+    {
+        (void) SharedDictionary::remove(name);
+    }
+
+private:
+    FrenchVerbDictionary::Language lang;
+    string conjFN, verbsFN;
+    string name;
+};
+
+
+// Deconjugates the words of the corpus with the image of the
+// dictionary, to compare with deconjugate-suffix-first.
+//
+class DeconjugateSharedBenchmark : public Benchmark
+{
+public:
+
+    DeconjugateSharedBenchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("deconjugate-shared", _corpus.utf8Words.size() * 2),
+        fvd(_fvd),
+        corpus(_corpus),
+        image(NULL),
+        results()
+    {
+    }
+
+    virtual void setUp()
+    {
+        image = new SharedDictionary(fvd);
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        results.clear();
+        image->deconjugate(corpus.utf8Words[opNo % corpus.utf8Words.size()], results);
+    }
+
+    virtual void tearDown()
+    {
+        delete image;
+        image = NULL;
+    }
+
+    virtual void printDetails() const
+    {
+        cout << "  image: " << SharedDictionary(fvd).getImageSize() << " bytes\n";
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    SharedDictionary *image;
+    vector<InflectionDesc> results;
+};
+
+
+// Deconjugates the words of the corpus in the French, Italian and Greek
+// dictionaries, either one after the other, or at once with a
+// MultiLanguageIndex, or only to find the languages of each word.
+//
+class MultiLanguageBenchmark : public Benchmark
+{
+public:
+
+    enum Mode { SEQUENTIAL, MERGED, IDENTIFY };
+
+    MultiLanguageBenchmark(const string &name, const FrenchVerbDictionary &_fvd,
+                           const Corpus &_corpus, Mode _mode)
+      : Benchmark(name, _corpus.utf8Words.size()),
+        fvd(_fvd),
+        corpus(_corpus),
+        mode(_mode),
+        dictionaries(),
+        ownDictionaries(),
+        index(NULL),
+        numStates(0),
+        numBytes(0),
+        results(),
+        resultsByDictionary()
+    {
+    }
+
+    virtual void setUp()
+    {
+        static const FrenchVerbDictionary::Language languages[] =
+        {
+            FrenchVerbDictionary::FRENCH,
+            FrenchVerbDictionary::ITALIAN,
+            FrenchVerbDictionary::GREEK,
+        };
+
+        dictionaries.push_back(&fvd);
+        for (size_t i = 0; i < sizeof(languages) / sizeof(languages[0]); ++i)
+        {
+            if (languages[i] == fvd.getLanguage())
+                continue;
+            string conjFN, verbsFN;
+            FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, languages[i]);
+            ownDictionaries.push_back(new FrenchVerbDictionary(conjFN, verbsFN,
+                                                               false, languages[i]));
+            dictionaries.push_back(ownDictionaries.back());
+        }
+
+        if (mode != SEQUENTIAL)
+        {
+            index = new MultiLanguageIndex(dictionaries);
+            numStates = index->getNumStates();
+            numBytes = index->computeMemoryConsumption();
+        }
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        const string &word = corpus.utf8Words[opNo];
+        switch (mode)
+        {
+            case SEQUENTIAL:
+                results.clear();
+                for (size_t i = 0; i < dictionaries.size(); ++i)
+                    dictionaries[i]->deconjugate(word, results);
+                break;
+            case MERGED:
+                for (size_t i = 0; i < resultsByDictionary.size(); ++i)
+                    resultsByDictionary[i].clear();
+                index->deconjugate(word, resultsByDictionary);
+                break;
+            case IDENTIFY:
+                (void) index->findDictionaries(word);
+                break;
+        }
+    }
+
+    virtual void tearDown()
+    {
+        delete index;
+        index = NULL;
+        for (size_t i = 0; i < ownDictionaries.size(); ++i)
+            delete ownDictionaries[i];
+        ownDictionaries.clear();
+        dictionaries.clear();
+    }
+
+    virtual void printDetails() const
+    {
+        if (numStates != 0)
+            cout << "  index: " << numStates << " states, "
+                 << numBytes << " bytes\n";
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    Mode mode;
+    vector<const FrenchVerbDictionary *> dictionaries;
+    vector<FrenchVerbDictionary *> ownDictionaries;
+    MultiLanguageIndex *index;
+    size_t numStates, numBytes;
+    vector<InflectionDesc> results;
+    vector< vector<InflectionDesc> > resultsByDictionary;
+};
+
+
+class GenerateTenseBenchmark : public Benchmark
+{
+public:
+
+    GenerateTenseBenchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus,
+                           bool _intoBuffer)
+      : Benchmark(_intoBuffer ? "generate-tense-into" : "generate-tense", 0),
+        fvd(_fvd),
+        corpus(_corpus),
+        intoBuffer(_intoBuffer),
+        numModesTenses(0),
+        buffer()
+    {
+        while (verbiste_valid_modes_and_tenses[numModesTenses].mode != VERBISTE_INVALID_MODE)
+            ++numModesTenses;
+        numOps = corpus.verbs.size() * numModesTenses * 2;
+    }
+
+    // Each operation generates one mode and tense of one verb of the
+    // corpus, with pronouns.  With generateTenseInto(), the same buffer
+    // is reused by all the operations.
+    //
+    virtual void runOp(size_t opNo)
+    {
+        const Corpus::Verb &v = corpus.verbs[(opNo / numModesTenses) % corpus.verbs.size()];
+        const Verbiste_ModeTense &mt = verbiste_valid_modes_and_tenses[opNo % numModesTenses];
+        const bool isItalian = (fvd.getLanguage() == FrenchVerbDictionary::ITALIAN);
+        if (intoBuffer)
+        {
+            buffer.clear();
+            fvd.generateTenseInto(v.radical, *v.templ, Mode(mt.mode), Tense(mt.tense),
+                                  buffer, true, v.aspirateH, isItalian);
+        }
+        else
+        {
+            vector< vector<string> > conjug;
+            fvd.generateTense(v.radical, *v.templ, Mode(mt.mode), Tense(mt.tense),
+                              conjug, true, v.aspirateH, isItalian);
+        }
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    bool intoBuffer;
+    size_t numModesTenses;
+    ConjugationBuffer buffer;
+};
+
+
+class GetConjugationBenchmark : public Benchmark
+{
+public:
+
+    // If 'cacheCapacity' is zero, the conjugations are generated each
+    // time into a reused buffer.  Otherwise, they are obtained from a
+    // ConjugationCache of that capacity, which is first filled with
+    // the most frequent verbs if 'prewarm' is true.
+    //
+    GetConjugationBenchmark(const string &name,
+                            const FrenchVerbDictionary &_fvd, const Corpus &_corpus,
+                            size_t _cacheCapacity, bool _prewarm)
+      : Benchmark(name, _corpus.verbs.size() * 8),
+        fvd(_fvd),
+        corpus(_corpus),
+        cacheCapacity(_cacheCapacity),
+        prewarm(_prewarm),
+        cache(NULL),
+        buffer()
+    {
+    }
+
+    virtual void setUp()
+    {
+        if (cacheCapacity != 0)
+        {
+            cache = new ConjugationCache(fvd, cacheCapacity);
+            if (prewarm)
+                (void) cache->prewarm(NUM_FREQUENT_VERBS, true);
+        }
+    }
+
+    // Three requests out of four are for one of the most frequent verbs,
+    // or for one of the first verbs of the corpus if the dictionary has
+    // no frequencies, to imitate the popularity of common verbs.
+    //
+    virtual void runOp(size_t opNo)
+    {
+        const vector<Corpus::Verb> &popularVerbs =
+                (corpus.frequentVerbs.empty() ? corpus.verbs : corpus.frequentVerbs);
+        const Corpus::Verb &v = (opNo % 4 != 0
+                ? popularVerbs[opNo % min(NUM_FREQUENT_VERBS, popularVerbs.size())]
+                : corpus.verbs[opNo % corpus.verbs.size()]);
+        if (cache != NULL)
+            (void) cache->getConjugation(v.infinitive, v.templateName, true);
+        else
+            fvd.generateConjugation(v.infinitive, v.templateName, buffer, true);
+    }
+
+    virtual void tearDown()
+    {
+        if (cache != NULL)
+            stats = cache->getStatistics();
+        delete cache;
+        cache = NULL;
+    }
+
+    virtual void printDetails() const
+    {
+        if (cacheCapacity == 0)
+            return;
+        cout << "  cache: capacity " << stats.capacity
+             << ", hit rate " << setprecision(1) << 100 * stats.getHitRate() << "%, "
+             << stats.evictions << " evictions\n";
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+    size_t cacheCapacity;
+    bool prewarm;
+    ConjugationCache *cache;
+    ConjugationBuffer buffer;
+    ConjugationCache::Statistics stats;
+};
+
+
+// Looks up the infinitives of the corpus, as generateConjugation()
+// does to know if the verb starts with an aspirate h.
+//
+class IsAspirateHBenchmark : public Benchmark
+{
+public:
+
+    IsAspirateHBenchmark(FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("is-aspirate-h", _corpus.verbs.size()),
+        fvd(_fvd),
+        corpus(_corpus)
+    {
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        (void) fvd.isVerbStartingWithAspirateH(corpus.verbs[opNo].infinitive);
+    }
+
+private:
+    FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+};
+
+
+class UTF8ToWideBenchmark : public Benchmark
+{
+public:
+
+    UTF8ToWideBenchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("utf8-to-wide", _corpus.utf8Words.size()),
+        fvd(_fvd),
+        corpus(_corpus)
+    {
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        (void) fvd.utf8ToWide(corpus.utf8Words[opNo]);
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+};
+
+
+class WideToUTF8Benchmark : public Benchmark
+{
+public:
+
+    WideToUTF8Benchmark(const FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("wide-to-utf8", _corpus.wideWords.size()),
+        fvd(_fvd),
+        corpus(_corpus)
+    {
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        (void) fvd.wideToUTF8(corpus.wideWords[opNo]);
+    }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+};
+
+
+class RemoveAccentsBenchmark : public Benchmark
+{
+public:
+
+    RemoveAccentsBenchmark(FrenchVerbDictionary &_fvd, const Corpus &_corpus)
+      : Benchmark("remove-utf8-accents", _corpus.utf8Words.size()),
+        fvd(_fvd),
+        corpus(_corpus)
+    {
+    }
+
+    virtual void runOp(size_t opNo)
+    {
+        (void) fvd.removeUTF8Accents(corpus.utf8Words[opNo]);
+    }
+
+private:
+    FrenchVerbDictionary &fvd;
+    const Corpus &corpus;
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Returns true if the benchmark named 'name' was selected on the command line.
+//
+static bool
+isSelected(const string &name, const vector<string> &filters)
+{
+    if (filters.empty())
+        return true;
+    for (vector<string>::const_iterator it = filters.begin(); it != filters.end(); ++it)
+        if (name.find(*it) != string::npos)
+            return true;
+    return false;
+}
+
+
+static void
+run(Benchmark *b, const vector<string> &filters)
+{
+    if (isSelected(b->name, filters))
+        runBenchmark(*b);
+    delete b;
+}
+
+
+int
+main(int argc, char *argv[])
+{
+    setlocale(LC_CTYPE, "");
+
+    string langCode = "fr";
+    vector<string> filters;  // substrings of the names of the benchmarks to run
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strncmp(argv[i], "--lang=", 7) == 0)
+            langCode = argv[i] + 7;
+        else if (strcmp(argv[i], "--help") == 0)
+        {
+            cout << "Usage: verbiste-bench [--lang=fr|it|el] [NAME-SUBSTRING...]\n";
+            return EXIT_SUCCESS;
+        }
+        else
+            filters.push_back(argv[i]);
+    }
+
+    FrenchVerbDictionary::Language lang = FrenchVerbDictionary::parseLanguageCode(langCode);
+    if (lang == FrenchVerbDictionary::NO_LANGUAGE)
+    {
+        cerr << "verbiste-bench: invalid language code " << langCode << "\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        string conjFN, verbsFN;
+        FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
+        FrenchVerbDictionary fvd(conjFN, verbsFN, false, lang);
+
+        Corpus corpus;
+        corpus.build(fvd);
+
+        clockOverhead = measureClockOverhead();
+
+        cout << "verbiste-bench: lang=" << langCode
+             << ", corpus: " << corpus.verbs.size() << " verbs, "
+             << corpus.utf8Words.size() << " words"
+             << ", clock overhead: " << clockOverhead << " ns\n";
+
+        size_t trieStates, trieBytes, automatonStates, automatonBytes;
+        fvd.getRadicalIndexSizes(trieStates, trieBytes, automatonStates, automatonBytes);
+        cout << "radical index: trie: " << trieStates << " states, "
+             << trieBytes << " bytes; minimal automaton: "
+             << automatonStates << " states, " << automatonBytes << " bytes\n";
+
+        size_t tenseSpecs, distinctTenseSpecs, inflectionTables,
+               distinctInflectionTables, unsharedBytes, sharedBytes;
+        fvd.getTemplateTableSizes(tenseSpecs, distinctTenseSpecs,
+                                  inflectionTables, distinctInflectionTables,
+                                  unsharedBytes, sharedBytes);
+        cout << "templates: " << distinctTenseSpecs << " distinct tenses out of "
+             << tenseSpecs << ", " << distinctInflectionTables
+             << " distinct inflection tables out of " << inflectionTables
+             << ", " << sharedBytes << " bytes instead of " << unsharedBytes << "\n";
+
+        const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+        cout << "known verbs: " << knownVerbs.size() << " verbs, "
+             << knownVerbs.getNumTemplateNames() << " templates, "
+             << knownVerbs.computeMemoryConsumption() << " bytes\n";
+        printHeader();
+
+        run(new ConstructionBenchmark("construct", lang, false, false, 5), filters);
+        run(new ConstructionBenchmark("construct-accents", lang, true, false, 3), filters);
+        run(new ConstructionBenchmark("construct-compiled", lang, false, true, 5), filters);
+        run(new TrieGetBenchmark(fvd, corpus, false), filters);
+        run(new TrieGetBenchmark(fvd, corpus, true), filters);
+        run(new DawgLayoutBenchmark(fvd, corpus, false), filters);
+        run(new DawgLayoutBenchmark(fvd, corpus, true), filters);
+        run(new DeconjugateBenchmark("deconjugate-prefix-first", fvd, corpus,
+                                     FrenchVerbDictionary::PREFIX_FIRST), filters);
+        run(new DeconjugateBenchmark("deconjugate-suffix-first", fvd, corpus,
+                                     FrenchVerbDictionary::SUFFIX_FIRST), filters);
+        run(new DeconjugateBenchmark("deconjugate-stats", fvd, corpus,
+                                     FrenchVerbDictionary::SUFFIX_FIRST, true), filters);
+        run(new DeconjugateNonVerbsBenchmark(fvd, corpus), filters);
+        run(new DeconjugateSharedBenchmark(fvd, corpus), filters);
+        run(new SharedAttachBenchmark(lang, 1000), filters);
+        run(new DeconjugateRankedBenchmark("deconjugate-ranked", fvd, corpus, 0, false), filters);
+        run(new DeconjugateRankedBenchmark("deconjugate-unique", fvd, corpus, 0, true), filters);
+        run(new DeconjugateRankedBenchmark("deconjugate-first", fvd, corpus, 1, false), filters);
+        run(new MultiLanguageBenchmark("multi-lang-sequential", fvd, corpus,
+                                       MultiLanguageBenchmark::SEQUENTIAL), filters);
+        run(new MultiLanguageBenchmark("multi-lang-merged", fvd, corpus,
+                                       MultiLanguageBenchmark::MERGED), filters);
+        run(new MultiLanguageBenchmark("multi-lang-identify", fvd, corpus,
+                                       MultiLanguageBenchmark::IDENTIFY), filters);
+        run(new GenerateTenseBenchmark(fvd, corpus, false), filters);
+        run(new GenerateTenseBenchmark(fvd, corpus, true), filters);
+        run(new GetConjugationBenchmark("get-conjugation", fvd, corpus, 0, false), filters);
+        run(new GetConjugationBenchmark("get-conjugation-cached", fvd, corpus, 64, false), filters);
+        run(new GetConjugationBenchmark("get-conjugation-prewarmed", fvd, corpus, 64, true), filters);
+        run(new IsAspirateHBenchmark(fvd, corpus), filters);
+        run(new UTF8ToWideBenchmark(fvd, corpus), filters);
+        run(new WideToUTF8Benchmark(fvd, corpus), filters);
+        run(new RemoveAccentsBenchmark(fvd, corpus), filters);
+    }
+    catch (const exception &e)
+    {
+        cerr << "verbiste-bench: exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
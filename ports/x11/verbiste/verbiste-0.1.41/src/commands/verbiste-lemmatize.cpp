@@ -0,0 +1,653 @@
+/*  $Id$
+    verbiste-lemmatize.cpp - Finds the conjugated verbs in running text
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#ifdef ENABLE_NLS
+#ifdef HAVE_GETOPT_LONG
+#include <unistd.h>
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+#include <getopt.h>
+#endif
+#endif  /* ENABLE_NLS */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <locale.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace verbiste;
+
+
+static const char *commandName = "verbiste-lemmatize";
+
+static const size_t chunkSize = 1 << 20;  // bytes of text per worker task
+static const size_t maxThreads = 64;
+
+
+#if defined(ENABLE_NLS) && defined(HAVE_GETOPT_LONG)
+static struct option knownOptions[] =
+{
+    { "help",           no_argument,            NULL, 'h' },
+    { "version",        no_argument,            NULL, 'v' },
+    { "lang",           required_argument,      NULL, 'l' },
+    { "threads",        required_argument,      NULL, 'j' },
+
+    { NULL, 0, NULL, 0 }  // marks the end
+};
+#endif
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Tokenizer
+//
+// A token is a run of letters in which single hyphens and apostrophes
+// may appear between two letters (e.g., "peut-être", "j'aime",
+// "entr'aimer").  An apostrophe may also end a token, as in the Italian
+// imperative "fa'".  The text is in UTF-8; invalid bytes separate tokens.
+//
+
+
+// Decodes the UTF-8 character that starts at s[i] and stores its length
+// in 'len'.  Returns 0xFFFD for an invalid or truncated sequence, whose
+// length is then 1.
+//
+static unsigned
+decodeUTF8(const unsigned char *s, size_t i, size_t n, size_t &len)
+{
+    unsigned c = s[i];
+    size_t expected;
+    unsigned cp;
+    if (c < 0x80)
+    {
+        len = 1;
+        return c;
+    }
+    if (c >= 0xC2 && c <= 0xDF)
+        expected = 2, cp = c & 0x1F;
+    else if (c >= 0xE0 && c <= 0xEF)
+        expected = 3, cp = c & 0x0F;
+    else if (c >= 0xF0 && c <= 0xF4)
+        expected = 4, cp = c & 0x07;
+    else
+    {
+        len = 1;
+        return 0xFFFD;
+    }
+
+    if (i + expected > n)
+    {
+        len = 1;
+        return 0xFFFD;
+    }
+    for (size_t k = 1; k < expected; ++k)
+    {
+        unsigned cont = s[i + k];
+        if ((cont & 0xC0) != 0x80)
+        {
+            len = 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (cont & 0x3F);
+    }
+    len = expected;
+    return cp;
+}
+
+
+static void
+appendUTF8(string &dest, unsigned cp)
+{
+    if (cp < 0x80)
+        dest += char(cp);
+    else if (cp < 0x800)
+    {
+        dest += char(0xC0 | (cp >> 6));
+        dest += char(0x80 | (cp & 0x3F));
+    }
+    else if (cp < 0x10000)
+    {
+        dest += char(0xE0 | (cp >> 12));
+        dest += char(0x80 | ((cp >> 6) & 0x3F));
+        dest += char(0x80 | (cp & 0x3F));
+    }
+    else
+    {
+        dest += char(0xF0 | (cp >> 18));
+        dest += char(0x80 | ((cp >> 12) & 0x3F));
+        dest += char(0x80 | ((cp >> 6) & 0x3F));
+        dest += char(0x80 | (cp & 0x3F));
+    }
+}
+
+
+// Letters of the languages supported by the library: Latin with
+// the Latin-1 and Latin Extended-A accents, and Greek.
+//
+static bool
+isLetter(unsigned cp)
+{
+    if (cp < 0x80)
+        return (cp >= 'a' && cp <= 'z') || (cp >= 'A' && cp <= 'Z');
+    if (cp >= 0xC0 && cp <= 0x17F)
+        return cp != 0xD7 && cp != 0xF7;
+    if (cp >= 0x386 && cp <= 0x3FF)
+        return cp != 0x387;
+    return cp >= 0x1F00 && cp <= 0x1FFF;
+}
+
+
+static bool
+isApostrophe(unsigned cp)
+{
+    return cp == '\'' || cp == 0x2019;  // right single quotation mark
+}
+
+
+static bool
+isHyphen(unsigned cp)
+{
+    return cp == '-' || cp == 0x2010;  // hyphen
+}
+
+
+static unsigned
+toLower(unsigned cp)
+{
+    if (cp < 0x80)
+        return (cp >= 'A' && cp <= 'Z') ? cp + 0x20 : cp;
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7)
+        return cp + 0x20;
+    if (cp >= 0x100 && cp <= 0x17F)
+    {
+        // Latin Extended-A alternates upper- and lower-case letters,
+        // with a change of parity after U+0138 and after U+0148.
+        if (cp == 0x178)
+            return 0xFF;
+        bool oddUpper = (cp >= 0x139 && cp <= 0x148) || cp >= 0x179;
+        if (cp == 0x130 || cp == 0x131 || cp == 0x138 || cp == 0x149 || cp == 0x17F)
+            return cp;
+        return ((cp & 1) != 0) == oddUpper ? cp + 1 : cp;
+    }
+    if (cp >= 0x391 && cp <= 0x3AB && cp != 0x3A2)
+        return cp + 0x20;
+    switch (cp)
+    {
+    case 0x386: return 0x3AC;
+    case 0x388: case 0x389: case 0x38A: return cp + 0x25;
+    case 0x38C: return 0x3CC;
+    case 0x38E: case 0x38F: return cp + 0x3F;
+    }
+    return cp;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Lemmatizer
+//
+
+
+// Part of the input that a worker thread annotates.
+//
+struct Chunk
+{
+    const FrenchVerbDictionary *fvd;
+    string text;
+    unsigned long long offset;  // of 'text' in the input, in bytes
+    string output;
+};
+
+
+class Lemmatizer
+{
+public:
+
+    explicit Lemmatizer(Chunk &_chunk)
+      : chunk(_chunk),
+        text(reinterpret_cast<const unsigned char *>(_chunk.text.data())),
+        length(_chunk.text.length()),
+        key(),
+        results(),
+        out()
+    {
+    }
+
+    void run();
+
+private:
+
+    void analyze(size_t begin, size_t end);
+    bool deconjugate(size_t begin, size_t end);
+
+    Chunk &chunk;
+    const unsigned char *text;
+    size_t length;
+    string key;  // lower-case version of the token being analyzed
+    vector<InflectionDesc> results;
+    ostringstream out;
+
+    // Forbidden operations:
+    Lemmatizer(const Lemmatizer &);
+    Lemmatizer &operator = (const Lemmatizer &);
+};
+
+
+void
+Lemmatizer::run()
+{
+    size_t i = 0;
+    while (i < length)
+    {
+        size_t len;
+        unsigned cp = decodeUTF8(text, i, length, len);
+        if (!isLetter(cp))
+        {
+            i += len;
+            continue;
+        }
+
+        // Extend the token over letters, and over a hyphen or an
+        // apostrophe that is followed by a letter.
+        //
+        size_t begin = i;
+        i += len;
+        while (i < length)
+        {
+            cp = decodeUTF8(text, i, length, len);
+            if (isLetter(cp))
+            {
+                i += len;
+                continue;
+            }
+            if (!isHyphen(cp) && !isApostrophe(cp))
+                break;
+
+            size_t nextLen;
+            bool letterFollows = (i + len < length
+                        && isLetter(decodeUTF8(text, i + len, length, nextLen)));
+            if (letterFollows)
+                i += len;
+            else
+            {
+                if (isApostrophe(cp))
+                    i += len;  // final apostrophe, as in "fa'"
+                break;
+            }
+        }
+
+        analyze(begin, i);
+    }
+
+    chunk.output = out.str();
+}
+
+
+// Writes the analyses of the token text[begin, end).  A compound token
+// that is not a known form as a whole is split: an elided word ending
+// with an apostrophe is dropped (e.g., "j'" in "j'aime") and the rest
+// is analyzed; otherwise, the parts around the first hyphen are
+// analyzed separately (e.g., "aime-t-il").
+//
+void
+Lemmatizer::analyze(size_t begin, size_t end)
+{
+    if (deconjugate(begin, end))
+        return;
+
+    size_t firstHyphen = end;
+    for (size_t i = begin; i < end; )
+    {
+        size_t len;
+        unsigned cp = decodeUTF8(text, i, end, len);
+        if (isApostrophe(cp))
+        {
+            if (i + len < end)
+                analyze(i + len, end);
+            return;
+        }
+        if (isHyphen(cp) && firstHyphen == end)
+            firstHyphen = i;
+        i += len;
+    }
+
+    if (firstHyphen != end)
+    {
+        size_t len;
+        (void) decodeUTF8(text, firstHyphen, end, len);
+        analyze(begin, firstHyphen);
+        analyze(firstHyphen + len, end);
+    }
+}
+
+
+// Looks up the token text[begin, end) in lower-case, with its typographic
+// apostrophes and hyphens replaced by their ASCII equivalents.
+// Returns true if it is a known inflection.
+//
+bool
+Lemmatizer::deconjugate(size_t begin, size_t end)
+{
+    key.clear();
+    for (size_t i = begin; i < end; )
+    {
+        size_t len;
+        unsigned cp = decodeUTF8(text, i, end, len);
+        if (isApostrophe(cp))
+            key += '\'';
+        else if (isHyphen(cp))
+            key += '-';
+        else
+            appendUTF8(key, toLower(cp));
+        i += len;
+    }
+
+    results.clear();
+    chunk.fvd->deconjugate(key, results);
+    if (results.empty())
+        return false;
+
+    unsigned long long offset = chunk.offset + begin;
+    for (vector<InflectionDesc>::const_iterator it = results.begin();
+                                                it != results.end(); ++it)
+    {
+        const InflectionDesc &d = *it;
+        out << offset
+            << '\t' << (end - begin)
+            << '\t';
+        out.write(reinterpret_cast<const char *>(text + begin), end - begin);
+        out << '\t' << d.infinitive
+            << ", " << FrenchVerbDictionary::getModeName(d.mtpn.mode)
+            << ", " << FrenchVerbDictionary::getTenseName(d.mtpn.tense)
+            << ", " << int(d.mtpn.person)
+            << ", " << (d.mtpn.plural ? "plural" : "singular")
+            << '\n';
+    }
+    return true;
+}
+
+
+static void *
+workerMain(void *p)
+{
+    Lemmatizer lemmatizer(*static_cast<Chunk *>(p));
+    lemmatizer.run();
+    return NULL;
+}
+
+
+// Reads the next chunk of the input into 'chunk.text', after the part
+// of the previous chunk that was carried over in 'carry'.  A chunk ends
+// after an ASCII white space, so that no token is cut, except when it
+// is the last one.  Returns false at the end of the input.
+//
+static bool
+readChunk(istream &in, string &carry, Chunk &chunk)
+{
+    chunk.text.swap(carry);
+    carry.clear();
+
+    vector<char> buffer(chunkSize);
+    while (in)
+    {
+        in.read(&buffer[0], buffer.size());
+        chunk.text.append(&buffer[0], size_t(in.gcount()));
+        if (chunk.text.length() < chunkSize)
+            continue;
+
+        string::size_type cut = chunk.text.find_last_of(" \t\r\n\f\v");
+        if (cut != string::npos)
+        {
+            carry.assign(chunk.text, cut + 1, string::npos);
+            chunk.text.erase(cut + 1);
+            return true;
+        }
+        // No white space yet: keep reading.
+    }
+    return !chunk.text.empty();
+}
+
+
+// Annotates the text of 'in' with 'numThreads' worker threads.
+// Each round reads one chunk per thread, lets the threads annotate them
+// and writes the annotations in the order of the input.
+//
+static int
+lemmatizeStream(const FrenchVerbDictionary &fvd, istream &in, size_t numThreads)
+{
+    vector<Chunk> chunks(numThreads);
+    vector<pthread_t> threads(numThreads);
+    string carry;
+    unsigned long long offset = 0;
+    bool eof = false;
+
+    while (!eof)
+    {
+        size_t numChunks = 0;
+        while (numChunks < numThreads)
+        {
+            Chunk &chunk = chunks[numChunks];
+            chunk.fvd = &fvd;
+            chunk.offset = offset;
+            chunk.output.clear();
+            if (!readChunk(in, carry, chunk))
+            {
+                eof = true;
+                break;
+            }
+            offset += chunk.text.length();
+            ++numChunks;
+        }
+
+        // The first chunk is annotated by this thread.
+        size_t numStarted = 1;
+        for ( ; numStarted < numChunks; ++numStarted)
+            if (pthread_create(&threads[numStarted], NULL,
+                               workerMain, &chunks[numStarted]) != 0)
+                break;
+        if (numChunks > 0)
+            (void) workerMain(&chunks[0]);
+        for (size_t i = 1; i < numChunks; ++i)
+        {
+            if (i < numStarted)
+                pthread_join(threads[i], NULL);
+            else
+                (void) workerMain(&chunks[i]);  // thread creation failed
+        }
+
+        for (size_t i = 0; i < numChunks; ++i)
+            cout << chunks[i].output;
+        cout.flush();
+    }
+
+    if (in.bad())
+    {
+        cerr << commandName << ": read error\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+
+#if defined(ENABLE_NLS) && defined(HAVE_GETOPT_LONG)
+
+static
+void
+displayVersionNo()
+{
+    cout << commandName << ' ' << VERSION << '\n';
+}
+
+
+static
+void
+displayHelp()
+{
+    cout << '\n';
+
+    displayVersionNo();
+
+    cout << "Part of " << PACKAGE << " " << VERSION << "\n";
+
+    cout <<
+"\n"
+"Copyright (C) " COPYRIGHT_YEARS " Pierre Sarrazin <http://sarrazip.com/>\n"
+"This program is free software; you may redistribute it under the terms of\n"
+"the GNU General Public License.  This program has absolutely no warranty.\n"
+    ;
+
+    cout <<
+"\n"
+"Usage: " << commandName << " [options] [FILE]\n"
+"\n"
+"Reads UTF-8 text from FILE, or from the standard input, and writes\n"
+"a line for each possible analysis of each conjugated verb:\n"
+"byte offset, byte length, verb as written, infinitive, mode, tense,\n"
+"person and number.\n"
+"\n"
+"Options:\n"
+"--help             Display this help page and exit\n"
+"--version          Display this program's version number and exit\n"
+"--lang=L           Select language L (fr for French, it for Italian)\n"
+"                   Default is French.\n"
+"--threads=N        Use N threads (default: number of processors)\n"
+"\n"
+    ;
+}
+
+#endif
+
+
+int
+main(int argc, char *argv[])
+{
+    setlocale(LC_CTYPE, "");
+
+    string langCode = "fr";
+    long numThreads = sysconf(_SC_NPROCESSORS_ONLN);
+
+    #if defined(ENABLE_NLS) && defined(HAVE_GETOPT_LONG)
+
+    /*  Interpret the command-line options:
+    */
+    int c;
+    do
+    {
+        c = getopt_long(argc, argv, "hv", knownOptions, NULL);
+
+        switch (c)
+        {
+            case EOF:
+                break;  // nothing to do
+
+            case 'l':
+                langCode = optarg;
+                if (FrenchVerbDictionary::parseLanguageCode(langCode) == FrenchVerbDictionary::NO_LANGUAGE)
+                {
+                    cerr << commandName << ": invalid language code " << optarg << "\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+
+            case 'j':
+            {
+                char *end;
+                numThreads = strtol(optarg, &end, 10);
+                if (*optarg == '\0' || *end != '\0' || numThreads < 1)
+                {
+                    cerr << commandName << ": invalid number of threads " << optarg << "\n";
+                    return EXIT_FAILURE;
+                }
+                break;
+            }
+
+            case 'v':
+                displayVersionNo();
+                return EXIT_SUCCESS;
+
+            case 'h':
+                displayHelp();
+                return EXIT_SUCCESS;
+
+            default:
+                displayHelp();
+                return EXIT_FAILURE;
+        }
+    } while (c != EOF && c != '?');
+
+    #else
+
+    int optind = 1;
+
+    #endif
+
+    if (numThreads < 1)
+        numThreads = 1;
+    if (size_t(numThreads) > maxThreads)
+        numThreads = long(maxThreads);
+
+    if (argc - optind > 1)
+    {
+        cerr << commandName << ": at most one file can be given\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        FrenchVerbDictionary::Language lang = FrenchVerbDictionary::parseLanguageCode(langCode);
+        if (lang == FrenchVerbDictionary::NO_LANGUAGE)
+            lang = FrenchVerbDictionary::FRENCH;
+
+        string conjFN, verbsFN;
+        FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, lang);
+
+        // Like the other commands, do not tolerate missing accents.
+        FrenchVerbDictionary fvd(conjFN, verbsFN, false, lang);
+
+        if (optind == argc || strcmp(argv[optind], "-") == 0)
+            return lemmatizeStream(fvd, cin, size_t(numThreads));
+
+        ifstream file(argv[optind], ios::in | ios::binary);
+        if (!file)
+        {
+            cerr << commandName << ": cannot open " << argv[optind] << "\n";
+            return EXIT_FAILURE;
+        }
+        return lemmatizeStream(fvd, file, size_t(numThreads));
+    }
+    catch (const exception &e)
+    {
+        cerr << commandName << ": exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -25,6 +25,8 @@
 #include "gui/conjugation.h"
 #include "util.h"
 
+#include <verbiste/MultiLanguageIndex.h>
+
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,6 +60,7 @@ gboolean hideOnDelete = TRUE;
 
 FrenchVerbDictionary *frenchDict = NULL;
 FrenchVerbDictionary *italianDict = NULL;
+MultiLanguageIndex *languageIndex = NULL;
 
 static GtkWidget *resultWin = NULL;
 static GtkWidget *verbEntry = NULL;
@@ -1163,20 +1166,22 @@ tolowerUTF8(const string &s)
 
 static
 GtkWidget *
-createTableCell(const VVS &utf8Tense,
+createTableCell(const ConjugationBuffer &conjug,
+                size_t tenseNo,
                 const string &utf8TenseName,
                 const string &utf8UserText,
-                FrenchVerbDictionary *fvd)
+                bool includePronouns)
 {
     GtkWidget *vbox = gtk_vbox_new(FALSE, SP);
     GtkWidget *nameLabel = newLabel("<b><u>" + utf8TenseName + "</u></b>", TRUE);
 
     string utf8Persons = createTableCellText(
-                                *fvd,
-                                utf8Tense,
+                                conjug,
+                                tenseNo,
                                 tolowerUTF8(utf8UserText),
                                 "<span foreground=\"red\">",
-                                "</span>");
+                                "</span>",
+                                includePronouns);
 
     GtkWidget *personsLabel = newLabel(utf8Persons, TRUE);
 
@@ -1212,6 +1217,9 @@ public:
 
 static size_t deconjugate(FrenchVerbDictionary &fvd, const string &utf8UserText,
                           const string &lowerCaseUTF8UserText, bool includePronouns);
+static size_t appendConjugationPages(FrenchVerbDictionary &fvd,
+                                     const vector<InflectionDesc> &v,
+                                     const string &utf8UserText, bool includePronouns);
 static size_t deconjugateFuzzyMatches(FrenchVerbDictionary &fvd, const string &utf8UserText,
                                       const string &lowerCaseUTF8UserText, bool includePronouns);
 static void finishProcessingText(const string &utf8UserText, size_t numPages);
@@ -1245,15 +1253,27 @@ processText(const string &utf8UserText)
         bool includePronouns = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(showPronounsCB));
         bool useFrenchDict   = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(useFrenchDictCB));
         bool useItalianDict  = gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(useItalianDictCB));
+
+        // Search both dictionaries in a single pass, then keep the
+        // results of the selected ones.  See initDictPointers() for
+        // the numbers of the dictionaries.
+        //
+        vector< vector<InflectionDesc> > results;
+        if (useFrenchDict || useItalianDict)
+        {
+            assert(languageIndex != NULL);
+            languageIndex->deconjugate(lowerCaseUTF8UserText, results);
+        }
+
         if (useFrenchDict)
         {
-            numFrenchPages += deconjugate(*frenchDict, utf8UserText, lowerCaseUTF8UserText, includePronouns);
+            numFrenchPages += appendConjugationPages(*frenchDict, results[0], utf8UserText, includePronouns);
             if (numFrenchPages == 0)
                 numFrenchPages += deconjugateFuzzyMatches(*frenchDict, utf8UserText, lowerCaseUTF8UserText, includePronouns);
         }
         if (useItalianDict)
         {
-            numItalianPages += deconjugate(*italianDict, utf8UserText, lowerCaseUTF8UserText, includePronouns);
+            numItalianPages += appendConjugationPages(*italianDict, results[1], utf8UserText, includePronouns);
             if (numItalianPages == 0)
                 numItalianPages += deconjugateFuzzyMatches(*italianDict, utf8UserText, lowerCaseUTF8UserText, includePronouns);
         }
@@ -1278,35 +1298,48 @@ deconjugate(FrenchVerbDictionary &fvd, const string &utf8UserText,
              << "', includePronouns=" << includePronouns
              << ")" << endl;
 
+    vector<InflectionDesc> v;
+    fvd.deconjugate(lowerCaseUTF8UserText, v);
+    return appendConjugationPages(fvd, v, utf8UserText, includePronouns);
+}
+
+
+// Creates a notebook page for the conjugation of each deconjugation
+// result in 'v', which must come from 'fvd'.
+// Returns the number of pages created in the notebook.
+//
+size_t
+appendConjugationPages(FrenchVerbDictionary &fvd, const vector<InflectionDesc> &v,
+                       const string &utf8UserText, bool includePronouns)
+{
     bool isItalian = (fvd.getLanguage() == FrenchVerbDictionary::ITALIAN);
 
     /*
         For each possible deconjugation, take the infinitive form and
         obtain its complete conjugation.
     */
-    vector<InflectionDesc> v;
-    fvd.deconjugate(lowerCaseUTF8UserText, v);
-
     size_t numPages = 0;  // counts number of pages added to notebook
     string prevUTF8Infinitive, prevTemplateName;
+    ConjugationBuffer conjug;  // reused for each result
 
     for (vector<InflectionDesc>::const_iterator it = v.begin();
                                             it != v.end(); it++)
     {
         const InflectionDesc &d = *it;
 
-        VVVS conjug;
-        getConjugation(fvd, d.infinitive, d.templateName, conjug, includePronouns);
+        // The pronouns are always generated; createTableCell() shows
+        // them or not.
+        getConjugationInto(fvd, d.infinitive, d.templateName, conjug, true);
 
-        if (conjug.size() == 0           // if no tenses
-            || conjug[0].size() == 0     // if no infinitive tense
-            || conjug[0][0].size() == 0  // if no person in inf. tense
-            || conjug[0][0][0].empty())  // if infinitive string empty
+        if (conjug.getNumTenses() == 0              // if no tenses
+            || conjug.getNumPersons(0) == 0         // if no infinitive tense
+            || conjug.getNumForms(0, 0) == 0        // if no person in inf. tense
+            || conjug.getFormLength(0, 0, 0) == 0)  // if infinitive string empty
         {
             continue;
         }
 
-        string utf8Infinitive = conjug[0][0][0];
+        string utf8Infinitive = conjug.getForm(0, 0, 0);
 
         if (trace)
             cout << "deconjugate: d.templateName='" << d.templateName
@@ -1326,8 +1359,7 @@ deconjugate(FrenchVerbDictionary &fvd, const string &utf8UserText,
         numPages++;
 
         int i = 0;
-        for (VVVS::const_iterator t = conjug.begin();
-                                t != conjug.end(); t++, i++)
+        for (size_t t = 0; t < conjug.getNumTenses(); t++, i++)
         {
             if (i == 1)
                 i = 4;
@@ -1343,7 +1375,8 @@ deconjugate(FrenchVerbDictionary &fvd, const string &utf8UserText,
                 continue;
 
             GtkWidget *cell = createTableCell(
-                                *t, utf8TenseName, utf8UserText, &fvd);
+                                conjug, t, utf8TenseName, utf8UserText,
+                                includePronouns);
             gtk_table_attach(GTK_TABLE(rp->table), cell,
                                 col, col + 1, row, row + 1,
                                 GTK_FILL, GTK_FILL,
@@ -1407,14 +1440,18 @@ isWideCharConsonant(wchar_t c)
 struct Score
 {
     double coefficient;  // 0..1 (1 = same)
+    unsigned frequencyRank;  // VerbRecordTable::NO_RANK if unknown
     string verbName;
 
-    Score(double c, const string &v) : coefficient(c), verbName(v) {}
+    Score(double c, unsigned r, const string &v)
+      : coefficient(c), frequencyRank(r), verbName(v) {}
 
     static bool decreasingCoefficientOrder(const Score &a, const Score &b)
     {
         if (a.coefficient != b.coefficient)
             return a.coefficient > b.coefficient;
+        if (a.frequencyRank != b.frequencyRank)
+            return a.frequencyRank < b.frequencyRank;  // most frequent verb first
         return a.verbName < b.verbName;  // use dictionary order
     }
 };
@@ -1437,10 +1474,10 @@ fuzzyMatch(FrenchVerbDictionary &fvd,
     bool isInitConsonant = isWideCharConsonant(initial);
     vector<Score> scores;
 
-    for (VerbTable::const_iterator it = fvd.beginKnownVerbs();
-                                   it != fvd.endKnownVerbs(); ++it)
+    const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+    for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
     {
-        const string &verbName = it->first;
+        const string verbName(knownVerbs.getInfinitive(id), knownVerbs.getInfinitiveLength(id));
         assert(!verbName.empty());  // empty verb names unexpected in dictionary
 
         const wstring wideVerbName = fvd.utf8ToWide(verbName);
@@ -1454,7 +1491,8 @@ fuzzyMatch(FrenchVerbDictionary &fvd,
         {
             if (trace)
                 wcout << "  MATCH\t" << coef << "\t" << wideVerbName << "\n";
-            scores.push_back(Score(coef, fvd.wideToUTF8(wideVerbName)));
+            scores.push_back(Score(coef, knownVerbs.getFrequencyRank(id),
+                                   fvd.wideToUTF8(wideVerbName)));
         }
     }
 
@@ -1,5 +1,7 @@
 #include "util.h"
 
+#include <verbiste/MultiLanguageIndex.h>
+
 #include <gtk/gtkwindow.h>
 
 using namespace std;
@@ -9,6 +11,7 @@ string
 initDictPointers()
 {
     extern verbiste::FrenchVerbDictionary *frenchDict, *italianDict;
+    extern verbiste::MultiLanguageIndex *languageIndex;
 
     try
     {
@@ -23,10 +26,19 @@ initDictPointers()
         FrenchVerbDictionary::getXMLFilenames(conjFN, verbsFN, FrenchVerbDictionary::ITALIAN);
         //cout << "it: '" << conjFN << "', '" << verbsFN << "'\n";
         italianDict = new FrenchVerbDictionary(conjFN, verbsFN, true, FrenchVerbDictionary::ITALIAN);  // may throw
+
+        // Both dictionaries are searched at once by processText(),
+        // French first.
+        vector<const FrenchVerbDictionary *> dicts;
+        dicts.push_back(frenchDict);
+        dicts.push_back(italianDict);
+        languageIndex = new MultiLanguageIndex(dicts);
         return string();  // success
     }
     catch(logic_error &e)
     {
+        delete languageIndex;
+        languageIndex = NULL;
         delete italianDict;
         italianDict = NULL;
         delete frenchDict;
@@ -6,7 +6,7 @@
 #include <string>
 
 
-// Inits global variables frenchDict and italianDict.
+// Inits global variables frenchDict, italianDict and languageIndex.
 // Returns empty string on success, or error message otherwise.
 std::string initDictPointers();
 
@@ -40,64 +40,31 @@ getConjugation(const FrenchVerbDictionary &fvd,
                         VVVS &dest,
                         bool includePronouns)
 {
-    const TemplateSpec *templ = fvd.getTemplate(tname);
-    if (templ == NULL)
-        return;
+    ConjugationBuffer conjug;
+    getConjugationInto(fvd, infinitive, tname, conjug, includePronouns);
 
-    try
+    for (size_t t = 0; t < conjug.getNumTenses(); t++)
     {
-        static const struct { Mode m; Tense t; } table[] =
+        dest.push_back(VVS());
+        VVS &tenseDest = dest.back();
+        for (size_t p = 0; p < conjug.getNumPersons(t); p++)
         {
-            { INFINITIVE_MODE, PRESENT_TENSE },
-            { INDICATIVE_MODE, PRESENT_TENSE },
-            { INDICATIVE_MODE, IMPERFECT_TENSE },
-            { INDICATIVE_MODE, FUTURE_TENSE },
-            { INDICATIVE_MODE, PAST_TENSE },
-            { CONDITIONAL_MODE, PRESENT_TENSE },
-            { SUBJUNCTIVE_MODE, PRESENT_TENSE },
-            { SUBJUNCTIVE_MODE, IMPERFECT_TENSE },
-            { IMPERATIVE_MODE, PRESENT_TENSE },
-            { PARTICIPLE_MODE, PRESENT_TENSE },
-            { PARTICIPLE_MODE, PAST_TENSE },
-            { GERUND_MODE, PRESENT_TENSE },  // italian only
-            { INVALID_MODE, INVALID_TENSE }  // marks the end
-        };
-
-
-        string radical = FrenchVerbDictionary::getRadical(infinitive, tname);
-
-        bool isItalian = (fvd.getLanguage() == FrenchVerbDictionary::ITALIAN);
-
-        for (int j = 0; table[j].m != INVALID_MODE; j++)
-        {
-            if (table[j].m == GERUND_MODE && !isItalian)
-                continue;
-
-            dest.push_back(VVS());
-            VVS &tenseDest = dest.back();
-
-            VVS conjug;
-            fvd.generateTense(radical, *templ, table[j].m, table[j].t, conjug,
-                                includePronouns,
-                                fvd.isVerbStartingWithAspirateH(infinitive),
-                                isItalian);
-
-            for (VVS::const_iterator p = conjug.begin(); p != conjug.end(); p++)
-            {
-                tenseDest.push_back(VS());
-                for (VS::const_iterator i = p->begin(); i != p->end(); i++)
-                {
-                    string s = *i;
-                    tenseDest.back().push_back(s);
-                }
-            }
+            tenseDest.push_back(VS());
+            for (size_t i = 0; i < conjug.getNumForms(t, p); i++)
+                tenseDest.back().push_back(conjug.getForm(t, p, i));
         }
     }
-    catch (logic_error &e)
-    {
-        dest.clear();
-        return;
-    }
+}
+
+
+void
+getConjugationInto(const FrenchVerbDictionary &fvd,
+                        const string &infinitive,
+                        const string &tname,
+                        ConjugationBuffer &dest,
+                        bool includePronouns)
+{
+    fvd.generateConjugation(infinitive, tname, dest, includePronouns);
 }
 
 
@@ -201,3 +168,45 @@ createTableCellText(verbiste::FrenchVerbDictionary &fvd,
     }
     return persons;
 }
+
+
+string
+createTableCellText(const ConjugationBuffer &conjug,
+                    size_t tenseNo,
+                    const string &lowerCaseUTF8UserText,
+                    const string &openMark,
+                    const string &closeMark,
+                    bool includePronouns)
+{
+    const ConjugationBuffer::FormPart firstPart =
+            (includePronouns ? ConjugationBuffer::SUBORDINATOR : ConjugationBuffer::RADICAL);
+
+    string persons;
+    for (size_t p = 0; p < conjug.getNumPersons(tenseNo); p++)
+    {
+        if (p != 0)
+            persons += "\n";
+
+        for (size_t i = 0; i < conjug.getNumForms(tenseNo, p); i++)
+        {
+            if (i != 0)
+                persons += ", ";
+
+            // The verb itself (radical and ending) is compared with the
+            // user text, without the subordinator and the pronoun.
+            //
+            bool matches = FrenchVerbDictionary::equalIgnoringAccents(
+                    conjug.getFormData(tenseNo, p, i, ConjugationBuffer::RADICAL),
+                    conjug.getFormLength(tenseNo, p, i, ConjugationBuffer::RADICAL),
+                    lowerCaseUTF8UserText.data(), lowerCaseUTF8UserText.length());
+
+            if (matches)
+                persons += openMark;
+            persons.append(conjug.getFormData(tenseNo, p, i, firstPart),
+                           conjug.getFormLength(tenseNo, p, i, firstPart));
+            if (matches)
+                persons += closeMark;
+        }
+    }
+    return persons;
+}
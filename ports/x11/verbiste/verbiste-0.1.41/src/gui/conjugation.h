@@ -51,6 +51,28 @@ void getConjugation(const verbiste::FrenchVerbDictionary &fvd,
                         bool includePronouns = false);
 
 
+/** Obtains the conjugation of the given infinitive into a reusable buffer.
+    Same as getConjugation(), but the tenses are written into 'dest',
+    which is cleared first.  When 'dest' has been used before, this
+    normally allocates no memory apart from the radical.
+    @param  fvd             verb dictionary from which to obtain
+                            the conjugation
+    @param  infinitive      UTF-8 string containing the infinitive form
+                            of the verb to conjugate (e.g., "manger")
+    @param  tname           conjugation template name to use (e.g., "aim:er")
+    @param  dest            buffer into which the tenses are written,
+                            in the same order as with getConjugation();
+                            empty if the template is unknown
+    @param  includePronouns put pronouns before conjugated verbs in the
+                            modes where pronouns are used
+*/
+void getConjugationInto(const verbiste::FrenchVerbDictionary &fvd,
+                        const std::string &infinitive,
+                        const std::string &tname,
+                        ConjugationBuffer &dest,
+                        bool includePronouns = false);
+
+
 /** Get the tense name for a certain cell of the conjugation table.
     The conjugation table is a 4x4 grid and 11 of the 16 cells are
     used by the tenses to be displayed.
@@ -95,4 +117,27 @@ std::string createTableCellText(verbiste::FrenchVerbDictionary &fvd,
                                 const std::string &closeMark);
 
 
+/** Composes the text of the conjugation in a certain tense.
+    Same as the preceding function, but takes the tense from a buffer
+    filled by getConjugationInto().  The user text is compared with
+    the radical and ending of each form, without removing pronouns
+    nor converting the forms.
+    @param        conjug                buffer that contains the tense
+    @param        tenseNo               index of the tense in 'conjug'
+    @param        lowerCaseUTF8UserText see the preceding function
+    @param        openMark              see the preceding function
+    @param        closeMark             see the preceding function
+    @param        includePronouns       display the subordinators and
+                                        pronouns that 'conjug' contains;
+                                        if false, only the verbs are
+                                        displayed
+*/
+std::string createTableCellText(const ConjugationBuffer &conjug,
+                                size_t tenseNo,
+                                const std::string &lowerCaseUTF8UserText,
+                                const std::string &openMark,
+                                const std::string &closeMark,
+                                bool includePronouns = true);
+
+
 #endif  /* _H_conjugation */
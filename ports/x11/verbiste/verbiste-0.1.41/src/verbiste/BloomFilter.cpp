@@ -0,0 +1,105 @@
+/*  $Id$
+    BloomFilter.cpp - Probabilistic set of strings
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "BloomFilter.h"
+
+#include <assert.h>
+#include <math.h>
+#include <string.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+BloomFilter::BloomFilter()
+  : blocks(),
+    numKeys(0)
+{
+}
+
+
+void
+BloomFilter::init(size_t expectedNumKeys)
+{
+    const size_t bitsPerBlock = sizeof(Block) * 8;
+    size_t numBlocks = (expectedNumKeys * bitsPerKey + bitsPerBlock - 1) / bitsPerBlock;
+    if (numBlocks == 0)
+        numBlocks = 1;
+
+    Block zero;
+    memset(&zero, 0, sizeof(zero));
+    vector<Block>(numBlocks, zero).swap(blocks);
+    numKeys = 0;
+}
+
+
+void
+BloomFilter::assign(const Hash *words, size_t numWords, size_t n)
+{
+    assert(numWords != 0 && numWords % WORDS_PER_BLOCK == 0);
+    vector<Block>(numWords / WORDS_PER_BLOCK).swap(blocks);
+    memcpy(&blocks[0], words, numWords * sizeof(Hash));
+    numKeys = n;
+}
+
+
+void
+BloomFilter::clear()
+{
+    // Use swap() to really free the memory.
+    vector<Block>().swap(blocks);
+    numKeys = 0;
+}
+
+
+void
+BloomFilter::add(Hash h)
+{
+    assert(isBuilt());
+    Hash m = mix(h);
+    Block &b = blocks[getBlockIndex(m, blocks.size())];
+    Hash bits = getBitPositions(m);
+    for (int i = 0; i < numHashes; ++i, bits >>= 9)
+    {
+        unsigned pos = unsigned(bits & 511);
+        b.words[pos >> 6] |= 1ULL << (pos & 63);
+    }
+    ++numKeys;
+}
+
+
+double
+BloomFilter::getExpectedFalsePositiveRate() const
+{
+    if (!isBuilt())
+        return 1.0;
+    double numBits = double(blocks.size()) * sizeof(Block) * 8;
+    return pow(1.0 - exp(-double(numHashes) * double(numKeys) / numBits),
+               double(numHashes));
+}
+
+
+size_t
+BloomFilter::computeMemoryConsumption() const
+{
+    return sizeof(*this) + blocks.size() * sizeof(Block);
+}
@@ -0,0 +1,220 @@
+/*  $Id$
+    BloomFilter.h - Probabilistic set of strings
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_BloomFilter
+#define _H_BloomFilter
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Bloom filter: set of strings that can answer "certainly absent"
+    or "maybe present" using a few bits per string.
+
+    A string that has been added is always reported as maybe present.
+    A string that has not been added is reported as maybe present with
+    a probability called the false positive rate, which is about 1%
+    with the number of bits per key used by this class.
+
+    The filter is "blocked": the bits of a key are all in the same
+    64-byte block, so that a query reads a single cache line.
+
+    Keys are identified by a hash that can be computed incrementally,
+    so that the keys that share a prefix can be added without
+    concatenating strings: see beginHash() and continueHash().
+*/
+class BloomFilter
+{
+public:
+
+    /** Hash of a key, or of a prefix of it.
+    */
+    typedef unsigned long long Hash;
+
+    /** Returns the hash of the empty string.
+    */
+    static Hash beginHash() { return 14695981039346656037ULL; }
+
+    /** Returns the hash of the string formed by appending 'len' bytes
+        to the string whose hash is 'h'.
+    */
+    static Hash continueHash(Hash h, const char *s, size_t len)
+    {
+        // FNV-1a.
+        for (size_t i = 0; i < len; ++i)
+        {
+            h ^= (unsigned char) s[i];
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+    /** Returns the hash of a string.
+    */
+    static Hash hash(const std::string &key)
+    {
+        return continueHash(beginHash(), key.data(), key.length());
+    }
+
+    /** Creates an empty filter, which is not built.
+    */
+    BloomFilter();
+
+    /** Allocates the bits of a filter that will receive about
+        'expectedNumKeys' keys, and clears them.
+        The filter is built afterwards.
+    */
+    void init(size_t expectedNumKeys);
+
+    /** Replaces the bits of this filter with a copy of those returned
+        by getWords() on a filter built earlier.
+        The filter is built afterwards.
+        @param  words       copy of the bits
+        @param  numWords    value of getNumWords(), which must be a
+                            non-zero multiple of WORDS_PER_BLOCK
+        @param  n           value of getNumKeys()
+    */
+    void assign(const Hash *words, size_t numWords, size_t n);
+
+    /** Frees the bits.  The filter is not built afterwards.
+    */
+    void clear();
+
+    /** Indicates if init() has been called since the last call to
+        clear(), if any.
+    */
+    bool isBuilt() const { return !blocks.empty(); }
+
+    /** Adds a key by its hash.  The filter must be built.
+    */
+    void add(Hash h);
+
+    /** Indicates if a key may have been added, given its hash.
+        Returns false if it certainly has not been added.
+        The filter must be built.
+    */
+    bool mayContain(Hash h) const
+    {
+        return mayContain(blocks[0].words, blocks.size() * WORDS_PER_BLOCK, h);
+    }
+
+    /** Indicates if a key may have been added.
+    */
+    bool mayContain(const std::string &key) const
+    {
+        return mayContain(hash(key));
+    }
+
+    /** Number of words in a block of bits. */
+    enum { WORDS_PER_BLOCK = 8 };
+
+    /** Returns the bits of the filter, which must be built.
+        They can be copied, e.g., to shared memory, and queried with
+        the static version of mayContain().
+    */
+    const Hash *getWords() const { return blocks[0].words; }
+
+    /** Returns the number of words returned by getWords(),
+        a multiple of WORDS_PER_BLOCK.
+    */
+    size_t getNumWords() const { return blocks.size() * WORDS_PER_BLOCK; }
+
+    /** Indicates if a key may have been added to the filter whose bits
+        are a copy of those returned by getWords().
+        @param  words       copy of the bits
+        @param  numWords    value of getNumWords()
+        @param  h           hash of the key
+    */
+    static bool mayContain(const Hash *words, size_t numWords, Hash h)
+    {
+        Hash m = mix(h);
+        const Hash *b = words + getBlockIndex(m, numWords / WORDS_PER_BLOCK) * WORDS_PER_BLOCK;
+        Hash bits = getBitPositions(m);
+        for (int i = 0; i < numHashes; ++i, bits >>= 9)
+        {
+            unsigned pos = unsigned(bits & 511);
+            if ((b[pos >> 6] & (1ULL << (pos & 63))) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    /** Returns the number of calls to add() since init().
+    */
+    size_t getNumKeys() const { return numKeys; }
+
+    /** Returns the theoretical false positive rate of an unblocked
+        filter of the same size with the same number of keys.
+        The rate of this filter is slightly higher.
+    */
+    double getExpectedFalsePositiveRate() const;
+
+    /** Returns the approximate number of bytes used by this filter.
+    */
+    size_t computeMemoryConsumption() const;
+
+private:
+
+    enum { bitsPerKey = 10, numHashes = 7 };
+
+    struct Block
+    {
+        Hash words[WORDS_PER_BLOCK];  // 512 bits
+    };
+
+    // Maps the high half of a mixed hash to [0, numBlocks).
+    static size_t getBlockIndex(Hash m, size_t numBlocks)
+    {
+        return size_t(((m >> 32) * Hash(numBlocks)) >> 32);
+    }
+
+    // Returns 'numHashes' bit positions of 9 bits each, in the low bits,
+    // taken from the low half of a mixed hash.
+    static Hash getBitPositions(Hash m)
+    {
+        return (m & 0xFFFFFFFFULL) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    // Spreads the bits of an FNV hash (MurmurHash3's finalizer).
+    static Hash mix(Hash h)
+    {
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDULL;
+        h ^= h >> 33;
+        h *= 0xC4CEB9FE1A85EC53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+
+    std::vector<Block> blocks;
+    size_t numKeys;
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_BloomFilter */
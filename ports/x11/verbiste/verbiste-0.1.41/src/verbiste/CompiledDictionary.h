@@ -0,0 +1,164 @@
+/*  $Id$
+    CompiledDictionary.h - Dictionary data compiled into the library
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_CompiledDictionary
+#define _H_CompiledDictionary
+
+#include <stddef.h>
+
+
+namespace verbiste {
+
+
+/** Contents of a pair of conjugation and verb XML files, in a form
+    that can be compiled into the library.
+
+    The compile-data program generates one such structure per language
+    at build time from the XML files in data/.  All the strings are stored
+    in a single arena, in UTF-8, and are designated by their offset in it.
+
+    The conjugation templates are described by a sequence of events, in
+    the order in which the elements appear in the XML document.  Each
+    event opens an element; the element ends where the next event of
+    the same or of an upper level begins.
+
+    The indexes that FrenchVerbDictionary builds from the templates and
+    the verbs (the automata of the radicals and of the terminations, and
+    the filter of the verb forms) are also compiled, so that they are
+    loaded instead of being built.  The slot sets that they designate
+    are those that the templates produce when they are loaded.
+    Each template is designated by the rank of its name among the names
+    of all the templates, in increasing byte order.
+
+    The frequency ranks are those of the verb-frequencies-<lang>.txt file
+    that accompanies the verb XML file, if any.
+*/
+struct CompiledDictionary
+{
+    enum EventType
+    {
+        TEMPLATE,    // string: template name (e.g., "aim:er")
+        MODE,        // string: mode element name (e.g., "indicative")
+        TENSE,       // string: tense element name (e.g., "present")
+        PERSON,      // string: unused
+        INFLECTION   // string: inflection (e.g., "es")
+    };
+
+    struct Event
+    {
+        unsigned char type;  // EventType
+        unsigned string;
+    };
+
+    struct Verb
+    {
+        unsigned infinitive;
+        unsigned templateName;
+        unsigned char aspirateH;  // 1 if the verb starts with an aspirate h
+    };
+
+    // As in Dawg.
+    struct State
+    {
+        unsigned firstTransition;
+        unsigned numTransitions;
+        unsigned valueIndex;  // ~0u if none
+    };
+
+    struct Transition
+    {
+        unsigned char label;
+        unsigned target;
+    };
+
+    struct ValueList
+    {
+        unsigned first;  // index of the first value in the list
+        unsigned count;
+    };
+
+    struct RadicalValue
+    {
+        unsigned templateNo;
+        unsigned correctRadical;  // empty if equal to the key
+    };
+
+    struct TerminationValue
+    {
+        unsigned templateNo;
+        unsigned slotSet;
+    };
+
+    struct Automaton
+    {
+        const State *states;
+        size_t numStates;
+        const Transition *transitions;
+        size_t numTransitions;
+        const ValueList *valueLists;  // designated by State::valueIndex
+        size_t numValueLists;
+        unsigned initialState;
+        size_t numTrieStates;  // of the trie it was built from
+    };
+
+    /** Indexes built with or without the unaccented variants. */
+    struct Indexes
+    {
+        size_t numSlots;  // of the slot table that the templates produce
+        size_t numSlotSets;
+        Automaton radicals;
+        const RadicalValue *radicalValues;  // designated by the value lists
+        Automaton terminations;  // keys are reversed terminations
+        const TerminationValue *terminationValues;
+        const unsigned long long *filterWords;  // see BloomFilter::getWords()
+        size_t numFilterWords;
+        size_t numFilterKeys;
+    };
+
+    const char *languageCode;  // e.g., "fr"
+    const char *arena;  // null-terminated strings
+    size_t arenaSize;
+    const Event *events;
+    size_t numEvents;
+    const Verb *verbs;
+    size_t numVerbs;
+    const unsigned *rankedVerbs;  // infinitives, from the most frequent verb
+    size_t numRankedVerbs;
+    const Indexes *indexes;  // of the verbs only
+    const Indexes *indexesWithoutAccents;  // also of their unaccented variants
+};
+
+
+/** Data compiled from conjugation-fr.xml and verbs-fr.xml. */
+extern const CompiledDictionary compiledDictionaryFr;
+
+/** Data compiled from conjugation-it.xml and verbs-it.xml. */
+extern const CompiledDictionary compiledDictionaryIt;
+
+/** Data compiled from conjugation-el.xml and verbs-el.xml. */
+extern const CompiledDictionary compiledDictionaryEl;
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_CompiledDictionary */
@@ -0,0 +1,244 @@
+/*  $Id$
+    ConjugationCache.cpp - Bounded cache of complete conjugation tables
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "ConjugationCache.h"
+#include "RefCounted.h"
+
+#include <assert.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+// Conjugation table with a reference count.
+//
+class ConjugationCache::Table : public RefCounted<Table>
+{
+public:
+    ConjugationBuffer buffer;
+
+    Table() : buffer() {}
+
+private:
+    friend class RefCounted<Table>;
+
+    ~Table() {}  // use release()
+};
+
+
+// Locks a mutex for the lifetime of this object.
+//
+class MutexLock
+{
+public:
+    MutexLock(pthread_mutex_t &m) : mutex(m) { pthread_mutex_lock(&mutex); }
+    ~MutexLock() { pthread_mutex_unlock(&mutex); }
+private:
+    pthread_mutex_t &mutex;
+
+    // Forbidden operations:
+    MutexLock(const MutexLock &);
+    MutexLock &operator = (const MutexLock &);
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Handle local class
+//
+
+
+ConjugationCache::Handle::Handle(Table *t)
+  : table(t)
+{
+    assert(table != NULL);
+}
+
+
+ConjugationCache::Handle::Handle(const Handle &h)
+  : table(h.table)
+{
+    addRef(table);
+}
+
+
+ConjugationCache::Handle &
+ConjugationCache::Handle::operator = (const Handle &h)
+{
+    assignRef(table, h.table);
+    return *this;
+}
+
+
+ConjugationCache::Handle::~Handle()
+{
+    release(table);
+}
+
+
+const ConjugationBuffer &
+ConjugationCache::Handle::operator * () const
+{
+    assert(table != NULL);
+    return table->buffer;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// ConjugationCache
+//
+
+
+ConjugationCache::ConjugationCache(const FrenchVerbDictionary &_fvd,
+                                   size_t _capacity) throw(logic_error)
+  : fvd(_fvd),
+    lruList(),
+    index(),
+    stats(),
+    mutex()
+{
+    stats.capacity = _capacity;
+    if (pthread_mutex_init(&mutex, NULL) != 0)
+        throw logic_error("could not create conjugation cache mutex");
+}
+
+
+ConjugationCache::~ConjugationCache()
+{
+    clear();
+    pthread_mutex_destroy(&mutex);
+}
+
+
+ConjugationCache::Handle
+ConjugationCache::getConjugation(const string &infinitive,
+                                 const string &templateName,
+                                 bool includePronouns)
+{
+    return getTable(Key(infinitive, templateName, includePronouns), true);
+}
+
+
+ConjugationCache::Handle
+ConjugationCache::getTable(const Key &key, bool updateStats)
+{
+    {
+        MutexLock lock(mutex);
+        Index::iterator it = index.find(key);
+        if (it != index.end())
+        {
+            if (updateStats)
+                ++stats.hits;
+            // Move the table to the front of the list.
+            lruList.splice(lruList.begin(), lruList, it->second);
+            Table *table = it->second->second;
+            table->addRef();
+            return Handle(table);
+        }
+        if (updateStats)
+            ++stats.misses;
+    }
+
+    // Generate the table without holding the mutex, since this is
+    // the expensive part and the dictionary is safe to use concurrently.
+    //
+    Table *table = new Table();  // reference owned by the returned handle
+    fvd.generateConjugation(key.infinitive, key.templateName, table->buffer,
+                            key.includePronouns);
+    Handle handle(table);
+
+    MutexLock lock(mutex);
+    if (stats.capacity == 0 || index.find(key) != index.end())
+        return handle;  // not cached, or inserted by another thread meanwhile
+
+    if (index.size() >= stats.capacity)
+        evictLeastRecentlyUsed();
+
+    table->addRef();  // reference owned by the cache
+    lruList.push_front(make_pair(key, table));
+    index.insert(make_pair(key, lruList.begin()));
+    stats.numTables = index.size();
+    return handle;
+}
+
+
+// The mutex must be locked.
+//
+void
+ConjugationCache::evictLeastRecentlyUsed()
+{
+    assert(!lruList.empty());
+    index.erase(lruList.back().first);
+    lruList.back().second->release();
+    lruList.pop_back();
+    ++stats.evictions;
+    stats.numTables = index.size();
+}
+
+
+size_t
+ConjugationCache::prewarm(const vector<string> &infinitives,
+                          size_t maxVerbs,
+                          bool includePronouns)
+{
+    const VerbRecordTable &knownVerbs = fvd.getKnownVerbs();
+    size_t numVerbs = min(maxVerbs, infinitives.size());
+    size_t numTables = 0;
+    for (size_t i = numVerbs; i-- > 0; )
+    {
+        VerbRecordTable::VerbId id = knownVerbs.find(infinitives[i]);
+        for (size_t t = 0; t < knownVerbs.getNumTemplates(id); ++t, ++numTables)
+            (void) getTable(Key(infinitives[i], knownVerbs.getTemplateName(id, t),
+                                includePronouns), false);
+    }
+    return numTables;
+}
+
+
+size_t
+ConjugationCache::prewarm(size_t maxVerbs, bool includePronouns)
+{
+    vector<string> infinitives;
+    fvd.getMostFrequentVerbs(maxVerbs, infinitives);
+    return prewarm(infinitives, maxVerbs, includePronouns);
+}
+
+
+void
+ConjugationCache::clear()
+{
+    MutexLock lock(mutex);
+    for (LRUList::iterator it = lruList.begin(); it != lruList.end(); ++it)
+        it->second->release();
+    lruList.clear();
+    index.clear();
+    stats.numTables = 0;
+}
+
+
+ConjugationCache::Statistics
+ConjugationCache::getStatistics() const
+{
+    MutexLock lock(mutex);
+    return stats;
+}
@@ -0,0 +1,222 @@
+/*  $Id$
+    ConjugationCache.h - Bounded cache of complete conjugation tables
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_ConjugationCache
+#define _H_ConjugationCache
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <pthread.h>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Bounded cache of the complete conjugations generated by
+    FrenchVerbDictionary::generateConjugation().
+
+    A conjugation table is identified by an infinitive, a template name
+    and the pronoun flag.  When the cache is full, the least recently
+    used table is evicted.  The tables are immutable and are shared
+    between the cache and the Handle objects returned to the callers:
+    a table that is evicted remains valid as long as a handle designates it.
+
+    The methods of this class can be called concurrently from several
+    threads.  The dictionary must not be modified while the cache is used.
+*/
+class ConjugationCache
+{
+private:
+
+    class Table;
+
+public:
+
+    /** Shared reference to a conjugation table of the cache.
+        Copying a handle does not copy the table.
+    */
+    class Handle
+    {
+    public:
+
+        /** Constructs a null handle, which designates no table. */
+        Handle() : table(NULL) {}
+
+        Handle(const Handle &h);
+
+        Handle &operator = (const Handle &h);
+
+        ~Handle();
+
+        /** Indicates if this handle designates no table. */
+        bool isNull() const { return table == NULL; }
+
+        /** Returns the conjugation table.  The handle must not be null. */
+        const ConjugationBuffer &operator * () const;
+
+        /** Returns the conjugation table.  The handle must not be null. */
+        const ConjugationBuffer *operator -> () const { return &**this; }
+
+    private:
+
+        friend class ConjugationCache;
+
+        explicit Handle(Table *t);  // takes a new reference on 't'
+
+        Table *table;
+    };
+
+    /** Counters that describe the use of the cache since its creation. */
+    class Statistics
+    {
+    public:
+        size_t hits;        // requests served from the cache
+        size_t misses;      // requests that required a generation
+        size_t evictions;   // tables removed to make room for others
+        size_t numTables;   // tables currently in the cache
+        size_t capacity;    // maximum number of tables
+
+        Statistics()
+          : hits(0), misses(0), evictions(0), numTables(0), capacity(0)
+        {
+        }
+
+        /** Returns the proportion of requests that were hits (0 to 1).
+        */
+        double getHitRate() const
+        {
+            return hits + misses == 0 ? 0.0 : double(hits) / double(hits + misses);
+        }
+    };
+
+    /** Creates an empty cache.
+        @param  _fvd        dictionary used to generate the conjugations;
+                            must outlive this cache
+        @param  _capacity   maximum number of tables kept in the cache;
+                            0 disables caching
+        @throws logic_error the mutex could not be created
+    */
+    ConjugationCache(const FrenchVerbDictionary &_fvd, size_t _capacity)
+                                                throw(std::logic_error);
+
+    /** Destroys the cache.  Tables still designated by handles
+        are destroyed when their last handle is.
+    */
+    ~ConjugationCache();
+
+    /** Returns the conjugation of a verb, generating it if it is not
+        in the cache.
+        @param  infinitive      infinitive of the verb (UTF-8)
+        @param  templateName    conjugation template (e.g., "aim:er")
+        @param  includePronouns see FrenchVerbDictionary::generateConjugation()
+        @returns                a non-null handle on a table that is empty
+                                if the template is unknown
+    */
+    Handle getConjugation(const std::string &infinitive,
+                          const std::string &templateName,
+                          bool includePronouns);
+
+    /** Loads the conjugations of the given verbs into the cache,
+        for each of their templates.
+        The verbs are loaded from the last to the first, so that
+        the first ones are the last to be evicted.
+        The hit and miss counters are not affected.
+        @param  infinitives     infinitives sorted by decreasing frequency
+        @param  maxVerbs        maximum number of elements of 'infinitives'
+                                to load
+        @param  includePronouns see FrenchVerbDictionary::generateConjugation()
+        @returns                the number of tables loaded
+    */
+    size_t prewarm(const std::vector<std::string> &infinitives,
+                   size_t maxVerbs,
+                   bool includePronouns);
+
+    /** Loads the conjugations of the most frequent verbs of the
+        dictionary into the cache, as given by
+        FrenchVerbDictionary::getMostFrequentVerbs().
+        Nothing is loaded if the dictionary has no verb frequencies.
+        @param  maxVerbs        maximum number of verbs to load
+        @param  includePronouns see FrenchVerbDictionary::generateConjugation()
+        @returns                the number of tables loaded
+    */
+    size_t prewarm(size_t maxVerbs, bool includePronouns);
+
+    /** Removes all the tables from the cache.  The statistics are kept.
+    */
+    void clear();
+
+    /** Returns a copy of the current statistics.
+    */
+    Statistics getStatistics() const;
+
+private:
+
+    class Key
+    {
+    public:
+        std::string infinitive;
+        std::string templateName;
+        bool includePronouns;
+
+        Key(const std::string &inf, const std::string &tname, bool p)
+          : infinitive(inf), templateName(tname), includePronouns(p)
+        {
+        }
+
+        bool operator < (const Key &k) const
+        {
+            if (infinitive != k.infinitive)
+                return infinitive < k.infinitive;
+            if (templateName != k.templateName)
+                return templateName < k.templateName;
+            return includePronouns < k.includePronouns;
+        }
+    };
+
+    // Most recently used table first.  The cache holds one reference
+    // on each table of this list.
+    typedef std::list< std::pair<Key, Table *> > LRUList;
+    typedef std::map<Key, LRUList::iterator> Index;
+
+    Handle getTable(const Key &key, bool updateStats);
+    void evictLeastRecentlyUsed();
+
+    const FrenchVerbDictionary &fvd;
+    LRUList lruList;
+    Index index;
+    Statistics stats;
+    mutable pthread_mutex_t mutex;
+
+    // Forbidden operations:
+    ConjugationCache(const ConjugationCache &);
+    ConjugationCache &operator = (const ConjugationCache &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_ConjugationCache */
@@ -0,0 +1,480 @@
+/*  $Id$
+    Dawg.cpp - Minimal acyclic automaton built from a Trie
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "Dawg.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <utility>
+
+
+namespace verbiste {
+
+
+template <class T, class CharT>
+Dawg<T, CharT>::Dawg()
+  : states(),
+    transitions(),
+    values(),
+    initialState(0),
+    numTrieStates(0)
+{
+}
+
+
+template <class T, class CharT>
+void
+Dawg<T, CharT>::clear()
+{
+    // Use swap() to really free the memory.
+    std::vector<State>().swap(states);
+    std::vector<Transition>().swap(transitions);
+    std::vector<T>().swap(values);
+    initialState = 0;
+    numTrieStates = 0;
+}
+
+
+template <class T, class CharT>
+void
+Dawg<T, CharT>::build(const Trie<T, CharT> &trie, bool hotFirst)
+{
+    clear();
+
+    // The states are registered bottom-up: a state is only created
+    // after all the states that it leads to.  Before creating a state,
+    // we look in the register for an existing state that has the same
+    // user data and the same transitions.  Since the states below have
+    // already been merged, this suffices to obtain a minimal automaton.
+    //
+    Builder builder;
+    initialState = addState(trie.firstRow, trie.emptyKeyUserData, builder);
+    assert(initialState < states.size());
+
+    if (hotFirst)
+        layOut();
+}
+
+
+template <class T, class CharT>
+template <class StateT, class TransitionT>
+void
+Dawg<T, CharT>::assign(const StateT *stateArray, size_t numStates,
+                       const TransitionT *transitionArray, size_t numTransitions,
+                       unsigned initial, size_t numTrieSt, std::vector<T> &valueVec)
+{
+    clear();
+
+    states.resize(numStates);
+    for (size_t i = 0; i < numStates; ++i)
+    {
+        State &state = states[i];
+        state.firstTransition = stateArray[i].firstTransition;
+        state.numTransitions = stateArray[i].numTransitions;
+        state.valueIndex = stateArray[i].valueIndex;
+        assert(state.firstTransition + state.numTransitions <= numTransitions);
+        assert(state.valueIndex == unsigned(NO_VALUE) || state.valueIndex < valueVec.size());
+    }
+
+    transitions.resize(numTransitions);
+    for (size_t i = 0; i < numTransitions; ++i)
+    {
+        Transition &t = transitions[i];
+        t.label = CharT(transitionArray[i].label);
+        t.target = transitionArray[i].target;
+        assert(t.target < numStates);
+    }
+
+    values.swap(valueVec);  // 'values' was emptied by clear()
+    initialState = initial;
+    numTrieStates = numTrieSt;
+    assert(numStates == 0 || initialState < numStates);
+}
+
+
+template <class T, class CharT>
+unsigned
+Dawg<T, CharT>::addValue(const T &value, Builder &builder)
+{
+    typename std::map<T, unsigned>::const_iterator it = builder.valueRegister.find(value);
+    if (it != builder.valueRegister.end())
+        return it->second;
+
+    unsigned index = unsigned(values.size());
+    values.push_back(value);
+    builder.valueRegister.insert(std::make_pair(value, index));
+    return index;
+}
+
+
+template <class T, class CharT>
+unsigned
+Dawg<T, CharT>::addState(const TrieRow *row, const T *userData, Builder &builder)
+{
+    ++numTrieStates;
+
+    // Create (or find) the states below this one, sorted by label.
+    //
+    std::vector< std::pair<CharT, unsigned> > arcs;
+    if (row != NULL)
+    {
+        const typename Trie<T, CharT>::DescVec &elements = row->getElements();
+        arcs.reserve(elements.size());
+        for (typename Trie<T, CharT>::DescVec::const_iterator it = elements.begin();
+                                                              it != elements.end(); ++it)
+        {
+            const TrieDescriptor *d = *it;
+            unsigned target = addState(d->inferiorRow, d->userData, builder);
+            arcs.push_back(std::make_pair(d->unichar, target));
+        }
+        std::sort(arcs.begin(), arcs.end());
+    }
+
+    StateSignature signature;
+    signature.reserve(1 + 2 * arcs.size());
+    signature.push_back(userData != NULL ? addValue(*userData, builder) : unsigned(NO_VALUE));
+    for (size_t i = 0; i < arcs.size(); ++i)
+    {
+        signature.push_back(unsigned(arcs[i].first));
+        signature.push_back(arcs[i].second);
+    }
+
+    typename std::map<StateSignature, unsigned>::const_iterator it =
+                                        builder.stateRegister.find(signature);
+    if (it != builder.stateRegister.end())
+        return it->second;  // equivalent state already exists
+
+    State state;
+    state.firstTransition = unsigned(transitions.size());
+    state.numTransitions = unsigned(arcs.size());
+    state.valueIndex = signature[0];
+    for (size_t i = 0; i < arcs.size(); ++i)
+    {
+        Transition t;
+        t.label = arcs[i].first;
+        t.target = arcs[i].second;
+        transitions.push_back(t);
+    }
+
+    unsigned index = unsigned(states.size());
+    states.push_back(state);
+    builder.stateRegister.insert(std::make_pair(signature, index));
+    return index;
+}
+
+
+// Renumbers the states so that those that most searches go through
+// are gathered.  The hot states, which lead to at least HOT_STATE_MIN_KEYS
+// keys, come first, in breadth-first order from the initial state.
+// Each of the other states that they lead to starts a subgraph that is
+// numbered depth-first, so that the end of a word is read from
+// consecutive cache lines.  The children of a state are visited in
+// decreasing order of the number of keys that they lead to, but its
+// transitions stay sorted by label, for findTransition().
+// The transitions are stored in the order of their states.
+//
+template <class T, class CharT>
+void
+Dawg<T, CharT>::layOut()
+{
+    const size_t numStates = states.size();
+
+    // addState() creates a state after all the states that it leads to,
+    // so the number of keys below each state can be computed in index order.
+    //
+    std::vector<size_t> numKeys(numStates, 0);
+    for (size_t i = 0; i < numStates; ++i)
+    {
+        const State &state = states[i];
+        numKeys[i] = (state.valueIndex != unsigned(NO_VALUE) ? 1 : 0);
+        for (unsigned j = 0; j < state.numTransitions; ++j)
+        {
+            const unsigned target = transitions[state.firstTransition + j].target;
+            assert(target < i);
+            numKeys[i] += numKeys[target];
+        }
+    }
+
+    // 'order' is the queue of the breadth-first traversal, and becomes
+    // the list of the old indexes in the new order.
+    //
+    const unsigned UNNUMBERED = ~0u;
+    std::vector<unsigned> newIndexes(numStates, UNNUMBERED);
+    std::vector<unsigned> order;
+    order.reserve(numStates);
+    order.push_back(initialState);
+    newIndexes[initialState] = 0;
+
+    std::vector<unsigned> coldStates;  // first states of the depth-first subgraphs
+    std::vector< std::pair<unsigned, unsigned> > children;  // (position, old index)
+    ChildOrder childOrder(numKeys);
+    for (size_t head = 0; head < order.size(); ++head)
+    {
+        getChildren(order[head], childOrder, children);
+        for (size_t k = 0; k < children.size(); ++k)
+        {
+            const unsigned target = children[k].second;
+            if (numKeys[target] < HOT_STATE_MIN_KEYS)
+                coldStates.push_back(target);
+            else if (newIndexes[target] == UNNUMBERED)
+            {
+                newIndexes[target] = unsigned(order.size());
+                order.push_back(target);
+            }
+        }
+    }
+
+    std::vector<unsigned> stack;
+    for (std::vector<unsigned>::const_iterator it = coldStates.begin();
+                                               it != coldStates.end(); ++it)
+    {
+        stack.push_back(*it);
+        while (!stack.empty())
+        {
+            const unsigned index = stack.back();
+            stack.pop_back();
+            if (newIndexes[index] != UNNUMBERED)
+                continue;  // shared state, already reached by a hotter path
+            newIndexes[index] = unsigned(order.size());
+            order.push_back(index);
+
+            getChildren(index, childOrder, children);
+            for (size_t k = children.size(); k-- > 0; )  // hottest child on top
+                if (newIndexes[children[k].second] == UNNUMBERED)
+                    stack.push_back(children[k].second);
+        }
+    }
+    assert(order.size() == numStates);  // all the states are reachable
+
+    std::vector<State> newStates;
+    std::vector<Transition> newTransitions;
+    newStates.reserve(numStates);
+    newTransitions.reserve(transitions.size());
+    for (size_t i = 0; i < numStates; ++i)
+    {
+        State state = states[order[i]];
+        const unsigned firstTransition = state.firstTransition;
+        state.firstTransition = unsigned(newTransitions.size());
+        for (unsigned j = 0; j < state.numTransitions; ++j)
+        {
+            Transition t = transitions[firstTransition + j];
+            t.target = newIndexes[t.target];
+            newTransitions.push_back(t);
+        }
+        newStates.push_back(state);
+    }
+
+    states.swap(newStates);
+    transitions.swap(newTransitions);
+    initialState = 0;
+}
+
+
+// Stores in 'children' the (position, target) pairs of the transitions
+// of a state, hottest target first.
+//
+template <class T, class CharT>
+void
+Dawg<T, CharT>::getChildren(unsigned index, const ChildOrder &childOrder,
+                            std::vector< std::pair<unsigned, unsigned> > &children) const
+{
+    const State &state = states[index];
+    children.clear();
+    for (unsigned j = 0; j < state.numTransitions; ++j)
+        children.push_back(std::make_pair(j, transitions[state.firstTransition + j].target));
+    std::sort(children.begin(), children.end(), childOrder);
+}
+
+
+// Returns the state reached from 'state' by following the transition
+// labeled 'c', or NULL if there is no such transition.
+//
+template <class T, class CharT>
+inline
+const typename Dawg<T, CharT>::State *
+Dawg<T, CharT>::findTransition(const State &state, CharT c) const
+{
+    // Binary search among the transitions, which are sorted by label.
+    const Transition *lo = &transitions[0] + state.firstTransition;
+    const Transition *hi = lo + state.numTransitions;
+    while (lo < hi)
+    {
+        const Transition *mid = lo + (hi - lo) / 2;
+        if (mid->label < c)
+            lo = mid + 1;
+        else if (c < mid->label)
+            hi = mid;
+        else
+            return &states[mid->target];
+    }
+    return NULL;
+}
+
+
+template <class T, class CharT>
+template <class Visitor>
+const T *
+Dawg<T, CharT>::forEachPrefix(const String &key, Visitor &visitor,
+                              size_t *numStatesVisited) const
+{
+    if (states.empty())
+        return NULL;
+
+    const State *state = &states[initialState];
+    if (state->valueIndex != unsigned(NO_VALUE))
+        visitor(key, 0, &values[state->valueIndex]);
+
+    const typename String::size_type len = key.length();
+    typename String::size_type index = 0;  // length of the prefix that leads to 'state'
+    while (index < len && state->numTransitions != 0)
+    {
+        const State *next = findTransition(*state, key[index]);
+        if (next == NULL)
+            break;
+        state = next;
+        ++index;
+
+        if (state->valueIndex != unsigned(NO_VALUE))
+            visitor(key, index, &values[state->valueIndex]);
+    }
+
+    if (numStatesVisited != NULL)
+        *numStatesVisited += index + 1;
+    if (index < len)
+        return NULL;
+    return (state->valueIndex != unsigned(NO_VALUE) ? &values[state->valueIndex] : NULL);
+}
+
+
+template <class T, class CharT>
+const T *
+Dawg<T, CharT>::find(const String &key, typename String::size_type length,
+                     size_t *numStatesVisited) const
+{
+    assert(length <= key.length());
+
+    if (states.empty())
+        return NULL;
+
+    const State *state = &states[initialState];
+    typename String::size_type index = 0;
+    while (index < length && state->numTransitions != 0)
+    {
+        const State *next = findTransition(*state, key[index]);
+        if (next == NULL)
+            break;
+        state = next;
+        ++index;
+    }
+
+    if (numStatesVisited != NULL)
+        *numStatesVisited += index + 1;
+    if (index < length)
+        return NULL;
+    return (state->valueIndex != unsigned(NO_VALUE) ? &values[state->valueIndex] : NULL);
+}
+
+
+template <class T, class CharT>
+template <class Visitor>
+void
+Dawg<T, CharT>::forEachKey(Visitor &visitor) const
+{
+    if (states.empty())
+        return;
+
+    String key;
+    forEachKeyFrom(states[initialState], key, visitor);
+}
+
+
+// Visits the keys that go through 'state', which is reached by 'key'.
+//
+template <class T, class CharT>
+template <class Visitor>
+void
+Dawg<T, CharT>::forEachKeyFrom(const State &state, String &key, Visitor &visitor) const
+{
+    if (state.valueIndex != unsigned(NO_VALUE))
+        visitor(key, &values[state.valueIndex]);
+    for (unsigned j = 0; j < state.numTransitions; ++j)
+    {
+        const Transition &t = transitions[state.firstTransition + j];
+        key += t.label;
+        forEachKeyFrom(states[t.target], key, visitor);
+        key.erase(key.length() - 1);
+    }
+}
+
+
+template <class T, class CharT>
+void
+Dawg<T, CharT>::getCacheLines(const String &key, size_t lineSize,
+                              std::vector<size_t> &lines) const
+{
+    assert(lineSize > 0);
+
+    if (states.empty())
+        return;
+
+    // Same walk as forEachPrefix(), noting the blocks read by
+    // findTransition()'s binary search.
+    //
+    const State *state = &states[initialState];
+    lines.push_back(2 * (size_t(state - &states[0]) * sizeof(State) / lineSize));
+    for (typename String::size_type index = 0;
+                        index < key.length() && state->numTransitions != 0; ++index)
+    {
+        const Transition *lo = &transitions[0] + state->firstTransition;
+        const Transition *hi = lo + state->numTransitions;
+        const State *next = NULL;
+        while (lo < hi && next == NULL)
+        {
+            const Transition *mid = lo + (hi - lo) / 2;
+            lines.push_back(2 * (size_t(mid - &transitions[0]) * sizeof(Transition) / lineSize) + 1);
+            if (mid->label < key[index])
+                lo = mid + 1;
+            else if (key[index] < mid->label)
+                hi = mid;
+            else
+                next = &states[mid->target];
+        }
+        if (next == NULL)
+            break;
+        state = next;
+        lines.push_back(2 * (size_t(state - &states[0]) * sizeof(State) / lineSize));
+    }
+}
+
+
+template <class T, class CharT>
+size_t
+Dawg<T, CharT>::computeMemoryConsumption() const
+{
+    return sizeof(*this)
+           + states.size() * sizeof(State)
+           + transitions.size() * sizeof(Transition)
+           + values.size() * sizeof(T);
+}
+
+
+}  // namespace verbiste
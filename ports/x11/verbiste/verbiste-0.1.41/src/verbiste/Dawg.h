@@ -0,0 +1,275 @@
+/*  $Id$
+    Dawg.h - Minimal acyclic automaton built from a Trie
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_Dawg
+#define _H_Dawg
+
+#include <verbiste/Trie.h>
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace verbiste {
+
+
+class SharedDictionary;
+class DictionaryCompiler;
+
+
+/** Directed acyclic word graph: minimal automaton that stores the same
+    keys and user data as a Trie, but in which equal subtrees (i.e.,
+    equal sets of suffixes with equal user data) are stored only once.
+
+    The automaton is built in one step from a complete trie, and cannot
+    be modified afterwards, except by rebuilding it.
+    The states and transitions are stored in two contiguous arrays.
+    Once built, the states are relocated so that those that most
+    searches go through, i.e., those that lead to the most keys, are
+    gathered in the first cache lines in breadth-first order, and the
+    rest of each key is stored in consecutive lines, instead of being
+    scattered in the order of the trie.
+    The user data is copied into a pool where each distinct value is
+    stored once; each state refers to its user data by an offset in
+    that pool.
+
+    @param        T     type of the user data attached to the stored strings;
+                        T must be copyable and must have operator < (used
+                        to detect equal values);
+                        T objects are copied from the trie into the automaton
+    @param        CharT type of the characters of the keys (see Trie)
+*/
+template <class T, class CharT = wchar_t>
+class Dawg
+{
+public:
+
+    /** Type of the keys stored in the automaton. */
+    typedef std::basic_string<CharT> String;
+
+    /** Constructs an empty automaton, which contains no key.
+    */
+    Dawg();
+
+    /** Replaces the contents of this automaton with those of a trie.
+        @param  trie        trie whose keys and user data are to be stored
+        @param  hotFirst    if false, the states are left in the order in
+                            which they were created, i.e., each one after
+                            those that it leads to; serves to measure the
+                            effect of the relocation
+    */
+    void build(const Trie<T, CharT> &trie, bool hotFirst = true);
+
+    /** Replaces the contents of this automaton with states and
+        transitions that were copied from an automaton built earlier,
+        e.g., by a program that generated C++ source from them.
+        The arrays must come from a valid automaton: they are not checked.
+        @param  stateArray      states, each one with the members
+                                firstTransition, numTransitions and
+                                valueIndex, as in this class
+        @param  numStates       number of elements of 'stateArray'
+        @param  transitionArray transitions, each one with the members
+                                label and target
+        @param  numTransitions  number of elements of 'transitionArray'
+        @param  initial         index of the initial state
+        @param  numTrieSt       value to be returned by getNumTrieStates()
+        @param  valueVec        distinct user data values, designated by
+                                the valueIndex members; emptied, since
+                                its contents are swapped into this object
+    */
+    template <class StateT, class TransitionT>
+    void assign(const StateT *stateArray, size_t numStates,
+                const TransitionT *transitionArray, size_t numTransitions,
+                unsigned initial, size_t numTrieSt, std::vector<T> &valueVec);
+
+    /** Empties this automaton.
+    */
+    void clear();
+
+    /** Indicates if build() has been called since the last call to
+        clear(), if any.
+    */
+    bool isBuilt() const { return !states.empty(); }
+
+    /** Searches the automaton with the given key.
+        Has the same semantics as Trie<>::forEachPrefix(): calls
+        visitor(key, index, userData) for each prefix of 'key' that has
+        some user data, where userData is a non-null const T *.
+        @param  key         string to search for
+        @param  visitor     function object to call on each prefix found
+        @param  numStatesVisited    if not NULL, the number of states
+                                    visited, including the initial one,
+                                    is added to *numStatesVisited
+        @returns            the user data associated with 'key',
+                            or NULL if none
+    */
+    template <class Visitor>
+    const T *forEachPrefix(const String &key, Visitor &visitor,
+                           size_t *numStatesVisited = NULL) const;
+
+    /** Searches the automaton for a prefix of the given key.
+        @param  key         string whose prefix is to be searched for
+        @param  length      length of the prefix (at most key.length())
+        @param  numStatesVisited    as in forEachPrefix()
+        @returns            the user data associated with the first
+                            'length' characters of 'key', or NULL if none
+    */
+    const T *find(const String &key, typename String::size_type length,
+                  size_t *numStatesVisited = NULL) const;
+
+    /** Appends to 'lines' the numbers of the memory blocks of 'lineSize'
+        bytes that are read when searching the automaton with 'key', in
+        the order in which they are read.  Serves to measure the locality
+        of the layout, e.g., by simulating a cache.
+        The states and the transitions are numbered separately: the
+        blocks of the states have even numbers, those of the transitions
+        have odd numbers.
+        @param  key         string to search for, as in forEachPrefix()
+        @param  lineSize    size of a cache line in bytes (e.g., 64)
+        @param  lines       vector to which the block numbers are appended
+    */
+    void getCacheLines(const String &key, size_t lineSize,
+                       std::vector<size_t> &lines) const;
+
+    /** Calls visitor(key, userData) for each key of the automaton,
+        where userData is a non-null const T *, like
+        Trie<>::forEachKey().  The keys are visited in label order.
+    */
+    template <class Visitor>
+    void forEachKey(Visitor &visitor) const;
+
+    /** Returns the number of nodes in the trie given to the last call
+        to build(), including the root.
+    */
+    size_t getNumTrieStates() const { return numTrieStates; }
+
+    /** Returns the number of states of this automaton.
+    */
+    size_t getNumStates() const { return states.size(); }
+
+    /** Returns the number of transitions of this automaton.
+    */
+    size_t getNumTransitions() const { return transitions.size(); }
+
+    /** Returns the number of distinct user data values in this automaton.
+    */
+    size_t getNumValues() const { return values.size(); }
+
+    /** Computes and returns the number of memory bytes consumed by
+        this object, excluding any memory allocated by the user data
+        values themselves.
+        @returns                        number of bytes
+    */
+    size_t computeMemoryConsumption() const;
+
+private:
+
+    // Copy the states, the transitions and the values into an image
+    // or into generated source.
+    friend class SharedDictionary;
+    friend class DictionaryCompiler;
+
+    enum { NO_VALUE = ~0u };
+
+    // Minimum number of keys below a state for layOut() to place it
+    // with the states of the top of the automaton.
+    enum { HOT_STATE_MIN_KEYS = 10 };
+
+    struct Transition
+    {
+        CharT label;
+        unsigned target;  // index in 'states'
+    };
+
+    struct State
+    {
+        unsigned firstTransition;  // index in 'transitions'
+        unsigned numTransitions;  // sorted by label
+        unsigned valueIndex;  // index in 'values', or NO_VALUE
+    };
+
+    typedef typename Trie<T, CharT>::Row TrieRow;
+    typedef typename Trie<T, CharT>::Descriptor TrieDescriptor;
+
+    // A state is identified by its value index followed by
+    // the (label, target) pairs of its transitions.
+    typedef std::vector<unsigned> StateSignature;
+
+    /** Data used only during a call to build().
+    */
+    class Builder
+    {
+    public:
+        Builder() : stateRegister(), valueRegister() {}
+
+        std::map<StateSignature, unsigned> stateRegister;
+        std::map<T, unsigned> valueRegister;
+    };
+
+    unsigned addState(const TrieRow *row, const T *userData, Builder &builder);
+    unsigned addValue(const T &value, Builder &builder);
+    // Orders (position, target) pairs by decreasing number of keys
+    // below the target, then by position.
+    struct ChildOrder
+    {
+        const std::vector<size_t> &numKeys;
+
+        ChildOrder(const std::vector<size_t> &n) : numKeys(n) {}
+
+        bool operator () (const std::pair<unsigned, unsigned> &a,
+                          const std::pair<unsigned, unsigned> &b) const
+        {
+            if (numKeys[a.second] != numKeys[b.second])
+                return numKeys[a.second] > numKeys[b.second];
+            return a.first < b.first;
+        }
+    };
+
+    void layOut();
+    void getChildren(unsigned index, const ChildOrder &childOrder,
+                     std::vector< std::pair<unsigned, unsigned> > &children) const;
+    const State *findTransition(const State &state, CharT c) const;
+    template <class Visitor>
+    void forEachKeyFrom(const State &state, String &key, Visitor &visitor) const;
+
+    std::vector<State> states;
+    std::vector<Transition> transitions;
+    std::vector<T> values;
+    unsigned initialState;
+    size_t numTrieStates;
+
+    // Forbidden operations:
+    Dawg(const Dawg &);
+    Dawg &operator = (const Dawg &);
+
+};
+
+
+}  // namespace verbiste
+
+
+#include "Dawg.cpp"
+
+
+#endif  /* _H_Dawg */
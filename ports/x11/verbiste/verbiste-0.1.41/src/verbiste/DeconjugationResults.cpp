@@ -0,0 +1,187 @@
+/*  $Id$
+    DeconjugationResults.cpp - Ranked and lazily materialized deconjugations
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "DeconjugationResults.h"
+
+#include <string.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+DeconjugationResults::DeconjugationResults()
+  : word(),
+    infinitiveBuffer(),
+    entries(),
+    limit(0),
+    uniqueLemmas(false)
+{
+}
+
+
+void
+DeconjugationResults::clear()
+{
+    word.clear();
+    entries.clear();
+}
+
+
+string
+DeconjugationResults::getInfinitive(size_t i) const
+{
+    string infinitive;
+    getInfinitive(i, infinitive);
+    return infinitive;
+}
+
+
+void
+DeconjugationResults::getInfinitive(size_t i, string &infinitive) const
+{
+    const char *radical;
+    size_t len;
+    getRadical(i, radical, len);
+
+    const string &tname = getTemplateName(i);
+    const string::size_type colon = tname.find(':');
+
+    infinitive.reserve(len + tname.length() - colon - 1);
+    infinitive.assign(radical, len);
+    infinitive.append(tname, colon + 1, string::npos);
+}
+
+
+InflectionDesc
+DeconjugationResults::getInflectionDesc(size_t i) const
+{
+    return InflectionDesc(getInfinitive(i), getTemplateName(i),
+                          getModeTensePersonNumber(i));
+}
+
+
+void
+DeconjugationResults::start(const string &utf8ConjugatedVerb)
+{
+    word = utf8ConjugatedVerb;  // reuses the buffer of the previous word
+    entries.clear();
+}
+
+
+void
+DeconjugationResults::add(const FrenchVerbDictionary::TrieValue &trieValue,
+                          string::size_type radicalLength,
+                          const ModeTensePersonNumber &mtpn)
+{
+    // A non-empty correct radical means that the radical of the
+    // conjugated verb was found without its accents.
+    //
+    const bool correct = mtpn.correct && trieValue.correctVerbRadical.empty();
+    entries.push_back(Entry(&trieValue, radicalLength, mtpn, correct));
+}
+
+
+// Ranks the entries, then applies the options.  The entries are few,
+// so this is done in place, without allocating.
+//
+void
+DeconjugationResults::finish(const FrenchVerbDictionary &fvd)
+{
+    // The frequency ranks are only needed to order several entries.
+    // The infinitive is formed in a buffer that is reused from one
+    // word to the next.
+    //
+    if (entries.size() > 1 && fvd.hasVerbFrequencies())
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            getInfinitive(i, infinitiveBuffer);
+            entries[i].frequencyRank = fvd.getFrequencyRank(infinitiveBuffer);
+        }
+
+    // Stable insertion sort: the correct spellings first, then the most
+    // frequent verbs.
+    //
+    for (size_t i = 1; i < entries.size(); ++i)
+    {
+        if (!entries[i].isBetterThan(entries[i - 1]))
+            continue;
+        Entry e = entries[i];
+        size_t j = i;
+        do
+        {
+            entries[j] = entries[j - 1];
+            --j;
+        } while (j > 0 && e.isBetterThan(entries[j - 1]));
+        entries[j] = e;
+    }
+
+    size_t numKept = entries.size();
+    if (uniqueLemmas)
+    {
+        numKept = 0;
+        for (size_t i = 0; i < entries.size() && (limit == 0 || numKept < limit); ++i)
+        {
+            size_t j = 0;
+            while (j < numKept && !haveSameLemma(i, j))
+                ++j;
+            if (j == numKept)
+                entries[numKept++] = entries[i];
+        }
+    }
+    if (limit != 0 && numKept > limit)
+        numKept = limit;
+    entries.erase(entries.begin() + numKept, entries.end());
+}
+
+
+void
+DeconjugationResults::getRadical(size_t i, const char *&radical, size_t &len) const
+{
+    const Entry &e = entries[i];
+    if (e.trieValue->correctVerbRadical.empty())
+    {
+        radical = word.data();
+        len = e.radicalLength;
+    }
+    else
+    {
+        radical = e.trieValue->correctVerbRadical.data();
+        len = e.trieValue->correctVerbRadical.length();
+    }
+}
+
+
+// Two entries have the same lemma if they have the same template and
+// the same radical, and thus the same infinitive.
+//
+bool
+DeconjugationResults::haveSameLemma(size_t i, size_t j) const
+{
+    if (getTemplateName(i) != getTemplateName(j))
+        return false;
+
+    const char *radicalI, *radicalJ;
+    size_t lenI, lenJ;
+    getRadical(i, radicalI, lenI);
+    getRadical(j, radicalJ, lenJ);
+    return lenI == lenJ && memcmp(radicalI, radicalJ, lenI) == 0;
+}
@@ -0,0 +1,181 @@
+/*  $Id$
+    DeconjugationResults.h - Ranked and lazily materialized deconjugations
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_DeconjugationResults
+#define _H_DeconjugationResults
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Analyses of a conjugated verb, filled by
+    FrenchVerbDictionary::deconjugate(const std::string &, DeconjugationResults &).
+
+    Unlike the vector of InflectionDesc objects filled by the other
+    deconjugate() method, the results only designate the radical, the
+    template and the inflection that were found.  The infinitive is
+    only formed when it is requested, and the template name is not
+    copied.  Asking for the first result of a frequent form thus costs
+    no string copy for the others.
+
+    The results are ranked: the correct spellings come first, then
+    those that were only found by tolerating missing accents (see the
+    'includeWithoutAccents' parameter of the FrenchVerbDictionary
+    constructor).  Within each group, the most frequent verbs come first
+    if the dictionary has verb frequencies (see
+    FrenchVerbDictionary::loadVerbFrequencies()), so that "suis" gives
+    "être" before "suivre"; the results of verbs of the same frequency
+    keep the order of FrenchVerbDictionary::deconjugate().
+
+    The options, set with setLimit() and setUniqueLemmas(), are kept
+    by clear() and by each deconjugation, so that an object can be
+    configured once and reused for many words without allocating memory.
+
+    The results designate data of the dictionary that filled them.
+    They must not be used after that dictionary is destroyed or modified
+    by addVerb() or loadVerbOverlay().
+*/
+class DeconjugationResults
+{
+public:
+
+    /** Creates an empty result set, without limit and with all the
+        inflections of each lemma.
+    */
+    DeconjugationResults();
+
+    /** Sets the maximum number of results kept by a deconjugation,
+        after ranking.
+        @param  k       maximum number of results, or 0 for no limit
+    */
+    void setLimit(size_t k) { limit = k; }
+
+    /** Returns the maximum number of results, or 0 if there is none. */
+    size_t getLimit() const { return limit; }
+
+    /** Selects whether a deconjugation keeps only the best ranked
+        inflection of each lemma, i.e., of each pair of infinitive
+        and template.  "fus" then gives "être" once instead of
+        three times.
+    */
+    void setUniqueLemmas(bool u) { uniqueLemmas = u; }
+
+    /** Indicates if only one inflection of each lemma is kept. */
+    bool getUniqueLemmas() const { return uniqueLemmas; }
+
+    /** Removes the results, but keeps the options and the memory. */
+    void clear();
+
+    /** Returns the number of results. */
+    size_t size() const { return entries.size(); }
+
+    /** Indicates if there are no results. */
+    bool empty() const { return entries.empty(); }
+
+    /** Returns the infinitive of result number i (UTF-8), with its
+        correct accents.  It is formed by each call.
+    */
+    std::string getInfinitive(size_t i) const;
+
+    /** Returns the template name of result number i (e.g., "aim:er").
+        The string belongs to the dictionary.
+    */
+    const std::string &getTemplateName(size_t i) const
+    {
+        return *entries[i].trieValue->templateName;
+    }
+
+    /** Returns the mode, tense, person and number of result number i. */
+    const ModeTensePersonNumber &getModeTensePersonNumber(size_t i) const
+    {
+        return entries[i].mtpn;
+    }
+
+    /** Indicates if result number i is a correct spelling, rather than
+        one found by tolerating missing accents.
+    */
+    bool isCorrect(size_t i) const { return entries[i].correct; }
+
+    /** Returns result number i as given by the other deconjugate() method.
+    */
+    InflectionDesc getInflectionDesc(size_t i) const;
+
+private:
+
+    friend class FrenchVerbDictionary;
+
+    class Entry
+    {
+    public:
+        const FrenchVerbDictionary::TrieValue *trieValue;
+        std::string::size_type radicalLength;  // in the conjugated verb
+        ModeTensePersonNumber mtpn;
+        bool correct;
+        unsigned frequencyRank;  // set by finish()
+
+        Entry(const FrenchVerbDictionary::TrieValue *tv,
+              std::string::size_type len,
+              const ModeTensePersonNumber &m,
+              bool c)
+          : trieValue(tv), radicalLength(len), mtpn(m), correct(c),
+            frequencyRank(VerbRecordTable::NO_RANK)
+        {
+        }
+
+        // Indicates if this entry is ranked before 'e'.
+        bool isBetterThan(const Entry &e) const
+        {
+            if (correct != e.correct)
+                return correct;
+            return frequencyRank < e.frequencyRank;
+        }
+    };
+
+    // Called by FrenchVerbDictionary::deconjugate().
+    void start(const std::string &utf8ConjugatedVerb);
+    void add(const FrenchVerbDictionary::TrieValue &trieValue,
+             std::string::size_type radicalLength,
+             const ModeTensePersonNumber &mtpn);
+    void finish(const FrenchVerbDictionary &fvd);
+
+    void getInfinitive(size_t i, std::string &infinitive) const;
+    void getRadical(size_t i, const char *&radical, size_t &len) const;
+    bool haveSameLemma(size_t i, size_t j) const;
+
+    std::string word;  // conjugated verb
+    std::string infinitiveBuffer;  // used by finish()
+    std::vector<Entry> entries;
+    size_t limit;
+    bool uniqueLemmas;
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_DeconjugationResults */
@@ -0,0 +1,252 @@
+/*  $Id$
+    DictionaryHolder.cpp - Dictionary that can be replaced while it is used
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "DictionaryHolder.h"
+#include "RefCounted.h"
+
+#include <assert.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+// Published dictionary with a reference count.
+//
+class DictionaryHolder::Generation : public RefCounted<Generation>
+{
+public:
+    FrenchVerbDictionary *const fvd;
+    const unsigned long number;
+
+    Generation(FrenchVerbDictionary *_fvd, unsigned long _number)
+      : fvd(_fvd), number(_number) {}
+
+private:
+    friend class RefCounted<Generation>;
+
+    ~Generation() { delete fvd; }  // use release()
+};
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// Handle local class
+//
+
+
+DictionaryHolder::Handle::Handle(Generation *g)
+  : generation(g)
+{
+    assert(generation != NULL);
+}
+
+
+DictionaryHolder::Handle::Handle(const Handle &h)
+  : generation(h.generation)
+{
+    addRef(generation);
+}
+
+
+DictionaryHolder::Handle &
+DictionaryHolder::Handle::operator = (const Handle &h)
+{
+    assignRef(generation, h.generation);
+    return *this;
+}
+
+
+DictionaryHolder::Handle::~Handle()
+{
+    release(generation);
+}
+
+
+const FrenchVerbDictionary &
+DictionaryHolder::Handle::operator * () const
+{
+    assert(generation != NULL);
+    return *generation->fvd;
+}
+
+
+unsigned long
+DictionaryHolder::Handle::getGenerationNumber() const
+{
+    assert(generation != NULL);
+    return generation->number;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+//
+// DictionaryHolder
+//
+
+
+DictionaryHolder::DictionaryHolder(const string &_conjugationFilename,
+                                   const string &_verbsFilename,
+                                   bool _includeWithoutAccents,
+                                   FrenchVerbDictionary::Language _lang)
+                                                throw(logic_error)
+  : conjugationFilename(_conjugationFilename),
+    verbsFilename(_verbsFilename),
+    includeWithoutAccents(_includeWithoutAccents),
+    lang(_lang),
+    current(NULL),
+    lastGenerationNumber(1),
+    mutex(),
+    reloadThread(),
+    reloadThreadStarted(false),
+    reloadThreadRunning(false),
+    reloadError()
+{
+    current = new Generation(loadDictionary(), lastGenerationNumber);
+    if (pthread_mutex_init(&mutex, NULL) != 0)
+    {
+        current->release();
+        throw logic_error("could not create dictionary holder mutex");
+    }
+}
+
+
+DictionaryHolder::~DictionaryHolder()
+{
+    string errorMessage;
+    (void) waitForReload(errorMessage);
+    current->release();
+    pthread_mutex_destroy(&mutex);
+}
+
+
+FrenchVerbDictionary *
+DictionaryHolder::loadDictionary() const throw(logic_error)
+{
+    return new FrenchVerbDictionary(conjugationFilename, verbsFilename,
+                                    includeWithoutAccents, lang);
+}
+
+
+DictionaryHolder::Handle
+DictionaryHolder::get() const
+{
+    pthread_mutex_lock(&mutex);
+    Generation *g = current;
+    g->addRef();
+    pthread_mutex_unlock(&mutex);
+    return Handle(g);
+}
+
+
+unsigned long
+DictionaryHolder::getGenerationNumber() const
+{
+    pthread_mutex_lock(&mutex);
+    unsigned long number = current->number;
+    pthread_mutex_unlock(&mutex);
+    return number;
+}
+
+
+void
+DictionaryHolder::publish(FrenchVerbDictionary *fvd)
+{
+    assert(fvd != NULL);
+
+    pthread_mutex_lock(&mutex);
+    Generation *old = current;
+    fvd->getStats().setEnabled(old->fvd->getStats().isEnabled());  // keep counting if asked to
+    current = new Generation(fvd, ++lastGenerationNumber);
+    pthread_mutex_unlock(&mutex);
+
+    // Destroys the old dictionary now if no reader is using it.
+    old->release();
+}
+
+
+void
+DictionaryHolder::reload() throw(logic_error)
+{
+    publish(loadDictionary());
+}
+
+
+bool
+DictionaryHolder::startReload() throw(logic_error)
+{
+    if (isReloading())
+        return false;
+
+    string errorMessage;
+    (void) waitForReload(errorMessage);  // join the previous thread, if any
+
+    reloadThreadRunning = true;
+    reloadError.clear();
+    if (pthread_create(&reloadThread, NULL, reloadThreadMain, this) != 0)
+    {
+        reloadThreadRunning = false;
+        throw logic_error("could not create dictionary reload thread");
+    }
+    reloadThreadStarted = true;
+    return true;
+}
+
+
+bool
+DictionaryHolder::isReloading() const
+{
+    return reloadThreadRunning;
+}
+
+
+bool
+DictionaryHolder::waitForReload(string &errorMessage)
+{
+    errorMessage.clear();
+    if (!reloadThreadStarted)
+        return false;
+
+    pthread_join(reloadThread, NULL);
+    reloadThreadStarted = false;
+    errorMessage = reloadError;
+    return reloadError.empty();
+}
+
+
+//static
+void *
+DictionaryHolder::reloadThreadMain(void *p)
+{
+    DictionaryHolder *holder = static_cast<DictionaryHolder *>(p);
+    try
+    {
+        holder->reload();
+    }
+    catch (const exception &e)
+    {
+        holder->reloadError = e.what();
+        if (holder->reloadError.empty())
+            holder->reloadError = "unknown error";
+    }
+    holder->reloadThreadRunning = false;
+    return NULL;
+}
@@ -0,0 +1,192 @@
+/*  $Id$
+    DictionaryHolder.h - Dictionary that can be replaced while it is used
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_DictionaryHolder
+#define _H_DictionaryHolder
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <pthread.h>
+#include <string>
+
+
+namespace verbiste {
+
+
+/** Holder of the current dictionary of a long-running process.
+
+    The dictionary can be reloaded from its XML files, for example after
+    verbs have been added to them, without interrupting the queries.
+    The new dictionary is constructed while the current one remains in
+    use, then it is published: the queries that start afterwards use
+    the new dictionary, while those in progress keep the one they
+    obtained.  A replaced dictionary is destroyed when the last Handle
+    on it is destroyed.
+
+    A reader obtains the current dictionary with get() and keeps the
+    returned handle for the duration of its query, so that all the
+    results of that query come from the same dictionary.
+
+    get(), getGenerationNumber(), publish() and reload() can be called
+    concurrently from several threads.  startReload() and waitForReload()
+    must be called by one thread at a time.  A reload needs enough memory
+    for two dictionaries.
+*/
+class DictionaryHolder
+{
+private:
+
+    class Generation;
+
+public:
+
+    /** Shared reference to a dictionary published by a holder.
+        Copying a handle does not copy the dictionary.
+    */
+    class Handle
+    {
+    public:
+
+        /** Constructs a null handle, which designates no dictionary. */
+        Handle() : generation(NULL) {}
+
+        Handle(const Handle &h);
+
+        Handle &operator = (const Handle &h);
+
+        ~Handle();
+
+        /** Indicates if this handle designates no dictionary. */
+        bool isNull() const { return generation == NULL; }
+
+        /** Returns the dictionary.  The handle must not be null. */
+        const FrenchVerbDictionary &operator * () const;
+
+        /** Returns the dictionary.  The handle must not be null. */
+        const FrenchVerbDictionary *operator -> () const { return &**this; }
+
+        /** Returns the number of the publication of the dictionary:
+            1 for the dictionary loaded by the holder's constructor,
+            then 2, 3, etc.  The handle must not be null.
+        */
+        unsigned long getGenerationNumber() const;
+
+    private:
+
+        friend class DictionaryHolder;
+
+        explicit Handle(Generation *g);  // takes a new reference on 'g'
+
+        Generation *generation;
+    };
+
+    /** Loads the initial dictionary.
+        The arguments are those of the FrenchVerbDictionary constructor
+        and are kept for the reloads.
+        @throws logic_error the dictionary could not be loaded,
+                            or the mutex could not be created
+    */
+    DictionaryHolder(const std::string &conjugationFilename,
+                     const std::string &verbsFilename,
+                     bool includeWithoutAccents,
+                     FrenchVerbDictionary::Language lang)
+                                                throw(std::logic_error);
+
+    /** Waits for the end of a reload started by startReload(), if any.
+        Dictionaries still designated by handles are destroyed when
+        their last handle is.
+    */
+    ~DictionaryHolder();
+
+    /** Returns a handle on the current dictionary.
+        This only locks the holder for the time needed to take
+        a reference on the dictionary.
+        @returns                a non-null handle
+    */
+    Handle get() const;
+
+    /** Returns the number of the current dictionary's publication.
+    */
+    unsigned long getGenerationNumber() const;
+
+    /** Replaces the current dictionary.
+        @param  fvd             dictionary allocated with new, of which
+                                the holder takes ownership
+    */
+    void publish(FrenchVerbDictionary *fvd);
+
+    /** Loads a new dictionary from the files, then publishes it.
+        The calling thread is blocked during the load, but not the readers.
+        @throws logic_error     the dictionary could not be loaded;
+                                the current one remains published
+    */
+    void reload() throw(std::logic_error);
+
+    /** Starts a reload in a background thread and returns immediately.
+        @returns                false if a reload started by this method
+                                is already in progress
+        @throws logic_error     the thread could not be created
+    */
+    bool startReload() throw(std::logic_error);
+
+    /** Indicates if a reload started by startReload() is in progress.
+    */
+    bool isReloading() const;
+
+    /** Waits for the end of the reload started by startReload().
+        @param  errorMessage    receives the reason of the failure, if any
+        @returns                true if the new dictionary was published,
+                                false if the reload failed or if no reload
+                                was started since the last call
+    */
+    bool waitForReload(std::string &errorMessage);
+
+private:
+
+    static void *reloadThreadMain(void *holder);
+
+    FrenchVerbDictionary *loadDictionary() const throw(std::logic_error);
+
+    const std::string conjugationFilename;
+    const std::string verbsFilename;
+    const bool includeWithoutAccents;
+    const FrenchVerbDictionary::Language lang;
+
+    Generation *current;  // the holder owns one reference on it
+    unsigned long lastGenerationNumber;
+    mutable pthread_mutex_t mutex;  // protects the members above
+
+    pthread_t reloadThread;
+    bool reloadThreadStarted;  // true until the thread is joined
+    volatile bool reloadThreadRunning;
+    std::string reloadError;  // set by the thread before it ends
+
+    // Forbidden operations:
+    DictionaryHolder(const DictionaryHolder &);
+    DictionaryHolder &operator = (const DictionaryHolder &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_DictionaryHolder */
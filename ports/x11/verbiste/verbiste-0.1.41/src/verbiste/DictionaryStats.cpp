@@ -0,0 +1,277 @@
+/*  $Id$
+    DictionaryStats.cpp - Counters and timers of a dictionary
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "DictionaryStats.h"
+
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+using namespace verbiste;
+
+
+const long long DictionaryStats::UNKNOWN_HEAP_BYTES = -1;
+
+
+DictionaryStats::PhaseTimer::PhaseTimer(DictionaryStats &_stats,
+                                        LoadPhase _phase,
+                                        bool measureHeap)
+  : stats(_stats),
+    phase(_phase),
+    startTime(now()),
+    startHeapBytes(measureHeap ? getHeapBytes() : UNKNOWN_HEAP_BYTES)
+{
+}
+
+
+DictionaryStats::PhaseTimer::~PhaseTimer()
+{
+    long long heapBytes = UNKNOWN_HEAP_BYTES;
+    if (startHeapBytes != UNKNOWN_HEAP_BYTES)
+        heapBytes = getHeapBytes() - startHeapBytes;
+    stats.addLoadPhase(phase, now() - startTime, heapBytes);
+}
+
+
+DictionaryStats::DictionaryStats()
+  : enabled(false)
+{
+    memset(loadRuns, 0, sizeof(loadRuns));
+    memset(loadNanoseconds, 0, sizeof(loadNanoseconds));
+    for (size_t i = 0; i < NUM_LOAD_PHASES; ++i)
+        loadHeapBytes[i] = UNKNOWN_HEAP_BYTES;
+    resetQueries();
+}
+
+
+void
+DictionaryStats::resetQueries()
+{
+    memset(counters, 0, sizeof(counters));
+    memset(totalNanoseconds, 0, sizeof(totalNanoseconds));
+    memset(histograms, 0, sizeof(histograms));
+}
+
+
+// The load phases run in the thread that constructs or modifies the
+// dictionary, so they need no atomic operations.
+//
+void
+DictionaryStats::addLoadPhase(LoadPhase phase, unsigned long long nanoseconds,
+                              long long heapBytes)
+{
+    ++loadRuns[phase];
+    loadNanoseconds[phase] += nanoseconds;
+    if (heapBytes != UNKNOWN_HEAP_BYTES)
+        loadHeapBytes[phase] = (loadHeapBytes[phase] == UNKNOWN_HEAP_BYTES
+                                ? heapBytes : loadHeapBytes[phase] + heapBytes);
+}
+
+
+void
+DictionaryStats::addLatency(Operation op, unsigned long long startTime)
+{
+    if (!enabled)
+        return;
+
+    const unsigned long long nanoseconds = now() - startTime;
+    size_t bucket = 0;
+    if (nanoseconds > 1)
+        bucket = 63 - __builtin_clzll(nanoseconds);  // floor(log2(nanoseconds))
+    if (bucket >= NUM_BUCKETS)
+        bucket = NUM_BUCKETS - 1;
+
+    (void) __sync_add_and_fetch(&histograms[op][bucket], 1);
+    (void) __sync_add_and_fetch(&totalNanoseconds[op], nanoseconds);
+}
+
+
+unsigned long
+DictionaryStats::getNumOperations(Operation op) const
+{
+    unsigned long n = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i)
+        n += histograms[op][i];
+    return n;
+}
+
+
+unsigned long long
+DictionaryStats::getPercentile(Operation op, double fraction) const
+{
+    const unsigned long n = getNumOperations(op);
+    if (n == 0)
+        return 0;
+
+    const double target = fraction * n;
+    unsigned long cumulated = 0;
+    for (size_t i = 0; i < NUM_BUCKETS; ++i)
+    {
+        cumulated += histograms[op][i];
+        if (cumulated >= target && cumulated != 0)
+            return 1ULL << (i + 1);
+    }
+    return 1ULL << NUM_BUCKETS;
+}
+
+
+void
+DictionaryStats::print(ostream &out) const
+{
+    out << left << setw(22) << "load phase"
+        << right << setw(8) << "runs"
+        << setw(14) << "time(us)"
+        << setw(14) << "heap(KiB)"
+        << "\n";
+    for (int i = 0; i < NUM_LOAD_PHASES; ++i)
+    {
+        const LoadPhase phase = LoadPhase(i);
+        if (loadRuns[phase] == 0)
+            continue;
+        out << left << setw(22) << getLoadPhaseName(phase)
+            << right << setw(8) << loadRuns[phase]
+            << setw(14) << loadNanoseconds[phase] / 1000;
+        if (loadHeapBytes[phase] == UNKNOWN_HEAP_BYTES)
+            out << setw(14) << "-";
+        else
+            out << setw(14) << loadHeapBytes[phase] / 1024;
+        out << "\n";
+    }
+
+    if (!enabled)
+        return;
+
+    out << left << setw(22) << "query counter"
+        << right << setw(14) << "count"
+        << "\n";
+    for (int i = 0; i < NUM_COUNTERS; ++i)
+        out << left << setw(22) << getCounterName(Counter(i))
+            << right << setw(14) << counters[i]
+            << "\n";
+    out << left << setw(22) << "deconjugate-misses"
+        << right << setw(14) << counters[DECONJUGATE_CALLS] - counters[DECONJUGATE_HITS]
+        << "\n";
+
+    out << left << setw(22) << "operation"
+        << right << setw(10) << "ops"
+        << setw(12) << "mean(ns)"
+        << setw(12) << "p50(ns)"
+        << setw(12) << "p99(ns)"
+        << "\n";
+    for (int i = 0; i < NUM_OPERATIONS; ++i)
+    {
+        const Operation op = Operation(i);
+        const unsigned long n = getNumOperations(op);
+        out << left << setw(22) << getOperationName(op)
+            << right << setw(10) << n
+            << setw(12) << (n == 0 ? 0 : totalNanoseconds[op] / n)
+            << setw(12) << getPercentile(op, 0.50)
+            << setw(12) << getPercentile(op, 0.99)
+            << "\n";
+    }
+}
+
+
+//static
+const char *
+DictionaryStats::getLoadPhaseName(LoadPhase phase)
+{
+    switch (phase)
+    {
+        case PARSE_XML:         return "parse-xml";
+        case BUILD_TEMPLATES:   return "build-templates";
+        case BUILD_VERBS:       return "build-verbs";
+        case ACCENT_VARIANTS:   return "accent-variants";
+        case TRIE_INSERT:       return "trie-insert";
+        case BUILD_INDEXES:     return "build-indexes";
+        case LOAD_FREQUENCIES:  return "load-frequencies";
+        default:                return "";
+    }
+}
+
+
+//static
+const char *
+DictionaryStats::getCounterName(Counter counter)
+{
+    switch (counter)
+    {
+        case DECONJUGATE_CALLS: return "deconjugate-calls";
+        case DECONJUGATE_HITS:  return "deconjugate-hits";
+        case FILTER_REJECTS:    return "filter-rejects";
+        case STATES_VISITED:    return "states-visited";
+        case TEMPLATE_PROBES:   return "template-probes";
+        case TENSES_GENERATED:  return "tenses-generated";
+        default:                return "";
+    }
+}
+
+
+//static
+const char *
+DictionaryStats::getOperationName(Operation op)
+{
+    switch (op)
+    {
+        case DECONJUGATE:           return "deconjugate";
+        case GENERATE_TENSE:        return "generate-tense";
+        case GENERATE_CONJUGATION:  return "generate-conjugation";
+        default:                    return "";
+    }
+}
+
+
+//static
+unsigned long long
+DictionaryStats::now()
+{
+    #ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    #endif
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (unsigned long long) tv.tv_sec * 1000000000ULL + tv.tv_usec * 1000ULL;
+}
+
+
+//static
+long long
+DictionaryStats::getHeapBytes()
+{
+    #ifdef HAVE_MALLINFO2
+    struct mallinfo2 info = mallinfo2();
+    return (long long) (info.uordblks + info.hblkhd);
+    #else
+    return UNKNOWN_HEAP_BYTES;
+    #endif
+}
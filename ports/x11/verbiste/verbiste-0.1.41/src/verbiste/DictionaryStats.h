@@ -0,0 +1,234 @@
+/*  $Id$
+    DictionaryStats.h - Counters and timers of a dictionary
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_DictionaryStats
+#define _H_DictionaryStats
+
+#include <stddef.h>
+#include <iosfwd>
+
+
+namespace verbiste {
+
+
+/** Statistics on the loading and the use of a FrenchVerbDictionary.
+
+    The load phases are always measured: each one has a number of runs,
+    a wall time and, where the C library provides it, the growth of the
+    heap in bytes.  Some phases are part of others: ACCENT_VARIANTS is
+    part of BUILD_TEMPLATES and BUILD_VERBS, and TRIE_INSERT is part
+    of BUILD_VERBS.
+
+    The queries are only counted and timed once setEnabled(true) has
+    been called, since reading the clock costs about as much as a
+    small query.  The latencies are kept in histograms whose bucket i
+    holds the operations that took from 2^i to 2^(i+1) - 1 nanoseconds.
+
+    The query statistics can be updated by several threads at once:
+    each query adds its counts with a few atomic operations.
+*/
+class DictionaryStats
+{
+public:
+
+    /** Phases of the loading of a dictionary. */
+    enum LoadPhase
+    {
+        PARSE_XML,          // parsing of the XML documents by libxml2
+        BUILD_TEMPLATES,    // conversion of the conjugation templates
+        BUILD_VERBS,        // insertion of the verbs
+        ACCENT_VARIANTS,    // forming the spellings without accents
+        TRIE_INSERT,        // insertion of the radicals in the trie
+        BUILD_INDEXES,      // automata and verb form filter
+        LOAD_FREQUENCIES,   // verb frequency ranks
+        NUM_LOAD_PHASES
+    };
+
+    /** Events counted by the queries. */
+    enum Counter
+    {
+        DECONJUGATE_CALLS,
+        DECONJUGATE_HITS,       // calls that produced at least one result
+        FILTER_REJECTS,         // calls rejected by the verb form filter
+        STATES_VISITED,         // states of the automata visited
+        TEMPLATE_PROBES,        // templates checked against a termination
+        TENSES_GENERATED,
+        NUM_COUNTERS
+    };
+
+    /** Timed operations. */
+    enum Operation
+    {
+        DECONJUGATE,            // FrenchVerbDictionary::deconjugate()
+        GENERATE_TENSE,         // FrenchVerbDictionary::generateTenseInto()
+        GENERATE_CONJUGATION,   // FrenchVerbDictionary::generateConjugation()
+        NUM_OPERATIONS
+    };
+
+    enum { NUM_BUCKETS = 40 };
+
+    /** Value returned by getLoadHeapBytes() when the growth of the heap
+        cannot be measured.
+    */
+    static const long long UNKNOWN_HEAP_BYTES;
+
+    /** Measures a load phase from construction to destruction. */
+    class PhaseTimer
+    {
+    public:
+
+        /** Starts measuring.
+            @param  measureHeap     if false, only the time is measured;
+                                    measuring the heap costs a few
+                                    microseconds, which is too much for a
+                                    phase that runs once per verb
+        */
+        PhaseTimer(DictionaryStats &stats, LoadPhase phase, bool measureHeap = true);
+
+        /** Adds the measures to the statistics. */
+        ~PhaseTimer();
+
+    private:
+
+        DictionaryStats &stats;
+        LoadPhase phase;
+        unsigned long long startTime;
+        long long startHeapBytes;
+
+        // Forbidden operations:
+        PhaseTimer(const PhaseTimer &);
+        PhaseTimer &operator = (const PhaseTimer &);
+    };
+
+    /** Creates statistics with nothing recorded and the queries not counted.
+    */
+    DictionaryStats();
+
+    /** Indicates if the queries are counted and timed.
+    */
+    bool isEnabled() const { return enabled; }
+
+    /** Starts or stops counting and timing the queries.
+    */
+    void setEnabled(bool e) { enabled = e; }
+
+    /** Forgets the counts and the latencies of the queries.
+        The load phases are kept.  Queries that run during the reset
+        may be partly counted.
+    */
+    void resetQueries();
+
+    /** Returns the number of times that a load phase ran.
+    */
+    unsigned long getLoadRuns(LoadPhase phase) const { return loadRuns[phase]; }
+
+    /** Returns the total wall time of a load phase in nanoseconds.
+    */
+    unsigned long long getLoadNanoseconds(LoadPhase phase) const { return loadNanoseconds[phase]; }
+
+    /** Returns the growth of the heap during a load phase in bytes, or
+        UNKNOWN_HEAP_BYTES if it was not measured.
+    */
+    long long getLoadHeapBytes(LoadPhase phase) const { return loadHeapBytes[phase]; }
+
+    /** Returns the value of a query counter.
+    */
+    unsigned long getCount(Counter counter) const { return counters[counter]; }
+
+    /** Returns the number of timed operations of a kind.
+    */
+    unsigned long getNumOperations(Operation op) const;
+
+    /** Returns the total latency of the operations of a kind in nanoseconds.
+    */
+    unsigned long long getTotalNanoseconds(Operation op) const { return totalNanoseconds[op]; }
+
+    /** Returns the number of operations of a kind in a bucket of the
+        latency histogram.
+        @param  bucket      0..NUM_BUCKETS - 1
+    */
+    unsigned long getBucketCount(Operation op, size_t bucket) const
+    {
+        return histograms[op][bucket];
+    }
+
+    /** Returns the latency below which a fraction of the operations of
+        a kind completed, in nanoseconds, rounded up to a power of 2.
+        @param  fraction    0 to 1, e.g., 0.99 for the 99th percentile
+        @returns            0 if no operation was timed
+    */
+    unsigned long long getPercentile(Operation op, double fraction) const;
+
+    /** Writes the statistics as a table of text lines.
+    */
+    void print(std::ostream &out) const;
+
+    static const char *getLoadPhaseName(LoadPhase phase);
+    static const char *getCounterName(Counter counter);
+    static const char *getOperationName(Operation op);
+
+    /** Returns a monotonic time in nanoseconds.
+    */
+    static unsigned long long now();
+
+    /** Returns the number of bytes allocated on the heap, or
+        UNKNOWN_HEAP_BYTES if the C library does not provide it.
+    */
+    static long long getHeapBytes();
+
+    /** Adds to a query counter.  Does nothing if the queries are not
+        counted.
+    */
+    void add(Counter counter, unsigned long n)
+    {
+        if (enabled && n != 0)
+            (void) __sync_add_and_fetch(&counters[counter], n);
+    }
+
+    /** Records the latency of an operation that started at 'startTime',
+        a value of now().  Does nothing if the queries are not timed.
+    */
+    void addLatency(Operation op, unsigned long long startTime);
+
+private:
+
+    void addLoadPhase(LoadPhase phase, unsigned long long nanoseconds,
+                      long long heapBytes);
+
+    volatile bool enabled;
+    unsigned long loadRuns[NUM_LOAD_PHASES];
+    unsigned long long loadNanoseconds[NUM_LOAD_PHASES];
+    long long loadHeapBytes[NUM_LOAD_PHASES];
+    unsigned long counters[NUM_COUNTERS];
+    unsigned long long totalNanoseconds[NUM_OPERATIONS];
+    unsigned long histograms[NUM_OPERATIONS][NUM_BUCKETS];
+
+    // Forbidden operations:
+    DictionaryStats(const DictionaryStats &);
+    DictionaryStats &operator = (const DictionaryStats &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_DictionaryStats */
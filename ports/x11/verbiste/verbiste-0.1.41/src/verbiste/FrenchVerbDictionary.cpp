@@ -21,8 +21,14 @@
 */
 
 #include "FrenchVerbDictionary.h"
+#include "DeconjugationResults.h"
+#include "LanguagePolicies.h"
+#include "CompiledDictionary.h"
+#include "SuffixSearch.h"
 
 #include <assert.h>
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <errno.h>
 #include <string.h>
@@ -30,6 +36,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <pthread.h>
 
 using namespace std;
 using namespace verbiste;
@@ -127,19 +134,49 @@ operator + (const string &a, const AutoString &b)
 }
 
 
+// Returns the address of the element of 'pool' that is equal to 'value',
+// inserting a copy of 'value' in 'pool' if there is no such element.
+// The returned address remains valid as long as the element is in the pool.
+//
+template <class T>
 inline
-Mode
-convertModeName(const xmlChar *modeName)
+const T *
+intern(set<T> &pool, const T &value)
 {
-    return FrenchVerbDictionary::convertModeName((char *) modeName);
+    return &*pool.insert(value).first;
 }
 
 
-inline
-Tense
-convertTenseName(const xmlChar *tenseName)
+// Approximate number of bytes taken by a node of a std::map or std::set,
+// excluding the value.
+//
+static const size_t treeNodeOverhead = 4 * sizeof(void *);
+
+
+static size_t
+computeMemoryConsumption(const PersonSpec &personSpec)
+{
+    size_t sum = sizeof(personSpec);
+    for (PersonSpec::const_iterator it = personSpec.begin(); it != personSpec.end(); ++it)
+        sum += sizeof(InflectionSpec) + it->inflection.size();
+    return sum;
+}
+
+
+static size_t
+computeMemoryConsumption(const SharedTenseSpec &tenseSpec)
+{
+    return sizeof(tenseSpec) + tenseSpec.size() * sizeof(SharedTenseSpec::value_type);
+}
+
+
+static size_t
+computeMemoryConsumption(const TemplateInflectionTable &ti)
 {
-    return FrenchVerbDictionary::convertTenseName((char *) tenseName);
+    size_t sum = sizeof(ti);
+    for (TemplateInflectionTable::const_iterator it = ti.begin(); it != ti.end(); ++it)
+        sum += treeNodeOverhead + sizeof(*it) + it->first.size();
+    return sum;
 }
 
 
@@ -254,13 +291,26 @@ FrenchVerbDictionary::FrenchVerbDictionary(
                                 Language _lang)
                                         throw (logic_error)
   : conjugSys(),
+    conjugSysCopy(),
     knownVerbs(),
-    aspirateHVerbs(),
+    knownVerbTable(NULL),
     inflectionTable(),
+    slotTable(),
+    personSpecPool(),
+    tenseSpecPool(),
+    inflectionTablePool(),
     wideToUTF8Conv((iconv_t) -1),
     utf8ToWideConv((iconv_t) -1),
-    verbTrie(*this),
-    lang(_lang)
+    verbTrie(true),
+    verbDawg(),
+    terminationDawg(),
+    verbFormFilter(),
+    verbsNotInTrie(NULL),
+    numFilteredLookups(0),
+    stats(),
+    strategy(SUFFIX_FIRST),
+    lang(_lang),
+    withoutAccents(includeWithoutAccents)
 {
     if (lang == NO_LANGUAGE)
         throw logic_error("Invalid language code");
@@ -271,13 +321,26 @@ FrenchVerbDictionary::FrenchVerbDictionary(
 FrenchVerbDictionary::FrenchVerbDictionary(bool includeWithoutAccents)
                                                 throw (std::logic_error)
   : conjugSys(),
+    conjugSysCopy(),
     knownVerbs(),
-    aspirateHVerbs(),
+    knownVerbTable(NULL),
     inflectionTable(),
+    slotTable(),
+    personSpecPool(),
+    tenseSpecPool(),
+    inflectionTablePool(),
     wideToUTF8Conv((iconv_t) -1),
     utf8ToWideConv((iconv_t) -1),
-    verbTrie(*this),
-    lang(FRENCH)
+    verbTrie(true),
+    verbDawg(),
+    terminationDawg(),
+    verbFormFilter(),
+    verbsNotInTrie(NULL),
+    numFilteredLookups(0),
+    stats(),
+    strategy(SUFFIX_FIRST),
+    lang(FRENCH),
+    withoutAccents(includeWithoutAccents)
 {
     string conjFN, verbsFN;
     getXMLFilenames(conjFN, verbsFN, lang);
@@ -286,11 +349,90 @@ FrenchVerbDictionary::FrenchVerbDictionary(bool includeWithoutAccents)
 }
 
 
+FrenchVerbDictionary::FrenchVerbDictionary(Language _lang,
+                                           bool includeWithoutAccents)
+                                                throw (std::logic_error)
+  : conjugSys(),
+    conjugSysCopy(),
+    knownVerbs(),
+    knownVerbTable(NULL),
+    inflectionTable(),
+    slotTable(),
+    personSpecPool(),
+    tenseSpecPool(),
+    inflectionTablePool(),
+    wideToUTF8Conv((iconv_t) -1),
+    utf8ToWideConv((iconv_t) -1),
+    verbTrie(true),
+    verbDawg(),
+    terminationDawg(),
+    verbFormFilter(),
+    verbsNotInTrie(NULL),
+    numFilteredLookups(0),
+    stats(),
+    strategy(SUFFIX_FIRST),
+    lang(_lang),
+    withoutAccents(includeWithoutAccents)
+{
+    const CompiledDictionary *data = NULL;
+    switch (lang)
+    {
+    case FRENCH:  data = &compiledDictionaryFr; break;
+    case ITALIAN: data = &compiledDictionaryIt; break;
+    case GREEK:   data = &compiledDictionaryEl; break;
+    case NO_LANGUAGE: break;
+    }
+    if (data == NULL)
+        throw logic_error("Invalid language code");
+
+    initConversions();
+    readCompiledData(*data, includeWithoutAccents);
+    loadCompiledIndexes(*data, includeWithoutAccents);
+}
+
+
 void
 FrenchVerbDictionary::init(const string &conjugationFilename,
                             const string &verbsFilename,
                             bool includeWithoutAccents)
                                         throw (logic_error)
+{
+    initConversions();
+
+    loadConjugationDatabase(conjugationFilename.c_str(), includeWithoutAccents);
+    loadVerbDatabase(verbsFilename.c_str(), includeWithoutAccents, false);
+
+    // Load additional verbs from $HOME/.verbiste/verbs-<lang>.xml, if present.
+    //
+    const char *home = getenv("HOME");
+    if (home != NULL)  // do nothing if $HOME not defined
+    {
+        string otherVerbsFilename = string(home) + "/.verbiste/verbs-" + getLanguageCode(lang) + ".xml";
+        struct stat statbuf;
+        if (stat(otherVerbsFilename.c_str(), &statbuf) == 0)  // if file exists
+        {
+            //cout << "otherVerbsFilename=" << otherVerbsFilename << endl;
+            loadVerbDatabase(otherVerbsFilename.c_str(), includeWithoutAccents, false);
+        }
+    }
+
+    buildIndexes();
+
+    // Load the verb frequencies that accompany the verb file, if present.
+    //
+    string::size_type slash = verbsFilename.rfind('/');
+    string frequencyFilename = (slash == string::npos ? string() : verbsFilename.substr(0, slash + 1))
+                               + "verb-frequencies-" + getLanguageCode(lang) + ".txt";
+    struct stat statbuf;
+    if (stat(frequencyFilename.c_str(), &statbuf) == 0)  // if file exists
+        (void) loadVerbFrequencies(frequencyFilename);
+}
+
+
+// Opens the character set converters and initializes the case table.
+//
+void
+FrenchVerbDictionary::initConversions() throw (logic_error)
 {
     wideToUTF8Conv = iconv_open("UTF-8", "WCHAR_T");
     if (wideToUTF8Conv == (iconv_t) -1)
@@ -346,27 +488,208 @@ FrenchVerbDictionary::init(const string &conjugationFilename,
         for (int i = 0xE0; i < 0x100; i++)
             latin1TolowerTable[i] = char(i);
     }
+}
 
-    loadConjugationDatabase(conjugationFilename.c_str(), includeWithoutAccents);
-    loadVerbDatabase(verbsFilename.c_str(), includeWithoutAccents);
 
-    // Load additional verbs from $HOME/.verbiste/verbs-<lang>.xml, if present.
+// Builds the indexes used to look up verbs, once all the templates
+// and verbs have been loaded.
+//
+void
+FrenchVerbDictionary::buildIndexes()
+{
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_INDEXES);
+
+    knownVerbs.build();
+    verbDawg.build(verbTrie);
+    buildTerminationIndex();
+    buildVerbFormFilter();
+
+    traceIndexes();
+}
+
+
+void
+FrenchVerbDictionary::traceIndexes() const
+{
+    if (trace)
+        cout << "FrenchVerbDictionary::init: trie takes "
+             << verbTrie.computeMemoryConsumption() << " bytes, "
+             << verbDawg.getNumTrieStates() << " states; "
+             << "minimal automaton takes "
+             << verbDawg.computeMemoryConsumption() << " bytes, "
+             << verbDawg.getNumStates() << " states, "
+             << verbDawg.getNumTransitions() << " transitions, "
+             << verbDawg.getNumValues() << " distinct values; "
+             << "termination index takes "
+             << terminationDawg.computeMemoryConsumption() << " bytes, "
+             << terminationDawg.getNumStates() << " states; "
+             << slotTable.getNumSlots() << " inflection slots, "
+             << slotTable.getNumSets() << " distinct inflection sets taking "
+             << slotTable.computeMemoryConsumption() << " bytes; "
+             << knownVerbs.size() << " known verbs taking "
+             << knownVerbs.computeMemoryConsumption() << " bytes; "
+             << verbFormFilter.getNumKeys() << " verb forms in a filter taking "
+             << verbFormFilter.computeMemoryConsumption() << " bytes\n";
+
+    if (trace)
+    {
+        size_t tenseSpecs, distinctTenseSpecs, inflectionTables,
+               distinctInflectionTables, unsharedBytes, sharedBytes;
+        getTemplateTableSizes(tenseSpecs, distinctTenseSpecs,
+                              inflectionTables, distinctInflectionTables,
+                              unsharedBytes, sharedBytes);
+        cout << "FrenchVerbDictionary::init: "
+             << distinctTenseSpecs << " distinct tenses out of " << tenseSpecs << ", "
+             << personSpecPool.size() << " distinct persons, "
+             << distinctInflectionTables << " distinct inflection tables out of "
+             << inflectionTables << "; templates take "
+             << sharedBytes << " bytes instead of " << unsharedBytes << "\n";
+    }
+}
+
+
+// Fills 'terminationDawg' from 'inflectionTable'.
+//
+void
+FrenchVerbDictionary::buildTerminationIndex()
+{
+    Trie< vector<TerminationValue>, char > reversedTerminations(true);
+
+    // Since inflectionTable is sorted by template name, the list
+    // associated with each termination is sorted by template name.
     //
-    const char *home = getenv("HOME");
-    if (home != NULL)  // do nothing if $HOME not defined
+    for (SharedInflectionTable::const_iterator it = inflectionTable.begin();
+                                               it != inflectionTable.end(); ++it)
     {
-        string otherVerbsFilename = string(home) + "/.verbiste/verbs-" + getLanguageCode(lang) + ".xml";
-        struct stat statbuf;
-        if (stat(otherVerbsFilename.c_str(), &statbuf) == 0)  // if file exists
+        const TemplateInflectionTable &ti = *it->second;
+        for (TemplateInflectionTable::const_iterator jt = ti.begin(); jt != ti.end(); ++jt)
         {
-            //cout << "otherVerbsFilename=" << otherVerbsFilename << endl;
-            loadVerbDatabase(otherVerbsFilename.c_str(), includeWithoutAccents);
+            const string reversedTerm(jt->first.rbegin(), jt->first.rend());
+            vector<TerminationValue> **templateListPtr =
+                        reversedTerminations.getUserDataPointer(reversedTerm);
+            if (*templateListPtr == NULL)
+                *templateListPtr = new vector<TerminationValue>();
+            (*templateListPtr)->push_back(TerminationValue(&it->first, jt->second));
         }
     }
 
-    if (trace)
-        cout << "FrenchVerbDictionary::init: trie takes "
-             << verbTrie.computeMemoryConsumption() << " bytes\n";
+    terminationDawg.build(reversedTerminations);
+}
+
+
+// Visits the radicals of verbTrie to count or to add to verbFormFilter
+// the forms made of a radical and of a termination of one of its templates.
+//
+class FrenchVerbDictionary::VerbFormEnumerator
+{
+public:
+
+    VerbFormEnumerator(const SharedInflectionTable &_inflectionTable,
+                       BloomFilter *_filter)
+      : inflectionTable(_inflectionTable), filter(_filter), numForms(0)
+    {
+    }
+
+    void operator () (const string &radical, const vector<TrieValue> *templateList)
+    {
+        BloomFilter::Hash radicalHash = BloomFilter::continueHash(
+                        BloomFilter::beginHash(), radical.data(), radical.length());
+        for (vector<TrieValue>::const_iterator i = templateList->begin();
+                                               i != templateList->end(); ++i)
+        {
+            const TemplateInflectionTable &ti =
+                        *inflectionTable.find(*i->templateName)->second;
+            numForms += ti.size();
+            if (filter == NULL)
+                continue;
+            for (TemplateInflectionTable::const_iterator j = ti.begin(); j != ti.end(); ++j)
+                filter->add(BloomFilter::continueHash(radicalHash,
+                                            j->first.data(), j->first.length()));
+        }
+    }
+
+    size_t getNumForms() const { return numForms; }
+
+private:
+
+    const SharedInflectionTable &inflectionTable;
+    BloomFilter *filter;  // forms are only counted if NULL
+    size_t numForms;
+
+    // Forbidden operations:
+    VerbFormEnumerator(const VerbFormEnumerator &);
+    VerbFormEnumerator &operator = (const VerbFormEnumerator &);
+};
+
+
+// Fills 'verbFormFilter' with every form that deconjugate() can find,
+// i.e., each radical of verbTrie followed by each termination that one
+// of its templates accepts.  A form reached through several templates
+// is added more than once, which does not change the filter.
+//
+void
+FrenchVerbDictionary::buildVerbFormFilter()
+{
+    VerbFormEnumerator counter(inflectionTable, NULL);
+    verbTrie.forEachKey(counter);
+
+    verbFormFilter.init(counter.getNumForms());
+    VerbFormEnumerator adder(inflectionTable, &verbFormFilter);
+    verbTrie.forEachKey(adder);
+}
+
+
+void
+FrenchVerbDictionary::getRadicalIndexSizes(size_t &trieStates,
+                                            size_t &trieBytes,
+                                            size_t &automatonStates,
+                                            size_t &automatonBytes) const
+{
+    trieStates = verbDawg.getNumTrieStates();
+    trieBytes = verbTrie.computeMemoryConsumption();
+    automatonStates = verbDawg.getNumStates();
+    automatonBytes = verbDawg.computeMemoryConsumption();
+}
+
+
+void
+FrenchVerbDictionary::getTemplateTableSizes(size_t &tenseSpecs,
+                                            size_t &distinctTenseSpecs,
+                                            size_t &inflectionTables,
+                                            size_t &distinctInflectionTables,
+                                            size_t &unsharedBytes,
+                                            size_t &sharedBytes) const
+{
+    tenseSpecs = 0;
+    unsharedBytes = 0;
+    for (SharedConjugationSystem::const_iterator it = conjugSys.begin(); it != conjugSys.end(); ++it)
+        for (SharedTemplateSpec::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+            for (SharedModeSpec::const_iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt)
+            {
+                const SharedTenseSpec &tenseSpec = *kt->second;
+                ++tenseSpecs;
+                unsharedBytes += computeMemoryConsumption(tenseSpec);
+                for (SharedTenseSpec::const_iterator p = tenseSpec.begin(); p != tenseSpec.end(); ++p)
+                    unsharedBytes += computeMemoryConsumption(**p);
+            }
+
+    inflectionTables = inflectionTable.size();
+    for (SharedInflectionTable::const_iterator it = inflectionTable.begin();
+                                               it != inflectionTable.end(); ++it)
+        unsharedBytes += computeMemoryConsumption(*it->second);
+
+    distinctTenseSpecs = tenseSpecPool.size();
+    distinctInflectionTables = inflectionTablePool.size();
+    sharedBytes = 0;
+    for (set<PersonSpec>::const_iterator it = personSpecPool.begin();
+                                         it != personSpecPool.end(); ++it)
+        sharedBytes += treeNodeOverhead + computeMemoryConsumption(*it);
+    for (set<SharedTenseSpec>::const_iterator it = tenseSpecPool.begin();
+                                              it != tenseSpecPool.end(); ++it)
+        sharedBytes += treeNodeOverhead + computeMemoryConsumption(*it);
+    for (set<TemplateInflectionTable>::const_iterator it = inflectionTablePool.begin();
+                                                      it != inflectionTablePool.end(); ++it)
+        sharedBytes += treeNodeOverhead + computeMemoryConsumption(*it);
 }
 
 
@@ -379,10 +702,11 @@ FrenchVerbDictionary::loadConjugationDatabase(
     if (conjugationFilename == NULL)
         throw invalid_argument("conjugationFilename");
 
-    AutoDoc conjDoc(xmlParseFile(conjugationFilename));
+    AutoDoc conjDoc(parseXMLFile(conjugationFilename));
     if (!conjDoc)
         throw logic_error("could not parse " + string(conjugationFilename));
 
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_TEMPLATES);
     readConjugation(conjDoc.get(), includeWithoutAccents);
 }
 
@@ -390,25 +714,380 @@ FrenchVerbDictionary::loadConjugationDatabase(
 void
 FrenchVerbDictionary::loadVerbDatabase(
                                 const char *verbsFilename,
-                                bool includeWithoutAccents)
+                                bool includeWithoutAccents,
+                                bool replace)
                                         throw (logic_error)
 {
     if (verbsFilename == NULL)
         throw invalid_argument("verbsFilename");
 
-    AutoDoc verbsDoc(xmlParseFile(verbsFilename));
+    AutoDoc verbsDoc(parseXMLFile(verbsFilename));
     if (!verbsDoc)
         throw logic_error("could not parse " + string(verbsFilename));
 
-    readVerbs(verbsDoc.get(), includeWithoutAccents);
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_VERBS);
+    readVerbs(verbsDoc.get(), includeWithoutAccents, replace);
+}
+
+
+xmlDocPtr
+FrenchVerbDictionary::parseXMLFile(const char *filename)
+{
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::PARSE_XML);
+    return xmlParseFile(filename);
 }
 
 
 void
-FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents) throw(logic_error)
+FrenchVerbDictionary::addVerb(const string &utf8Infinitive,
+                                const string &templateName,
+                                bool aspirateH)
+                                                throw(logic_error)
+{
+    // Validate the verb before removing the previous one, so that the
+    // dictionary is unchanged if it is rejected.
+    //
+    // The radical can be empty, as with the template ":avoir".
+    //
+    if (conjugSys.find(templateName) == conjugSys.end())
+        throw logic_error("unknown template name: " + templateName);
+    wstring wideInfinitive, wideTName;
+    try
+    {
+        wideInfinitive = utf8ToWide(utf8Infinitive);
+        wideTName = utf8ToWide(templateName);
+    }
+    catch (int)
+    {
+        throw logic_error("invalid UTF-8 in verb " + utf8Infinitive
+                          + " or template " + templateName);
+    }
+    wstring::size_type lenTermination = getTerminationLength(wideTName);
+    if (wideInfinitive.empty()
+            || wideInfinitive.length() < lenTermination
+            || (lenTermination > 0 && wideInfinitive.compare(wideInfinitive.length() - lenTermination,
+                                      lenTermination,
+                                      wideTName, wideTName.length() - lenTermination,
+                                      lenTermination) != 0))
+        throw logic_error("infinitive " + utf8Infinitive
+                          + " does not match template " + templateName);
+
+    bool wasBuilt = knownVerbs.isBuilt();
+    if (wasBuilt)
+        knownVerbs.reopen();
+
+    forgetKnownVerbTable();
+    fillVerbTrie();
+    removeVerb(utf8Infinitive, withoutAccents);
+    insertVerb(utf8Infinitive, templateName, aspirateH, withoutAccents, true);
+
+    if (wasBuilt)
+        knownVerbs.build();
+    verbDawg.clear();  // deconjugate() uses verbTrie until rebuildVerbIndex()
+    verbFormFilter.clear();
+}
+
+
+void
+FrenchVerbDictionary::loadVerbOverlay(const string &verbsFilename)
+                                                throw(logic_error)
+{
+    fillVerbTrie();
+    forgetKnownVerbTable();
+    bool wasBuilt = knownVerbs.isBuilt();
+    if (wasBuilt)
+        knownVerbs.reopen();
+    verbDawg.clear();
+    verbFormFilter.clear();
+
+    try
+    {
+        loadVerbDatabase(verbsFilename.c_str(), withoutAccents, true);
+    }
+    catch (...)
+    {
+        if (wasBuilt)
+            knownVerbs.build();
+        throw;
+    }
+
+    if (wasBuilt)
+        knownVerbs.build();
+}
+
+
+void
+FrenchVerbDictionary::rebuildVerbIndex()
+{
+    fillVerbTrie();
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_INDEXES);
+    verbDawg.build(verbTrie);
+    buildVerbFormFilter();
+}
+
+
+size_t
+FrenchVerbDictionary::loadVerbFrequencies(const string &filename)
+                                                throw(logic_error)
+{
+    ifstream file(filename.c_str());
+    if (!file)
+        throw logic_error("could not open " + filename);
+
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::LOAD_FREQUENCIES);
+    knownVerbs.clearFrequencyRanks();
+
+    unsigned rank = 0;
+    string line;
+    while (getline(file, line))
+    {
+        string::size_type end = line.find_last_not_of(" \t\r");
+        if (end == string::npos || line[0] == '#')
+            continue;
+        line.erase(end + 1);
+
+        VerbRecordTable::VerbId id = knownVerbs.find(line);
+        if (id == VerbRecordTable::NO_VERB
+                || knownVerbs.getFrequencyRank(id) != VerbRecordTable::NO_RANK)
+            continue;
+        knownVerbs.setFrequencyRank(id, rank++);
+    }
+
+    if (trace)
+        cout << "FrenchVerbDictionary::loadVerbFrequencies: "
+             << rank << " verbs ranked from " << filename << endl;
+    return rank;
+}
+
+
+void
+FrenchVerbDictionary::getMostFrequentVerbs(size_t maxVerbs,
+                                           vector<string> &utf8Infinitives) const
+{
+    vector<VerbRecordTable::VerbId> ids;
+    knownVerbs.getMostFrequentVerbs(maxVerbs, ids);
+    for (vector<VerbRecordTable::VerbId>::const_iterator it = ids.begin();
+                                                         it != ids.end(); ++it)
+        utf8Infinitives.push_back(string(knownVerbs.getInfinitive(*it),
+                                         knownVerbs.getInfinitiveLength(*it)));
+}
+
+
+class FrenchVerbDictionary::ConjugationLoader
+{
+public:
+
+    ConjugationLoader(FrenchVerbDictionary &_fvd, bool _includeWithoutAccents)
+      : fvd(_fvd),
+        includeWithoutAccents(_includeWithoutAccents),
+        isItalian(_fvd.lang == ITALIAN),
+        slotListsByTemplate(),
+        templateSpec(NULL),
+        slotLists(NULL),
+        modeSpec(NULL),
+        modeName(NULL),
+        tenseName(NULL),
+        sharedTenseSpec(NULL),
+        tenseSpec(),
+        personCounter(0),
+        personSpec(),
+        inPerson(false)
+    {
+    }
+
+    // Starts a template, e.g., "pla:cer".
+    void beginTemplate(const string &tname) throw(logic_error);
+
+    // Starts a mode of the current template, e.g., "indicative".
+    // The name must remain valid until the mode ends.
+    void beginMode(const char *name);
+
+    // Starts a tense of the current mode, e.g., "present".
+    // The name must remain valid until the tense ends.
+    void beginTense(const char *name);
+
+    // Starts a person of the current tense.
+    void beginPerson();
+
+    // Adds a variant of the current person.
+    void addInflection(const string &variant);
+
+    // Ends the last template and fills the dictionary's inflection table.
+    void finish();
+
+private:
+
+    void endTense();
+    void endPerson();
+
+    // Slot numbers of the mode-tense-person combinations of each
+    // inflection of each template.  These lists are only converted
+    // into sets of 'slotTable' once all the slots are known.
+    //
+    typedef map<string, vector<unsigned> > SlotLists;
+
+    FrenchVerbDictionary &fvd;
+    bool includeWithoutAccents;
+    bool isItalian;
+    map<string, SlotLists> slotListsByTemplate;
+    SharedTemplateSpec *templateSpec;
+    SlotLists *slotLists;
+    SharedModeSpec *modeSpec;
+    const char *modeName;
+    const char *tenseName;
+    const SharedTenseSpec **sharedTenseSpec;  // NULL if no tense is open
+    SharedTenseSpec tenseSpec;
+    int personCounter;
+    PersonSpec personSpec;
+    bool inPerson;
+
+    // Forbidden operations:
+    ConjugationLoader(const ConjugationLoader &);
+    ConjugationLoader &operator = (const ConjugationLoader &);
+};
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::beginTemplate(const string &tname)
+                                                        throw(logic_error)
+{
+    endTense();
+
+    if (tname.empty())
+        throw logic_error("missing template name attribute");
+
+    // The template name is the root and the termination,
+    // with a colon in between.  For example, "pla:cer".
+
+    if (tname.find(':') == string::npos)
+        throw logic_error("missing colon in template name");
+
+    // The use of the [] operator creates an empty conjugation
+    // template spec, to which we keep a pointer:
+
+    templateSpec = &fvd.conjugSys[tname];
+
+    // Same idea:
+
+    slotLists = &slotListsByTemplate[tname];
+    modeSpec = NULL;
+}
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::beginMode(const char *name)
+{
+    endTense();
+    assert(templateSpec != NULL);
+
+    if (trace) cout << "readConjugation: mode node: '" << name << "'" << endl;
+    modeName = name;
+    modeSpec = &(*templateSpec)[FrenchVerbDictionary::convertModeName(name)];
+}
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::beginTense(const char *name)
+{
+    endTense();
+    assert(modeSpec != NULL);
+
+    tenseName = name;
+
+    // The tense spec is built in 'tenseSpec', then replaced with
+    // a pointer to an identical shared copy.
+    //
+    sharedTenseSpec = &(*modeSpec)[FrenchVerbDictionary::convertTenseName(name)];
+    tenseSpec.clear();
+    if (*sharedTenseSpec != NULL)
+        tenseSpec = **sharedTenseSpec;
+    personCounter = 0;
+}
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::beginPerson()
+{
+    endPerson();
+    assert(sharedTenseSpec != NULL);
+
+    personCounter++;
+    personSpec.clear();
+    inPerson = true;
+}
+
+
+// Most persons of most verbs have only one variant.
+//
+void
+FrenchVerbDictionary::ConjugationLoader::addInflection(const string &variant)
+{
+    assert(inPerson);
+
+    personSpec.push_back(InflectionSpec(variant, true));
+
+    ModeTensePersonNumber mtpn(modeName, tenseName, personCounter, true, isItalian);
+    (*slotLists)[variant].push_back(fvd.slotTable.registerSlot(mtpn));
+
+    if (includeWithoutAccents)
+    {
+        // Also include versions where some or all accents are missing.
+        vector<string> unaccentedVariants;
+        {
+            DictionaryStats::PhaseTimer timer(fvd.stats, DictionaryStats::ACCENT_VARIANTS, false);
+            fvd.formUTF8UnaccentedVariants(variant, 0, unaccentedVariants);
+        }
+        for (vector<string>::const_iterator it = unaccentedVariants.begin();
+                                            it != unaccentedVariants.end(); ++it)
+        {
+            personSpec.push_back(InflectionSpec(*it, false));
+            mtpn.correct = false;  // 'false' marks this spelling as incorrect.
+            (*slotLists)[*it].push_back(fvd.slotTable.registerSlot(mtpn));
+        }
+    }
+}
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::endPerson()
 {
-    const bool isItalian = (lang == ITALIAN);
+    if (!inPerson)
+        return;
+    tenseSpec.push_back(intern(fvd.personSpecPool, personSpec));
+    inPerson = false;
+}
+
 
+void
+FrenchVerbDictionary::ConjugationLoader::endTense()
+{
+    endPerson();
+    if (sharedTenseSpec == NULL)
+        return;
+    *sharedTenseSpec = intern(fvd.tenseSpecPool, tenseSpec);
+    sharedTenseSpec = NULL;
+}
+
+
+void
+FrenchVerbDictionary::ConjugationLoader::finish()
+{
+    endTense();
+
+    for (map<string, SlotLists>::const_iterator it = slotListsByTemplate.begin();
+                                                it != slotListsByTemplate.end(); ++it)
+    {
+        TemplateInflectionTable ti;
+        for (SlotLists::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+            ti[jt->first] = fvd.slotTable.addSet(jt->second);
+        fvd.inflectionTable[it->first] = intern(fvd.inflectionTablePool, ti);
+    }
+}
+
+
+void
+FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents) throw(logic_error)
+{
     xmlNodePtr rootNodePtr = xmlDocGetRootElement(doc);
 
     if (rootNodePtr == NULL)
@@ -423,6 +1102,8 @@ FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents)
         throw logic_error(msg);
     }
 
+    ConjugationLoader loader(*this, includeWithoutAccents);
+
     for (xmlNodePtr templ = rootNodePtr->xmlChildrenNode;
                         templ != NULL;
                         templ = templ->next)
@@ -430,24 +1111,7 @@ FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents)
         if (different(templ->name, "template"))  // ignore junk between tags
             continue;
 
-        string tname = getUTF8XmlProp(templ, "name");
-        if (tname.empty())
-            throw logic_error("missing template name attribute");
-
-        // The template name is the root and the termination,
-        // with a colon in between.  For example, "pla:cer".
-
-        if (tname.find(':') == string::npos)
-            throw logic_error("missing colon in template name");
-
-        // The use of the [] operator creates an empty conjugation
-        // template spec, to which we keep a reference:
-
-        TemplateSpec &theTemplateSpec = conjugSys[tname];
-
-        // Same idea:
-
-        TemplateInflectionTable &ti = inflectionTable[tname];
+        loader.beginTemplate(getUTF8XmlProp(templ, "name"));
 
         // For each mode (e.g., infinitive, indicative, conditional, etc):
         for (xmlNodePtr mode = templ->xmlChildrenNode;
@@ -457,9 +1121,7 @@ FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents)
             if (equal(mode->name, "text") || equal(mode->name, "comment"))  // any text in this node is ignored
                 continue;
 
-            if (trace) cout << "readConjugation: mode node: '" << mode->name << "'" << endl;
-            Mode theMode = ::convertModeName(mode->name);
-            ModeSpec &theModeSpec = theTemplateSpec[theMode];
+            loader.beginMode(reinterpret_cast<const char *>(mode->name));
 
             // For each tense in the mode:
             for (xmlNodePtr tense = mode->xmlChildrenNode;
@@ -469,11 +1131,9 @@ FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents)
                 if (equal(tense->name, "text") || equal(tense->name, "comment"))
                     continue;
 
-                Tense theTense = ::convertTenseName(tense->name);
-                TenseSpec &theTenseSpec = theModeSpec[theTense];
+                loader.beginTense(reinterpret_cast<const char *>(tense->name));
 
                 // For each person in the tense:
-                int personCounter = 0;
                 for (xmlNodePtr person = tense->xmlChildrenNode;
                                 person != NULL;
                                 person = person->next)
@@ -481,48 +1141,172 @@ FrenchVerbDictionary::readConjugation(xmlDocPtr doc, bool includeWithoutAccents)
                     if (different(person->name, "p"))
                         continue;
 
-                    personCounter++;
-
-                    theTenseSpec.push_back(PersonSpec());
-                    PersonSpec &thePersonSpec = theTenseSpec.back();
+                    loader.beginPerson();
 
                     // For each variant for this person:
-                    // (Note that most persons of most verbs have only
-                    // one variant.)
                     for (xmlNodePtr inf = person->xmlChildrenNode;
                                     inf != NULL;
                                     inf = inf->next)
-                    {
-                        string variant = getUTF8XmlNodeText(
-                                                    doc, inf->xmlChildrenNode);
-                        thePersonSpec.push_back(InflectionSpec(variant, true));
-
-                        ModeTensePersonNumber mtpn(
-                                reinterpret_cast<const char *>(mode->name),
-                                reinterpret_cast<const char *>(tense->name),
-                                personCounter,
-                                true,
-                                isItalian);
-                        ti[variant].push_back(mtpn);
-
-                        if (includeWithoutAccents)
-                        {
-                            // Also include versions where some or all accents are missing.
-                            vector<string> unaccentedVariants;
-                            formUTF8UnaccentedVariants(variant, 0, unaccentedVariants);
-                            for (vector<string>::const_iterator it = unaccentedVariants.begin();
-                                                                it != unaccentedVariants.end(); ++it)
-                            {
-                                thePersonSpec.push_back(InflectionSpec(*it, false));
-                                mtpn.correct = false;  // 'false' marks this spelling as incorrect.
-                                ti[*it].push_back(mtpn);
-                            }
-                        }
-                    }
+                        loader.addInflection(getUTF8XmlNodeText(doc, inf->xmlChildrenNode));
                 }
             }
         }
     }
+
+    loader.finish();
+}
+
+
+// Loads the templates, the verbs and their frequency ranks from data
+// generated by the compile-data program.  Has the same effect as
+// reading the XML documents and the frequency file from which the data
+// was compiled, except that the radicals of the verbs are not inserted
+// in verbTrie, since the indexes built from it are loaded by
+// loadCompiledIndexes().
+//
+void
+FrenchVerbDictionary::readCompiledData(const CompiledDictionary &data,
+                                        bool includeWithoutAccents)
+                                                throw(logic_error)
+{
+    if (data.languageCode != getLanguageCode(lang))
+        throw logic_error("compiled data is for language " + string(data.languageCode)
+                          + ", expected " + getLanguageCode(lang));
+
+    const char *arena = data.arena;
+
+    {
+        DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_TEMPLATES);
+        ConjugationLoader loader(*this, includeWithoutAccents);
+        for (size_t i = 0; i < data.numEvents; ++i)
+        {
+            const CompiledDictionary::Event &e = data.events[i];
+            const char *str = arena + e.string;
+            switch (e.type)
+            {
+            case CompiledDictionary::TEMPLATE:   loader.beginTemplate(str); break;
+            case CompiledDictionary::MODE:       loader.beginMode(str); break;
+            case CompiledDictionary::TENSE:      loader.beginTense(str); break;
+            case CompiledDictionary::PERSON:     loader.beginPerson(); break;
+            case CompiledDictionary::INFLECTION: loader.addInflection(str); break;
+            default: throw logic_error("invalid event in compiled data");
+            }
+        }
+        loader.finish();
+    }
+
+    {
+        DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_VERBS);
+        for (size_t i = 0; i < data.numVerbs; ++i)
+        {
+            const CompiledDictionary::Verb &v = data.verbs[i];
+            insertVerb(arena + v.infinitive, arena + v.templateName, v.aspirateH != 0,
+                       includeWithoutAccents, false);
+        }
+        verbsNotInTrie = &data;
+        knownVerbs.build();
+    }
+
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::LOAD_FREQUENCIES);
+    for (size_t rank = 0; rank < data.numRankedVerbs; ++rank)
+        knownVerbs.setFrequencyRank(knownVerbs.find(arena + data.rankedVerbs[rank]),
+                                    unsigned(rank));
+}
+
+
+// Loads the indexes that compile-data built from the same templates
+// and verbs, instead of building them.  The slots, the templates and
+// the verbs must have been loaded by readCompiledData().
+//
+void
+FrenchVerbDictionary::loadCompiledIndexes(const CompiledDictionary &data,
+                                          bool includeWithoutAccents)
+                                                throw(logic_error)
+{
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::BUILD_INDEXES);
+
+    const CompiledDictionary::Indexes &indexes =
+            *(includeWithoutAccents ? data.indexesWithoutAccents : data.indexes);
+    if (indexes.numSlots != slotTable.getNumSlots()
+            || indexes.numSlotSets != slotTable.getNumSets())
+        throw logic_error("compiled indexes do not match the compiled templates");
+
+    // The templates are numbered in the order of the names, which is
+    // that of both maps.
+    //
+    vector<const string *> templateNames, inflectionTableNames;
+    templateNames.reserve(conjugSys.size());
+    for (SharedConjugationSystem::const_iterator it = conjugSys.begin(); it != conjugSys.end(); ++it)
+        templateNames.push_back(&it->first);
+    inflectionTableNames.reserve(inflectionTable.size());
+    for (SharedInflectionTable::const_iterator it = inflectionTable.begin();
+                                               it != inflectionTable.end(); ++it)
+        inflectionTableNames.push_back(&it->first);
+
+    const CompiledDictionary::Automaton &radicals = indexes.radicals;
+    vector< vector<TrieValue> > radicalValues(radicals.numValueLists);
+    for (size_t i = 0; i < radicals.numValueLists; ++i)
+    {
+        const CompiledDictionary::ValueList &vl = radicals.valueLists[i];
+        radicalValues[i].reserve(vl.count);
+        for (unsigned j = vl.first; j < vl.first + vl.count; ++j)
+        {
+            const CompiledDictionary::RadicalValue &v = indexes.radicalValues[j];
+            radicalValues[i].push_back(TrieValue(templateNames.at(v.templateNo),
+                                                 data.arena + v.correctRadical));
+        }
+    }
+    verbDawg.assign(radicals.states, radicals.numStates,
+                    radicals.transitions, radicals.numTransitions,
+                    radicals.initialState, radicals.numTrieStates, radicalValues);
+
+    const CompiledDictionary::Automaton &terminations = indexes.terminations;
+    vector< vector<TerminationValue> > terminationValues(terminations.numValueLists);
+    for (size_t i = 0; i < terminations.numValueLists; ++i)
+    {
+        const CompiledDictionary::ValueList &vl = terminations.valueLists[i];
+        terminationValues[i].reserve(vl.count);
+        for (unsigned j = vl.first; j < vl.first + vl.count; ++j)
+        {
+            const CompiledDictionary::TerminationValue &v = indexes.terminationValues[j];
+            terminationValues[i].push_back(TerminationValue(
+                                inflectionTableNames.at(v.templateNo), v.slotSet));
+        }
+    }
+    terminationDawg.assign(terminations.states, terminations.numStates,
+                           terminations.transitions, terminations.numTransitions,
+                           terminations.initialState, terminations.numTrieStates,
+                           terminationValues);
+
+    verbFormFilter.assign(indexes.filterWords, indexes.numFilterWords,
+                          indexes.numFilterKeys);
+
+    traceIndexes();
+}
+
+
+// Inserts in verbTrie the radicals of the verbs that readCompiledData()
+// left out, before the first change to the verbs.
+//
+void
+FrenchVerbDictionary::fillVerbTrie()
+{
+    if (verbsNotInTrie == NULL)
+        return;
+
+    const CompiledDictionary &data = *verbsNotInTrie;
+    verbsNotInTrie = NULL;
+
+    // The verbs were accepted by insertVerb().
+    //
+    for (size_t i = 0; i < data.numVerbs; ++i)
+    {
+        const CompiledDictionary::Verb &v = data.verbs[i];
+        const string *tname = &conjugSys.find(data.arena + v.templateName)->first;
+        wstring wideInfinitive = utf8ToWide(data.arena + v.infinitive);
+        insertVerbRadicals(wideInfinitive, getTerminationLength(utf8ToWide(*tname)),
+                           tname, withoutAccents);
+    }
 }
 
 
@@ -548,12 +1332,15 @@ FrenchVerbDictionary::getUTF8XmlProp(xmlNodePtr node, const char *propName)
 }
 
 
-// Reads the given XML document and adds data to members knownVerbs,
-// aspirateHVerbs and verbTrie.
+// Reads the given XML document and adds data to members knownVerbs
+// and verbTrie.  If 'replace' is true, the verbs of the document that
+// are already known lose their previous templates.  knownVerbs must not
+// be built in that case.
 //
 void
 FrenchVerbDictionary::readVerbs(xmlDocPtr doc,
-                                bool includeWithoutAccents)
+                                bool includeWithoutAccents,
+                                bool replace)
                                                 throw(logic_error)
 {
     if (trace)
@@ -568,6 +1355,8 @@ FrenchVerbDictionary::readVerbs(xmlDocPtr doc,
     if (different(rootNodePtr->name, ("verbs-" + langCode).c_str()))
         throw logic_error("wrong top node in verbs document");
 
+    set<string> replacedVerbs;  // a verb can have several <v> nodes
+
     for (xmlNodePtr v = rootNodePtr->xmlChildrenNode; v != NULL; v = v->next)
     {
         if (equal(v->name, "text") || equal(v->name, "comment"))
@@ -578,11 +1367,6 @@ FrenchVerbDictionary::readVerbs(xmlDocPtr doc,
             throw logic_error("missing <i> node");
 
         string utf8Infinitive = getUTF8XmlNodeText(doc, i->xmlChildrenNode);
-        wstring wideInfinitive = utf8ToWide(utf8Infinitive);
-        if (wideInfinitive.empty())
-            throw logic_error("empty <i> node");
-        size_t lenInfinitive = wideInfinitive.length();
-        if (trace) cout << "utf8Infinitive='" << utf8Infinitive << "'\n";
 
         if (i->next == NULL)
             throw logic_error("unexpected end after <i> node");
@@ -599,99 +1383,233 @@ FrenchVerbDictionary::readVerbs(xmlDocPtr doc,
 
         // Get template name (e.g., "aim:er") in UTF-8.
         string utf8TName = getUTF8XmlNodeText(doc, t->xmlChildrenNode);
-        if (utf8TName.empty())
-            throw logic_error("empty <t> node");
-        if (trace) cout << "  utf8TName='" << utf8TName << "'\n";
 
-        // Check that this template name (seen in verbs-*.xml) has been
-        // seen in conjugation-*.xml.
-        //
-        if (conjugSys.find(utf8TName) == conjugSys.end())
-            throw logic_error("unknown template name: " + utf8TName);
+        // <aspirate-h>: If this verb starts with an aspirate h, remember it:
+        bool aspirateH = (t->next != NULL && t->next->next != NULL);
 
-        // Find the offset of the colon in the template name.
-        // For example: the offset is 3 in the case of "aim:er".
-        // Find this offset in a wide character string, because
-        // the offset in a UTF-8 string is in bytes, not characters.
-        //
-        wstring wideTName = utf8ToWide(utf8TName);
-        wstring::size_type posColon = wideTName.find(':');
-        if (posColon == wstring::npos)
-            throw logic_error("missing colon in <t> node");
-        assert(wideTName[posColon] == ':');
+        if (replace && replacedVerbs.insert(utf8Infinitive).second)
+            removeVerb(utf8Infinitive, includeWithoutAccents);
+
+        insertVerb(utf8Infinitive, utf8TName, aspirateH, includeWithoutAccents, true);
+    }
 
+}
 
-        knownVerbs[utf8Infinitive].insert(utf8TName);
 
-        if (includeWithoutAccents)
+// Adds a verb to member knownVerbs and, if 'intoTrie' is true, to verbTrie.
+// The template named 'utf8TName' must already be in conjugSys.
+// Nothing is added if an exception is thrown.
+//
+void
+FrenchVerbDictionary::insertVerb(const string &utf8Infinitive,
+                                const string &utf8TName,
+                                bool aspirateH,
+                                bool includeWithoutAccents,
+                                bool intoTrie)
+                                                throw(logic_error)
+{
+    wstring wideInfinitive = utf8ToWide(utf8Infinitive);
+    if (wideInfinitive.empty())
+        throw logic_error("empty <i> node");
+    size_t lenInfinitive = wideInfinitive.length();
+    if (trace) cout << "utf8Infinitive='" << utf8Infinitive << "'\n";
+
+    if (utf8TName.empty())
+        throw logic_error("empty <t> node");
+    if (trace) cout << "  utf8TName='" << utf8TName << "'\n";
+
+    // Check that this template name (seen in verbs-*.xml) has been
+    // seen in conjugation-*.xml.
+    //
+    SharedConjugationSystem::const_iterator templIt = conjugSys.find(utf8TName);
+    if (templIt == conjugSys.end())
+        throw logic_error("unknown template name: " + utf8TName);
+    const string *tname = &templIt->first;
+
+    // Find the offset of the colon in the template name.
+    // For example: the offset is 3 in the case of "aim:er".
+    // Find this offset in a wide character string, because
+    // the offset in a UTF-8 string is in bytes, not characters.
+    //
+    wstring wideTName = utf8ToWide(utf8TName);
+    size_t lenTermination = getTerminationLength(wideTName);
+    if (lenInfinitive < lenTermination)
+        throw logic_error("infinitive " + utf8Infinitive
+                          + " shorter than termination of " + utf8TName);
+
+    knownVerbs.addVerb(utf8Infinitive, utf8TName,
+                       aspirateH ? VerbRecordTable::ASPIRATE_H : 0);
+
+    if (includeWithoutAccents)
+    {
+        // Also include versions where some of all accents are missing.
+        DictionaryStats::PhaseTimer timer(stats, DictionaryStats::ACCENT_VARIANTS, false);
+        vector<string> unaccentedVariants;
+        formUTF8UnaccentedVariants(wideInfinitive, 0, unaccentedVariants);
+        for (vector<string>::const_iterator it = unaccentedVariants.begin();
+                                            it != unaccentedVariants.end(); ++it)
         {
-            // Also include versions where some of all accents are missing.
-            vector<string> unaccentedVariants;
-            formUTF8UnaccentedVariants(wideInfinitive, 0, unaccentedVariants);
-            for (vector<string>::const_iterator it = unaccentedVariants.begin();
-                                                it != unaccentedVariants.end(); ++it)
-            {
-                if (trace) cout << "  unaccvar: '" << *it << "'\n";
-                knownVerbs[*it].insert(utf8TName);
-            }
+            if (trace) cout << "  unaccvar: '" << *it << "'\n";
+            knownVerbs.addVerb(*it, utf8TName, 0);
         }
+    }
+
+    if (intoTrie)
+        insertVerbRadicals(wideInfinitive, lenTermination, tname, includeWithoutAccents);
+}
+
+
+// Inserts in verbTrie the radical of a verb, whose template name is
+// 'tname', and, if 'includeWithoutAccents' is true, its unaccented variants.
+//
+void
+FrenchVerbDictionary::insertVerbRadicals(const wstring &wideInfinitive,
+                                          size_t lenTermination,
+                                          const string *tname,
+                                          bool includeWithoutAccents)
+{
+    // Insert the verb in the trie.
+    // A list of template names is associated to each verb in this trie.
+
+    wstring wideVerbRadical(wideInfinitive, 0, wideInfinitive.length() - lenTermination);
+    string utf8VerbRadical = wideToUTF8(wideVerbRadical);
+
+    vector<string> unaccentedVariants;
+    if (includeWithoutAccents)
+    {
+        // Also include versions where some of all accents are missing.
+        DictionaryStats::PhaseTimer timer(stats, DictionaryStats::ACCENT_VARIANTS, false);
+        formUTF8UnaccentedVariants(wideVerbRadical, 0, unaccentedVariants);
+    }
+
+    DictionaryStats::PhaseTimer timer(stats, DictionaryStats::TRIE_INSERT, false);
+    insertVerbRadicalInTrie(utf8VerbRadical, tname, utf8VerbRadical);
+    for (vector<string>::const_iterator it = unaccentedVariants.begin();
+                                        it != unaccentedVariants.end(); ++it)
+    {
+        insertVerbRadicalInTrie(*it, tname, utf8VerbRadical);  // pass correct verb radical as 3rd argument
+    }
+}
 
-        // <aspirate-h>: If this verb starts with an aspirate h, remember it:
-        if (t->next != NULL && t->next->next != NULL)
-            aspirateHVerbs.insert(utf8Infinitive);
 
-        // Insert the verb in the trie.
-        // A list of template names is associated to each verb in this trie.
+// Removes a verb and all its templates from members knownVerbs and
+// verbTrie.  knownVerbs must not be built.  Nothing is done if the verb
+// is unknown.  'includeWithoutAccents' must have the value that was
+// used to insert the verb.
+//
+// Several verbs can share an unaccented form (e.g., "mater" is a verb
+// and a variant of "mâter"), so an infinitive is only removed from
+// knownVerbs if no remaining verb of the same template produces it.
+// The trie needs no such care: its entries keep the correct radical,
+// so those of the removed verb cannot be confused with another verb's.
+//
+void
+FrenchVerbDictionary::removeVerb(const string &utf8Infinitive,
+                                    bool includeWithoutAccents)
+{
+    vector<string> tnames;
+    knownVerbs.getTemplateNames(utf8Infinitive, tnames);
+    if (tnames.empty())
+        return;
 
-        size_t lenTermination = wideTName.length() - posColon - 1;
-        assert(lenTermination > 0);
-        assert(lenInfinitive >= lenTermination);
+    wstring wideInfinitive = utf8ToWide(utf8Infinitive);
+    vector<string> infinitives(1, utf8Infinitive);
+    if (includeWithoutAccents)
+        formUTF8UnaccentedVariants(wideInfinitive, 0, infinitives);
 
-        wstring wideVerbRadical(wideInfinitive, 0, lenInfinitive - lenTermination);
+    for (vector<string>::const_iterator t = tnames.begin(); t != tnames.end(); ++t)
+    {
+        // The termination length was checked when the verb was inserted.
+        size_t lenTermination = getTerminationLength(utf8ToWide(*t));
+        wstring wideVerbRadical(wideInfinitive, 0,
+                                wideInfinitive.length() - lenTermination);
         string utf8VerbRadical = wideToUTF8(wideVerbRadical);
 
-        insertVerbRadicalInTrie(utf8VerbRadical, utf8TName, utf8VerbRadical);
+        removeVerbRadicalFromTrie(utf8VerbRadical, *t, utf8VerbRadical);
 
         if (includeWithoutAccents)
         {
-            // Also include versions where some of all accents are missing.
             vector<string> unaccentedVariants;
             formUTF8UnaccentedVariants(wideVerbRadical, 0, unaccentedVariants);
             for (vector<string>::const_iterator it = unaccentedVariants.begin();
                                                 it != unaccentedVariants.end(); ++it)
-            {
-                insertVerbRadicalInTrie(*it, utf8TName, utf8VerbRadical);  // pass correct verb radical as 3rd argument
-            }
+                removeVerbRadicalFromTrie(*it, *t, utf8VerbRadical);
+        }
+
+        // An infinitive and its variants differ from their radical by
+        // the same number of characters.  If the trie still has this
+        // template under the radical of an infinitive, another verb
+        // produces this infinitive.
+        //
+        for (vector<string>::const_iterator it = infinitives.begin();
+                                            it != infinitives.end(); ++it)
+        {
+            wstring wideForm = utf8ToWide(*it);
+            wideForm.erase(wideForm.length() - lenTermination);
+            if (!isRadicalOfTemplate(wideToUTF8(wideForm), *t))
+                knownVerbs.removeVerb(*it, *t);
         }
     }
+}
 
-    if (trace)
-        cout << "Number of known verbs (lang " << langCode << "): " << knownVerbs.size() << endl;
+
+// Indicates if the trie associates the given template to the given
+// radical, whatever the correct radical of the entry.
+//
+bool
+FrenchVerbDictionary::isRadicalOfTemplate(const std::string &verbRadical,
+                                          const std::string &tname) const
+{
+    const vector<TrieValue> *templateList = verbTrie.get(verbRadical);
+    if (templateList == NULL)
+        return false;
+    for (vector<TrieValue>::const_iterator it = templateList->begin();
+                                           it != templateList->end(); ++it)
+        if (*it->templateName == tname)
+            return true;
+    return false;
+}
+
+
+// Returns the number of characters after the colon of a template name.
+// For example: 2 in the case of "aim:er".
+// The name is in wide characters, because the offset in a UTF-8
+// string is in bytes, not characters.
+//
+//static
+wstring::size_type
+FrenchVerbDictionary::getTerminationLength(const wstring &wideTName)
+                                                throw(logic_error)
+{
+    wstring::size_type posColon = wideTName.find(':');
+    if (posColon == wstring::npos)
+        throw logic_error("missing colon in <t> node");
+    assert(wideTName[posColon] == ':');
+    return wideTName.length() - posColon - 1;
 }
 
 
 // String parameters expected to be in UTF-8.
-// Adds to 'verbTrie', which contains wide character strings.
+// Adds to 'verbTrie', which contains UTF-8 strings.
 //
 void
 FrenchVerbDictionary::insertVerbRadicalInTrie(
                                     const std::string &verbRadical,
-                                    const std::string &tname,
+                                    const std::string *tname,
                                     const std::string &correctVerbRadical)
 {
-    wstring wideVerbRadical = utf8ToWide(verbRadical);
     if (trace)
         cout << "insertVerbRadicalInTrie('"
-              << verbRadical << "' (len=" << wideVerbRadical.length()
-              << "), '" << tname
+              << verbRadical << "' (len=" << verbRadical.length()
+              << "), '" << *tname
               << "', '" << correctVerbRadical
               << "')\n";
 
     vector<TrieValue> **templateListPtr =
-                            verbTrie.getUserDataPointer(wideVerbRadical);
+                            verbTrie.getUserDataPointer(verbRadical);
     assert(templateListPtr != NULL);
 
-    // If a new entry was created for 'wideVerbRadical', then the associated
+    // If a new entry was created for 'verbRadical', then the associated
     // user data pointer is null.  Make this pointer point to a new,
     // empty vector of template names.
     //
@@ -699,56 +1617,157 @@ FrenchVerbDictionary::insertVerbRadicalInTrie(
         *templateListPtr = new vector<TrieValue>();
 
     // Associate the given template name to the given verb radical.
+    // The correct radical is only stored if it differs from the key.
     //
-    (*templateListPtr)->push_back(TrieValue(tname, correctVerbRadical));
+    (*templateListPtr)->push_back(TrieValue(tname,
+                    correctVerbRadical == verbRadical ? string() : correctVerbRadical));
+}
+
+
+// Undoes insertVerbRadicalInTrie() with the same arguments.
+// The radical stays in the trie, with an empty list if it has no
+// other template.
+//
+void
+FrenchVerbDictionary::removeVerbRadicalFromTrie(
+                                    const std::string &verbRadical,
+                                    const std::string &tname,
+                                    const std::string &correctVerbRadical)
+{
+    vector<TrieValue> *templateList = verbTrie.get(verbRadical);
+    if (templateList == NULL)
+        return;
+
+    string storedRadical =
+            (correctVerbRadical == verbRadical ? string() : correctVerbRadical);
+    for (vector<TrieValue>::iterator it = templateList->begin();
+                                     it != templateList->end(); )
+        if (*it->templateName == tname && it->correctVerbRadical == storedRadical)
+            it = templateList->erase(it);
+        else
+            ++it;
 }
 
 
 FrenchVerbDictionary::~FrenchVerbDictionary()
 {
+    delete knownVerbTable;
     iconv_close(utf8ToWideConv);
     iconv_close(wideToUTF8Conv);
 }
 
 
+// Protects 'conjugSysCopy' and 'knownVerbTable', the copies in the
+// public types that getTemplate() and the deprecated known verb accessors
+// make on first use.  These accessors are const and may thus be called
+// from several threads.
+//
+static pthread_mutex_t copyMutex = PTHREAD_MUTEX_INITIALIZER;
+
+
+// Copies the template at 'it' into 'conjugSysCopy', unless it was
+// already copied.  'copyMutex' must be locked.
+//
+const TemplateSpec &
+FrenchVerbDictionary::copyTemplate(SharedConjugationSystem::const_iterator it) const
+{
+    ConjugationSystem::iterator copy = conjugSysCopy.lower_bound(it->first);
+    if (copy != conjugSysCopy.end() && copy->first == it->first)
+        return copy->second;
+
+    copy = conjugSysCopy.insert(copy, make_pair(it->first, TemplateSpec()));
+    TemplateSpec &templ = copy->second;
+    for (SharedTemplateSpec::const_iterator jt = it->second.begin(); jt != it->second.end(); ++jt)
+    {
+        ModeSpec &modeSpec = templ[jt->first];
+        for (SharedModeSpec::const_iterator kt = jt->second.begin(); kt != jt->second.end(); ++kt)
+        {
+            TenseSpec &tenseSpec = modeSpec[kt->first];
+            tenseSpec.reserve(kt->second->size());
+            for (SharedTenseSpec::const_iterator p = kt->second->begin(); p != kt->second->end(); ++p)
+                tenseSpec.push_back(**p);
+        }
+    }
+    return templ;
+}
+
+
 const TemplateSpec *
 FrenchVerbDictionary::getTemplate(const string &templateName) const
 {
-    ConjugationSystem::const_iterator it = conjugSys.find(templateName);
+    SharedConjugationSystem::const_iterator it = conjugSys.find(templateName);
     if (it == conjugSys.end())
         return NULL;
-    return &it->second;
+
+    pthread_mutex_lock(&copyMutex);
+    const TemplateSpec &templ = copyTemplate(it);
+    pthread_mutex_unlock(&copyMutex);
+    return &templ;
 }
 
 
 ConjugationSystem::const_iterator
 FrenchVerbDictionary::beginConjugSys() const
 {
-    return conjugSys.begin();
+    pthread_mutex_lock(&copyMutex);
+    if (conjugSysCopy.size() != conjugSys.size())
+        for (SharedConjugationSystem::const_iterator it = conjugSys.begin(); it != conjugSys.end(); ++it)
+            copyTemplate(it);
+    pthread_mutex_unlock(&copyMutex);
+    return conjugSysCopy.begin();
 }
 
 
 ConjugationSystem::const_iterator
 FrenchVerbDictionary::endConjugSys() const
 {
-    return conjugSys.end();
+    return conjugSysCopy.end();
+}
+
+
+const VerbTable &
+FrenchVerbDictionary::getKnownVerbTable() const
+{
+    pthread_mutex_lock(&copyMutex);
+    if (knownVerbTable == NULL)
+    {
+        VerbTable *table = new VerbTable();
+        for (VerbRecordTable::VerbId id = 0; id < knownVerbs.size(); ++id)
+        {
+            set<string> &tnames = (*table)[knownVerbs.getInfinitive(id)];
+            for (size_t i = 0; i < knownVerbs.getNumTemplates(id); ++i)
+                tnames.insert(knownVerbs.getTemplateName(id, i));
+        }
+        knownVerbTable = table;
+    }
+    pthread_mutex_unlock(&copyMutex);
+    return *knownVerbTable;
+}
+
+
+void
+FrenchVerbDictionary::forgetKnownVerbTable()
+{
+    delete knownVerbTable;
+    knownVerbTable = NULL;
 }
 
 
-const std::set<std::string> &
+const set<string> &
 FrenchVerbDictionary::getVerbTemplateSet(const char *infinitive) const
 {
-    static const std::set<std::string> emptySet;
+    static const set<string> emptySet;
     if (infinitive == NULL)
         return emptySet;
-    VerbTable::const_iterator it = knownVerbs.find(infinitive);
-    if (it == knownVerbs.end())
+    const VerbTable &table = getKnownVerbTable();
+    VerbTable::const_iterator it = table.find(infinitive);
+    if (it == table.end())
         return emptySet;
     return it->second;
 }
 
 
-const std::set<std::string> &
+const set<string> &
 FrenchVerbDictionary::getVerbTemplateSet(const string &infinitive) const
 {
     return getVerbTemplateSet(infinitive.c_str());
@@ -758,14 +1777,14 @@ FrenchVerbDictionary::getVerbTemplateSet(const string &infinitive) const
 VerbTable::const_iterator
 FrenchVerbDictionary::beginKnownVerbs() const
 {
-    return knownVerbs.begin();
+    return getKnownVerbTable().begin();
 }
 
 
 VerbTable::const_iterator
 FrenchVerbDictionary::endKnownVerbs() const
 {
-    return knownVerbs.end();
+    return getKnownVerbTable().end();
 }
 
 
@@ -774,14 +1793,14 @@ FrenchVerbDictionary::getMTPNForInflection(
                                 const std::string &templateName,
                                 const std::string &inflection) const
 {
-    InflectionTable::const_iterator i = inflectionTable.find(templateName);
+    SharedInflectionTable::const_iterator i = inflectionTable.find(templateName);
     if (i == inflectionTable.end())
         return NULL;
-    const TemplateInflectionTable &ti = i->second;
+    const TemplateInflectionTable &ti = *i->second;
     TemplateInflectionTable::const_iterator j = ti.find(inflection);
     if (j == ti.end())
         return NULL;
-    return &j->second;
+    return &slotTable.getExpandedSet(j->second);
 }
 
 
@@ -883,45 +1902,92 @@ FrenchVerbDictionary::convertTenseName(const char *tenseName)
 }
 
 
+// Implements both deconjugate() methods.  'Results' is either
+// vector<InflectionDesc> or DeconjugationResults: appendInflections()
+// is overloaded for both.
+//
+template <class Results>
 void
-FrenchVerbDictionary::deconjugate(const string &utf8ConjugatedVerb,
-                                std::vector<InflectionDesc> &results)
+FrenchVerbDictionary::deconjugateInto(const string &utf8ConjugatedVerb,
+                                      Results &results) const
 {
-    verbTrie.setDestination(&results);
+    QueryCounts counts;
+    if (!stats.isEnabled())
+    {
+        findInflections(utf8ConjugatedVerb, results, counts);
+        return;
+    }
 
-    try
+    const unsigned long long startTime = DictionaryStats::now();
+    const size_t numResultsBefore = results.size();
+    findInflections(utf8ConjugatedVerb, results, counts);
+    stats.add(DictionaryStats::DECONJUGATE_CALLS, 1);
+    stats.add(DictionaryStats::DECONJUGATE_HITS, results.size() > numResultsBefore);
+    stats.add(DictionaryStats::FILTER_REJECTS, counts.rejectedByFilter);
+    stats.add(DictionaryStats::STATES_VISITED, counts.numStatesVisited);
+    stats.add(DictionaryStats::TEMPLATE_PROBES, counts.numTemplateProbes);
+    stats.addLatency(DictionaryStats::DECONJUGATE, startTime);
+}
+
+
+// Searches the indexes for the inflections of a conjugated verb, and
+// counts the work done.
+//
+template <class Results>
+void
+FrenchVerbDictionary::findInflections(const string &utf8ConjugatedVerb,
+                                      Results &results,
+                                      QueryCounts &counts) const
+{
+    // The trie and the inflection table are both keyed on UTF-8 strings,
+    // so the conjugated verb is searched as is.  A radical in the trie
+    // always ends on a character boundary, and so does any prefix of
+    // the conjugated verb that matches it.  If the conjugated verb is
+    // not valid UTF-8 (e.g., Latin-1), its termination will not be found
+    // in the inflection table, and it is treated as an unknown verb.
+    //
+    // Most words of a text are not verbs: the filter rejects them with
+    // a single memory access.  It is missing in the same cases as the
+    // verb automaton.
+    //
+    if (verbFormFilter.isBuilt() && !verbFormFilter.mayContain(utf8ConjugatedVerb))
     {
-        wstring w = utf8ToWide(utf8ConjugatedVerb);
-        (void) verbTrie.get(w);
+        (void) __sync_add_and_fetch(&numFilteredLookups, 1);
+        counts.rejectedByFilter = true;
+        return;
     }
-    catch (int e)  // exception throw by utf8towide()
+
+    // The automata are only missing while the dictionary is being loaded,
+    // and the verb automaton after addVerb() until rebuildVerbIndex().
+    //
+    if (strategy == SUFFIX_FIRST && verbDawg.isBuilt() && terminationDawg.isBuilt())
     {
-        // Wrong encoding (possibly Latin-1). Act as with unknown verb.
+        deconjugateSuffixFirst(utf8ConjugatedVerb, results, counts);
+        return;
     }
 
-    verbTrie.setDestination(NULL);
+    InflectionCollector<Results> collector(*this, results, counts);
+    if (verbDawg.isBuilt())
+        (void) verbDawg.forEachPrefix(utf8ConjugatedVerb, collector, &counts.numStatesVisited);
+    else
+        (void) verbTrie.forEachPrefix(utf8ConjugatedVerb, collector);
 }
 
 
-/*virtual*/
+template <class Results>
 void
-FrenchVerbDictionary::VerbTrie::onFoundPrefixWithUserData(
-                        const wstring &conjugatedVerb,
-                        wstring::size_type index,
-                        const vector<TrieValue> *templateList) const throw()
+FrenchVerbDictionary::InflectionCollector<Results>::operator () (
+                        const string &conjugatedVerb,
+                        string::size_type index,
+                        const vector<TrieValue> *templateList) const
 {
     assert(templateList != NULL);
     if (trace)
-        wcout << "VerbTrie::onFoundPrefixWithUserData: start: conjugatedVerb='"
+        cout << "InflectionCollector: start: conjugatedVerb='"
               << conjugatedVerb << "', index=" << index
-              << ", templateList: " << templateList->size()
-              << ", results=" << results << endl;
-
-    if (results == NULL)
-        return;
+              << ", templateList: " << templateList->size() << endl;
 
-    const wstring term(conjugatedVerb, index);
-    const string utf8Term = fvd.wideToUTF8(term);
+    const string utf8Term(conjugatedVerb, index);
 
     if (trace)
         cout << "  utf8Term='" << utf8Term << "'\n";
@@ -929,65 +1995,196 @@ FrenchVerbDictionary::VerbTrie::onFoundPrefixWithUserData(
     /*
         'templateList' contains the names of conjugated templates that might
         apply to the conjugated verb.  We check each of them to see if there
-        is one that accepts the given termination 'term'.
+        is one that accepts the given termination 'utf8Term'.
     */
     for (vector<TrieValue>::const_iterator i = templateList->begin();
                                            i != templateList->end(); i++)
     {
         const TrieValue &trieValue = *i;
-        const string &tname = trieValue.templateName;
+        const string &tname = *trieValue.templateName;
         const TemplateInflectionTable &ti =
-                                fvd.inflectionTable.find(tname)->second;
+                                *fvd.inflectionTable.find(tname)->second;
         TemplateInflectionTable::const_iterator j = ti.find(utf8Term);
+        ++counts.numTemplateProbes;
         if (trace)
             cout << "    tname='" << tname << "'\n";
         if (j == ti.end())
-            continue;  // template 'tname' does not accept termination 'term'
+            continue;  // template 'tname' does not accept termination 'utf8Term'
 
-        // template 'tname' accepts 'term', so we produce some results.
+        // template 'tname' accepts 'utf8Term', so we produce some results.
 
-        string templateTerm(tname, tname.find(':') + 1);
-            // termination of the infinitive form
-        if (trace)
-            cout << "    templateTerm='" << templateTerm << "'\n";
+        fvd.appendInflections(conjugatedVerb, index, trieValue, j->second, results);
+    }
+}
 
-        const vector<ModeTensePersonNumber> &v = j->second;
-            // list of mode-tense-person combinations that can correspond
-            // to the conjugated verb's termination
 
-        for (vector<ModeTensePersonNumber>::const_iterator k = v.begin();
-                                                    k != v.end(); k++)
-        {
-            const ModeTensePersonNumber &mtpn = *k;
+template <class Results>
+class FrenchVerbDictionary::SuffixAcceptor
+{
+public:
+
+    SuffixAcceptor(const FrenchVerbDictionary &d,
+                   const string &v,
+                   Results &r)
+      : fvd(d), conjugatedVerb(v), results(r)
+    {
+    }
 
-            string infinitive = trieValue.correctVerbRadical + templateTerm;
-                // The infinitive of the conjugated verb is formed from its
-                // (correct) radical part and from the termination of the template name.
-                // Correct means with the proper accents. This allows the user
-                // to type "etaler" without the acute accent on the first "e"
-                // and obtain the conjugation for the correct verb, which has
-                // that accent.
+    bool isBefore(const TerminationValue &t, const TrieValue &r) const
+    {
+        return *t.templateName < *r.templateName;
+    }
 
-            if (trace)
-            {
-                const wstring radical(conjugatedVerb, 0, index);
-                cout << "VerbTrie::onFoundPrefixWithUserData: radical='"
-                    << fvd.wideToUTF8(radical) << "', templateTerm='" << templateTerm
-                    << "', tname='" << tname
-                    << "', correctVerbRadical='" << trieValue.correctVerbRadical
-                    << "', mtpn=("
-                    << mtpn.mode << ", "
-                    << mtpn.tense << ", "
-                    << (unsigned) mtpn.person << ", "
-                    << mtpn.plural << ", "
-                    << mtpn.correct << ")\n";
-            }
+    bool isSame(const TerminationValue &t, const TrieValue &r) const
+    {
+        return *t.templateName == *r.templateName;
+    }
 
-            results->push_back(InflectionDesc(infinitive, tname, mtpn));
-                // the InflectionDesc object is an analysis of the
-                // conjugated verb
-        }
+    bool operator () (string::size_type radicalLength,
+                      const TrieValue &trieValue,
+                      const TerminationValue &terminationValue)
+    {
+        fvd.appendInflections(conjugatedVerb, radicalLength, trieValue,
+                              terminationValue.slotSet, results);
+        return true;
     }
+
+private:
+    const FrenchVerbDictionary &fvd;
+    const string &conjugatedVerb;
+    Results &results;
+
+    // Forbidden operations:
+    SuffixAcceptor &operator = (const SuffixAcceptor &);
+};
+
+
+// Implements the SUFFIX_FIRST strategy.
+// The results are produced in the same order as with PREFIX_FIRST:
+// by increasing radical length, then in the order of the TrieValue
+// objects associated with the radical.
+//
+template <class Results>
+void
+FrenchVerbDictionary::deconjugateSuffixFirst(
+                                const string &utf8ConjugatedVerb,
+                                Results &results,
+                                QueryCounts &counts) const
+{
+    DawgTerminations<TerminationValue> terminations(terminationDawg,
+                                                    &counts.numStatesVisited);
+    DawgRadicals<TrieValue> radicals(verbDawg, &counts.numStatesVisited);
+    SuffixAcceptor<Results> acceptor(*this, utf8ConjugatedVerb, results);
+    searchSuffixFirst(utf8ConjugatedVerb, terminations, radicals, acceptor,
+                      &counts.numTemplateProbes);
+}
+
+
+// Stores in 'results' the inflections described by set 'slotSet' of
+// 'slotTable' for
+// the verb whose radical is the first 'radicalLength' bytes of
+// 'conjugatedVerb' and whose template is trieValue.templateName.
+//
+void
+FrenchVerbDictionary::appendInflections(
+                        const string &conjugatedVerb,
+                        string::size_type radicalLength,
+                        const TrieValue &trieValue,
+                        unsigned slotSet,
+                        vector<InflectionDesc> &results) const
+{
+    const string &tname = *trieValue.templateName;
+    string templateTerm(tname, tname.find(':') + 1);
+        // termination of the infinitive form
+    if (trace)
+        cout << "    templateTerm='" << templateTerm << "'\n";
+
+    string infinitive = (trieValue.correctVerbRadical.empty()
+                            ? string(conjugatedVerb, 0, radicalLength)
+                            : trieValue.correctVerbRadical);
+    infinitive += templateTerm;
+        // The infinitive of the conjugated verb is formed from its
+        // (correct) radical part and from the termination of the template name.
+        // Correct means with the proper accents. This allows the user
+        // to type "etaler" without the acute accent on the first "e"
+        // and obtain the conjugation for the correct verb, which has
+        // that accent.  An empty correct radical means that the
+        // radical found in the trie is already correct.
+
+    // 'slotSet' is the set of mode-tense-person combinations that can
+    // correspond to the conjugated verb's termination.  Its bits are
+    // enumerated in increasing order, which is the order of the
+    // conjugation file.
+    //
+    const unsigned *words = slotTable.getSetWords(slotSet);
+    const size_t numWords = slotTable.getNumWordsPerSet();
+    for (size_t w = 0; w < numWords; ++w)
+      for (unsigned word = words[w]; word != 0; word &= word - 1)
+      {
+        const unsigned slotNumber = unsigned(w * InflectionSlotTable::BITS_PER_WORD
+                                + InflectionSlotTable::findLowestBit(word));
+        const ModeTensePersonNumber mtpn = slotTable.getSlot(slotNumber);
+
+        if (trace)
+        {
+            const string radical(conjugatedVerb, 0, radicalLength);
+            cout << "appendInflections: radical='"
+                << radical << "', templateTerm='" << templateTerm
+                << "', tname='" << tname
+                << "', correctVerbRadical='" << trieValue.correctVerbRadical
+                << "', mtpn=("
+                << mtpn.mode << ", "
+                << mtpn.tense << ", "
+                << (unsigned) mtpn.person << ", "
+                << mtpn.plural << ", "
+                << mtpn.correct << ")\n";
+        }
+
+        results.push_back(InflectionDesc(infinitive, tname, mtpn));
+            // the InflectionDesc object is an analysis of the
+            // conjugated verb
+      }
+}
+
+
+// Same as above, but only designates the radical and the template
+// of each inflection, whose strings are formed on demand.
+//
+void
+FrenchVerbDictionary::appendInflections(
+                        const string & /*conjugatedVerb*/,
+                        string::size_type radicalLength,
+                        const TrieValue &trieValue,
+                        unsigned slotSet,
+                        DeconjugationResults &results) const
+{
+    const unsigned *words = slotTable.getSetWords(slotSet);
+    const size_t numWords = slotTable.getNumWordsPerSet();
+    for (size_t w = 0; w < numWords; ++w)
+      for (unsigned word = words[w]; word != 0; word &= word - 1)
+      {
+        const unsigned slotNumber = unsigned(w * InflectionSlotTable::BITS_PER_WORD
+                                + InflectionSlotTable::findLowestBit(word));
+        results.add(trieValue, radicalLength, slotTable.getSlot(slotNumber));
+      }
+}
+
+
+void
+FrenchVerbDictionary::deconjugate(const string &utf8ConjugatedVerb,
+                                std::vector<InflectionDesc> &results) const
+{
+    deconjugateInto(utf8ConjugatedVerb, results);
+}
+
+
+void
+FrenchVerbDictionary::deconjugate(const string &utf8ConjugatedVerb,
+                                  DeconjugationResults &results) const
+{
+    results.start(utf8ConjugatedVerb);
+    deconjugateInto(utf8ConjugatedVerb, results);
+    results.finish(*this);
 }
 
 
@@ -1027,7 +2224,7 @@ FrenchVerbDictionary::getModeName(Mode m)
 const char *
 FrenchVerbDictionary::getTenseName(Tense t)
 {
-    if (int(t) < int(PRESENT_TENSE) || int(t) > int(PAST_PERFECT))
+    if (int(t) < int(PRESENT_TENSE) || int(t) > int(FUTURE_ANTERIOR_TENSE))
     {
         assert(!"FrenchVerbDictionary::getTenseName() received invalid Tense value");
         return NULL;
@@ -1037,6 +2234,7 @@ FrenchVerbDictionary::getTenseName(Tense t)
     {
         "present", "past", "imperfect", "future",
         "active", "passive", "active", "passive", "past perfect",
+        "compound past", "pluperfect", "past anterior", "future anterior",
     };
 
     size_t index = size_t(t) - 1;
@@ -1165,26 +2363,133 @@ FrenchVerbDictionary::generateTense(const string &radical,
                                 bool aspirateH,
                                 bool isItalian) const throw()
 {
-    if (templ.find(mode) == templ.end())
+    ConjugationBuffer buffer;
+    if (!generateTenseInto(radical, templ, mode, tense, buffer,
+                            includePronouns, aspirateH, isItalian))
         return false;
 
-    const ModeSpec &modeSpec = templ.find(mode)->second;
+    const size_t numPersons = buffer.getNumPersons(0);
+    for (size_t p = 0; p < numPersons; ++p)
+    {
+        dest.push_back(vector<string>());
+        const size_t numForms = buffer.getNumForms(0, p);
+        for (size_t i = 0; i < numForms; ++i)
+            dest.back().push_back(buffer.getForm(0, p, i));
+    }
+    return true;
+}
+
 
-    if (modeSpec.find(tense) == modeSpec.end())
-        return false;
+// Decodes the UTF-8 character at 's', which must be before 'end',
+// and advances 's' past it.  An invalid byte is returned as is.
+//
+static wchar_t
+decodeUTF8Char(const char *&s, const char *end)
+{
+    const unsigned char c0 = (unsigned char) *s++;
+    size_t numContinuationBytes;
+    wchar_t ch;
+    if (c0 < 0x80)
+        return c0;
+    else if ((c0 & 0xE0) == 0xC0)
+        numContinuationBytes = 1, ch = c0 & 0x1F;
+    else if ((c0 & 0xF0) == 0xE0)
+        numContinuationBytes = 2, ch = c0 & 0x0F;
+    else if ((c0 & 0xF8) == 0xF0)
+        numContinuationBytes = 3, ch = c0 & 0x07;
+    else
+        return c0;  // invalid lead byte
+
+    if (size_t(end - s) < numContinuationBytes)
+        return c0;  // truncated sequence
+    for (size_t i = 0; i < numContinuationBytes; ++i)
+        if ((s[i] & 0xC0) != 0x80)
+            return c0;  // invalid continuation byte
+    for (size_t i = 0; i < numContinuationBytes; ++i)
+        ch = (ch << 6) | (*s++ & 0x3F);
+    return ch;
+}
 
-    const TenseSpec &tenseSpec = modeSpec.find(tense)->second;
 
-    if (mode != INDICATIVE_MODE
-            && mode != CONDITIONAL_MODE
-            && mode != SUBJUNCTIVE_MODE)
-        includePronouns = false;
+// Returns the first character of the given UTF-8 string, or 0 if the
+// string is empty.  Only that character is decoded.
+//
+static wchar_t
+getFirstUTF8Char(const string &s)
+{
+    if (s.empty())
+        return 0;
+    const char *p = s.data();
+    return decodeUTF8Char(p, p + s.length());
+}
 
-    for (TenseSpec::const_iterator p = tenseSpec.begin();
-                                    p != tenseSpec.end(); p++)
+
+//static
+bool
+FrenchVerbDictionary::equalIgnoringAccents(const char *utf8A, size_t lenA,
+                                           const char *utf8B, size_t lenB)
+{
+    const char *endA = utf8A + lenA, *endB = utf8B + lenB;
+    while (utf8A < endA && utf8B < endB)
     {
-        dest.push_back(vector<string>());
-        for (PersonSpec::const_iterator i = p->begin(); i != p->end(); i++)
+        if (removeWideCharAccent(decodeUTF8Char(utf8A, endA))
+                != removeWideCharAccent(decodeUTF8Char(utf8B, endB)))
+            return false;
+    }
+    return utf8A == endA && utf8B == endB;
+}
+
+
+// A TemplateSpec holds its tenses and persons, while a SharedTemplateSpec
+// designates shared copies of them.
+//
+static inline const TenseSpec &
+getTenseSpec(const TenseSpec &tenseSpec)
+{
+    return tenseSpec;
+}
+
+
+static inline const SharedTenseSpec &
+getTenseSpec(const SharedTenseSpec *tenseSpec)
+{
+    return *tenseSpec;
+}
+
+
+static inline const PersonSpec &
+getPersonSpec(const PersonSpec &personSpec)
+{
+    return personSpec;
+}
+
+
+static inline const PersonSpec &
+getPersonSpec(const PersonSpec *personSpec)
+{
+    return *personSpec;
+}
+
+
+// Appends to 'dest' the persons of 'tenseSpec' for the verb whose radical
+// is 'radical', according to the rules of the language described by 'Policy'.
+//
+template <class Policy, class TenseSpecT>
+static void
+appendTense(const string &radical,
+            const TenseSpecT &tenseSpec,
+            Mode mode,
+            ConjugationBuffer &dest,
+            bool includePronouns,
+            bool aspirateH)
+{
+    for (typename TenseSpecT::const_iterator p = tenseSpec.begin();
+                                             p != tenseSpec.end(); p++)
+    {
+        const size_t noPers = p - tenseSpec.begin();
+        const PersonSpec &personSpec = getPersonSpec(*p);
+
+        for (PersonSpec::const_iterator i = personSpec.begin(); i != personSpec.end(); i++)
         {
             // Do not return spellings that are marked incorrect.
             // They are in the knowledge base only to allow
@@ -1193,61 +2498,187 @@ FrenchVerbDictionary::generateTense(const string &radical,
             if (!(*i).isCorrect)
                 continue;
 
-            string pronoun;  // no pronoun by default
-
-            string v = radical + (*i).inflection;
+            const char *conj = "";  // no subordinator by default
+            const char *pronoun = "";  // no pronoun by default
 
             if (includePronouns)
             {
-                size_t noPers = p - tenseSpec.begin();
-                switch (noPers)
+                if (noPers < 6)
+                    pronoun = Policy::pronouns[noPers];
+
+                if (Policy::ELIDES_FIRST_PERSON && noPers == 0 && !aspirateH)
                 {
-                case 0:
-                    if (isItalian)
-                        pronoun = "io ";
-                    else
-                    {
-                        bool elideJe = false;
-                        if (!aspirateH)
-                        {
-                            wstring wideV = utf8ToWide(v);  // inefficient: converts all chars, only 1st needed
-                            wchar_t init = (wideV.empty() ? '\0' : wideV[0]);
-                            if (init == 'h' || init == 'H' || isWideVowel(init))
-                                elideJe = true;
-                        }
-                        pronoun = (elideJe ? "j'" : "je ");
-                    }
-                    break;
-                case 1: pronoun = "tu "; break;
-                case 2: pronoun = (isItalian ? "egli " : "il "); break;
-                case 3: pronoun = (isItalian ? "noi "  : "nous "); break;
-                case 4: pronoun = (isItalian ? "voi "  : "vous "); break;
-                case 5: pronoun = (isItalian ? "essi " : "ils "); break;
+                    // Only the first character of the conjugated
+                    // verb is needed.
+                    wchar_t init = getFirstUTF8Char(
+                            radical.empty() ? (*i).inflection : radical);
+                    if (init == 'h' || init == 'H'
+                            || FrenchVerbDictionary::isWideVowel(init))
+                        pronoun = Policy::elidedFirstPerson;
                 }
 
                 if (mode == SUBJUNCTIVE_MODE)
-                {
-                    const char *conj;
-                    if (isItalian)
-                        conj = "che ";
-                    else if (noPers == 2 || noPers == 5)
-                        conj = "qu'";
-                    else
-                        conj = "que ";
-                    pronoun = conj + pronoun;
-                }
+                    conj = Policy::getSubordinator(noPers);
             }
 
-            dest.back().push_back(pronoun + v);
+            dest.appendForm(conj, pronoun, radical, (*i).inflection);
         }
+        dest.endPerson();
     }
 
+    dest.endTense();
+}
+
+
+// Appends to 'dest' the given tense of the verb whose radical is 'radical',
+// according to the rules of the language described by 'Policy'.
+// Returns false if the template does not define the mode or the tense.
+// 'TemplateSpecT' is TemplateSpec or SharedTemplateSpec.
+//
+template <class Policy, class TemplateSpecT>
+static bool
+generateTenseForLanguage(const string &radical,
+                        const TemplateSpecT &templ,
+                        Mode mode,
+                        Tense tense,
+                        ConjugationBuffer &dest,
+                        bool includePronouns,
+                        bool aspirateH)
+{
+    typename TemplateSpecT::const_iterator itMode = templ.find(mode);
+    if (itMode == templ.end())
+        return false;
+
+    typename TemplateSpecT::mapped_type::const_iterator itTense = itMode->second.find(tense);
+    if (itTense == itMode->second.end())
+        return false;
+
+    if (!Policy::usesPronouns(mode))
+        includePronouns = false;
+
+    appendTense<Policy>(radical, getTenseSpec(itTense->second), mode,
+                        dest, includePronouns, aspirateH);
     return true;
 }
 
 
+// Appends to 'dest' all the tenses listed by Policy::tenses.
+// A tense that the template does not define is appended empty,
+// so that the tense numbers correspond to the entries of the list.
+//
+template <class Policy>
+static void
+generateConjugationForLanguage(const string &radical,
+                                const SharedTemplateSpec &templ,
+                                ConjugationBuffer &dest,
+                                bool includePronouns,
+                                bool aspirateH)
+{
+    for (const ModeTense *mt = Policy::tenses; mt->mode != INVALID_MODE; ++mt)
+        if (!generateTenseForLanguage<Policy>(radical, templ, mt->mode, mt->tense,
+                                              dest, includePronouns, aspirateH))
+            dest.endTense();
+}
+
+
+bool
+FrenchVerbDictionary::generateTenseInto(const string &radical,
+                                const TemplateSpec &templ,
+                                Mode mode,
+                                Tense tense,
+                                ConjugationBuffer &dest,
+                                bool includePronouns,
+                                bool aspirateH,
+                                bool isItalian) const throw()
+{
+    const unsigned long long startTime = (stats.isEnabled() ? DictionaryStats::now() : 0);
+
+    // The language of the dictionary decides, as in generateConjugation().
+    // 'isItalian' is only honored for the callers that still pass true.
+    //
+    bool generated;
+    switch (isItalian ? ITALIAN : lang)
+    {
+    case ITALIAN:
+        generated = generateTenseForLanguage<ItalianPolicy>(radical, templ, mode, tense,
+                                            dest, includePronouns, aspirateH);
+        break;
+    case GREEK:
+        generated = generateTenseForLanguage<GreekPolicy>(radical, templ, mode, tense,
+                                            dest, includePronouns, aspirateH);
+        break;
+    default:
+        generated = generateTenseForLanguage<FrenchPolicy>(radical, templ, mode, tense,
+                                            dest, includePronouns, aspirateH);
+    }
+
+    stats.add(DictionaryStats::TENSES_GENERATED, generated);
+    stats.addLatency(DictionaryStats::GENERATE_TENSE, startTime);
+    return generated;
+}
+
+
+void
+FrenchVerbDictionary::generateConjugation(const string &infinitive,
+                                        const string &templateName,
+                                        ConjugationBuffer &dest,
+                                        bool includePronouns) const throw()
+{
+    dest.clear();
+
+    SharedConjugationSystem::const_iterator it = conjugSys.find(templateName);
+    if (it == conjugSys.end())
+        return;
+    const SharedTemplateSpec &templ = it->second;
+
+    const unsigned long long startTime = (stats.isEnabled() ? DictionaryStats::now() : 0);
+
+    try
+    {
+        string radical = getRadical(infinitive, templateName);
+        bool aspirateH = isVerbStartingWithAspirateH(infinitive);
+
+        switch (lang)
+        {
+        case ITALIAN:
+            generateConjugationForLanguage<ItalianPolicy>(radical, templ, dest,
+                                                    includePronouns, aspirateH);
+            break;
+        case GREEK:
+            generateConjugationForLanguage<GreekPolicy>(radical, templ, dest,
+                                                    includePronouns, aspirateH);
+            break;
+        default:
+            generateConjugationForLanguage<FrenchPolicy>(radical, templ, dest,
+                                                    includePronouns, aspirateH);
+        }
+    }
+    catch (logic_error &e)
+    {
+        dest.clear();
+    }
+
+    stats.add(DictionaryStats::TENSES_GENERATED, dest.getNumTenses());
+    stats.addLatency(DictionaryStats::GENERATE_CONJUGATION, startTime);
+}
+
+
+//static
+const ModeTense *
+FrenchVerbDictionary::getConjugationTenses(Language l)
+{
+    switch (l)
+    {
+    case ITALIAN: return ItalianPolicy::tenses;
+    case GREEK:   return GreekPolicy::tenses;
+    default:      return FrenchPolicy::tenses;
+    }
+}
+
+
 bool FrenchVerbDictionary::isVerbStartingWithAspirateH(
                                 const std::string &infinitive) const throw()
 {
-    return aspirateHVerbs.find(infinitive) != aspirateHVerbs.end();
+    return (knownVerbs.getFlags(knownVerbs.find(infinitive))
+            & VerbRecordTable::ASPIRATE_H) != 0;
 }
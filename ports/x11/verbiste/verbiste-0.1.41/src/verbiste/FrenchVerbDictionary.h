@@ -26,6 +26,10 @@
 #include <verbiste/c-api.h>
 #include <verbiste/misc-types.h>
 #include <verbiste/Trie.h>
+#include <verbiste/Dawg.h>
+#include <verbiste/VerbRecordTable.h>
+#include <verbiste/BloomFilter.h>
+#include <verbiste/DictionaryStats.h>
 
 #include <libxml/xmlmemory.h>
 #include <libxml/parser.h>
@@ -42,6 +46,10 @@
 namespace verbiste {
 
 
+struct CompiledDictionary;
+class DeconjugationResults;
+
+
 /** French verbs and conjugation knowledge base.
     The text processing done by this class is case-sensitive.
 */
@@ -93,6 +101,22 @@ public:
                         Language lang)
                                         throw (std::logic_error);
 
+    /** Constructs a dictionary from the data compiled into the library.
+        The conjugation and verb XML files of the distribution are
+        compiled into the library when it is built, so this constructor
+        reads no file and parses no XML.  The indexes built from the
+        verbs are also compiled, and are loaded instead of being built,
+        and so are the verb frequencies of the distribution.
+        The additional verbs of $HOME/.verbiste/verbs-<lang>.xml are
+        not loaded.
+        @param    lang                  language of the dictionary
+        @param    includeWithoutAccents fill knowledge base with variants of
+                                        verbs where some or all accents are missing
+        @throws   logic_error           for an invalid language
+    */
+    FrenchVerbDictionary(Language lang, bool includeWithoutAccents)
+                                        throw (std::logic_error);
+
     /** Load the French conjugation database.
         Uses the default (hard-coded) location for the French dictionary's
         data filenames.
@@ -110,44 +134,151 @@ public:
     ~FrenchVerbDictionary();
 
     /** Returns a conjugation template specification from its name.
+        The dictionary shares identical tenses among its templates;
+        the first request for a template copies it into a TemplateSpec
+        that is kept until the dictionary is destroyed.
         @param    templateName  name of the desired template (e.g. "aim:er")
         @returns                a pointer to the TemplateSpec object if found,
                                 or NULL otherwise
     */
     const TemplateSpec *getTemplate(const std::string &templateName) const;
 
-    /** Returns an iterator for the list of conjugation templates. */
+    /** Returns an iterator for the list of conjugation templates.
+        The first call copies all the templates, as getTemplate() does.
+    */
     ConjugationSystem::const_iterator beginConjugSys() const;
 
     /** Returns an iterator for the end of the list of conjugation templates. */
     ConjugationSystem::const_iterator endConjugSys() const;
 
+    /** Returns the table of known verbs, sorted by infinitive.
+        The templates used by a verb are obtained with
+        getKnownVerbs().find() and VerbRecordTable::getTemplateName().
+        The infinitives and the template names are in UTF-8.
+    */
+    const VerbRecordTable &getKnownVerbs() const { return knownVerbs; }
+
     /** Returns the set of templates used by a verb.
-        @param    infinitive    infinitive form of the verb in Latin-1
+        Deprecated: use getKnownVerbs().  The first call to this method,
+        to the other getVerbTemplateSet() or to beginKnownVerbs() copies
+        the known verbs into a VerbTable that is kept until the next
+        call to addVerb() or loadVerbOverlay().
+        @param    infinitive    infinitive form of the verb in UTF-8
                                 (e.g., "manger", not "mange")
         @returns                a set of template names of the form radical:termination
-                                in Latin-1 (e.g., "aim:er"),
+                                in UTF-8 (e.g., "aim:er"),
                                 or an empty set if the verb is unknown
                                 or if 'infinitive' is NULL
     */
     const std::set<std::string> &getVerbTemplateSet(const char *infinitive) const;
 
-    /** Returns the template used by a verb.
-        @param    infinitive    infinitive form of the verb in Latin-1
+    /** Returns the set of templates used by a verb.
+        Deprecated: use getKnownVerbs().
+        @param    infinitive    infinitive form of the verb in UTF-8
                                 (e.g., "manger", not "mange")
         @returns                a set of template names of the form radical:termination
-                                in Latin-1 (e.g., "aim:er"),
+                                in UTF-8 (e.g., "aim:er"),
                                 or an empty set if the verb is unknown
-                                or NULL if the verb is unknown
     */
     const std::set<std::string> &getVerbTemplateSet(const std::string &infinitive) const;
 
-    /** Returns an iterator for the list of known verbs. */
+    /** Returns an iterator for the list of known verbs.
+        Deprecated: use getKnownVerbs().
+    */
     VerbTable::const_iterator beginKnownVerbs() const;
 
-    /** Returns an iterator for the end of the list of known verbs. */
+    /** Returns an iterator for the end of the list of known verbs.
+        Deprecated: use getKnownVerbs().
+    */
     VerbTable::const_iterator endKnownVerbs() const;
 
+    /** Adds a verb to the dictionary, or replaces the templates of
+        a known verb.
+        The verb can be conjugated and deconjugated as soon as this method
+        returns, but deconjugation uses a slower index until
+        rebuildVerbIndex() is called.  When several verbs are added,
+        call rebuildVerbIndex() once after the last one.
+        This method must not be called while other threads use this
+        dictionary.  With a DictionaryHolder, modify a new dictionary
+        before publishing it.
+        @param  utf8Infinitive  infinitive of the verb, in UTF-8
+        @param  templateName    name of the verb's conjugation template
+                                (e.g., "aim:er"), which becomes its only
+                                template
+        @param  aspirateH       true if the verb starts with an aspirate h
+        @throws logic_error     the template is unknown, the infinitive
+                                does not have the termination of the
+                                template, or one of them is not valid
+                                UTF-8; the dictionary is then unchanged
+    */
+    void addVerb(const std::string &utf8Infinitive,
+                 const std::string &templateName,
+                 bool aspirateH) throw(std::logic_error);
+
+    /** Loads verbs from an XML document that has the format of the
+        verbs-*.xml files and adds them to the dictionary.
+        A verb of the document replaces the verb of the same infinitive
+        in the dictionary, if any: all its templates are those given by
+        the document.  The other verbs of the dictionary are kept.
+        rebuildVerbIndex() should be called afterwards, like after addVerb(),
+        which has the same restrictions.
+        @param  verbsFilename   name of the XML file
+        @throws logic_error     the file could not be read or is invalid;
+                                the verbs that precede the error have
+                                been added
+    */
+    void loadVerbOverlay(const std::string &verbsFilename)
+                                                throw(std::logic_error);
+
+    /** Rebuilds the minimal automaton and the filter used to deconjugate
+        verbs after addVerb() or loadVerbOverlay() have been called.
+    */
+    void rebuildVerbIndex();
+
+    /** Loads the frequency ranks of the verbs from a text file.
+        The file gives one infinitive per line (UTF-8), from the most
+        frequent verb to the least frequent; empty lines and lines that
+        start with '#' are ignored, as are the unknown verbs and the
+        repeated ones.  The ranks previously loaded are replaced.
+        The ranks order the results of deconjugate() with a
+        DeconjugationResults, and give the verbs returned by
+        getMostFrequentVerbs(), e.g., to fill a ConjugationCache.
+        The constructors that read XML files load the ranks from the
+        file named verb-frequencies-<lang>.txt that is in the directory
+        of the verb file, if it exists.
+        This method has the same restrictions as addVerb().
+        @param  filename        name of the text file
+        @returns                the number of verbs that received a rank
+        @throws logic_error     the file could not be opened; the
+                                previous ranks are then kept
+    */
+    size_t loadVerbFrequencies(const std::string &filename)
+                                                throw(std::logic_error);
+
+    /** Indicates if verb frequency ranks have been loaded.
+    */
+    bool hasVerbFrequencies() const { return knownVerbs.getNumRankedVerbs() != 0; }
+
+    /** Returns the frequency rank of a verb: 0 for the most frequent verb,
+        1 for the next one, etc.
+        @param  utf8Infinitive  infinitive of the verb, in UTF-8
+        @returns                VerbRecordTable::NO_RANK if the verb is
+                                unknown or has no rank
+    */
+    unsigned getFrequencyRank(const std::string &utf8Infinitive) const
+    {
+        return knownVerbs.getFrequencyRank(knownVerbs.find(utf8Infinitive));
+    }
+
+    /** Appends the infinitives of the most frequent verbs to a vector,
+        from the most frequent one.  Nothing is appended if no
+        frequencies have been loaded.
+        @param  maxVerbs        maximum number of infinitives to append
+        @param  utf8Infinitives vector to which the infinitives are appended
+    */
+    void getMostFrequentVerbs(size_t maxVerbs,
+                              std::vector<std::string> &utf8Infinitives) const;
+
 
     /** Describes an inflection according to a given conjugation template.
         If the given inflection is known to the given conjugation template,
@@ -186,7 +317,39 @@ public:
     */
     static Tense convertTenseName(const char *tenseName);
 
+    /** Algorithms that deconjugate() can use.  They give the same results.
+    */
+    enum DeconjugationStrategy
+    {
+        /** Search the known verb radicals that are prefixes of the
+            conjugated verb, then check if one of the radical's templates
+            accepts the rest of the conjugated verb as a termination.
+        */
+        PREFIX_FIRST,
+
+        /** Search the known terminations that are suffixes of the
+            conjugated verb, then check if the rest of the conjugated verb
+            is a known radical that uses one of the templates that
+            accept the termination.
+        */
+        SUFFIX_FIRST
+    };
+
+    /** Selects the algorithm used by deconjugate().
+        The default is SUFFIX_FIRST.
+        This method must not be called while another thread is
+        calling deconjugate().
+    */
+    void setDeconjugationStrategy(DeconjugationStrategy s) { strategy = s; }
+
+    /** Returns the algorithm used by deconjugate().
+    */
+    DeconjugationStrategy getDeconjugationStrategy() const { return strategy; }
+
     /** Analyzes a conjugated verb and finds all known possible cases.
+        This method does not modify the dictionary, so it can be called
+        by several threads at the same time, as long as they use
+        different result vectors.
         @param   utf8ConjugatedVerb     conjugated French verb in UTF-8
                                         (e.g., "aimerions")
         @param   results        vector in which to store the inflection
@@ -196,7 +359,18 @@ public:
                                 if the given conjugated verb is unknown
     */
     void deconjugate(const std::string &utf8ConjugatedVerb,
-                            std::vector<InflectionDesc> &results);
+                            std::vector<InflectionDesc> &results) const;
+
+    /** Analyzes a conjugated verb like the other deconjugate() method,
+        but ranks the results and only forms their strings on demand.
+        See the DeconjugationResults class.
+        @param   utf8ConjugatedVerb     conjugated verb in UTF-8
+        @param   results        object that receives the results: its
+                                previous results are removed, but its
+                                options are applied
+    */
+    void deconjugate(const std::string &utf8ConjugatedVerb,
+                     DeconjugationResults &results) const;
 
     /** Returns the English name (in ASCII) of the given mode.
     */
@@ -237,6 +411,19 @@ public:
     */
     std::string removeUTF8Accents(const std::string &utf8String);
 
+    /** Compares two UTF-8 strings while ignoring accents.
+        Gives the same result as comparing the strings returned by
+        removeUTF8Accents(), but does not convert the strings.
+        @param   utf8A          first string (not necessarily null-terminated)
+        @param   lenA           number of bytes of the first string
+        @param   utf8B          second string (not necessarily null-terminated)
+        @param   lenB           number of bytes of the second string
+        @returns                true if the strings are equal once
+                                their accents are removed
+    */
+    static bool equalIgnoringAccents(const char *utf8A, size_t lenA,
+                                     const char *utf8B, size_t lenB);
+
     /** Returns all unaccented variants of a wide character string.
         If N letters are accented in 'utf8String', then 2^N variants
         are returned, where each accented letter either keeps or loses
@@ -326,7 +513,8 @@ public:
                                 with an aspirate h (e.g., "hacher", which
                                 gives "je hache") instead of a silent h
                                 (e.g., "habiter", which gives "j'habite")
-        @param    isItalian     language used (true for Italian, false for French)
+        @param    isItalian     deprecated: the language of the dictionary
+                                is used; true still forces Italian
         @returns                true for success, or false if the mode or
                                 tense is unknown.
     */
@@ -339,6 +527,60 @@ public:
                         bool aspirateH,
                         bool isItalian) const throw();
 
+    /** Generates the conjugation of a verb for a given mode and tense
+        into a reusable buffer.
+        Produces the same forms as generateTense(), but appends them as
+        one tense to 'dest' instead of creating a string per form.
+        When 'dest' has enough capacity, no memory is allocated.
+        @param    radical       radical part of the verb to conjugate
+        @param    templ         conjugation template to apply
+        @param    mode          mode to use
+        @param    tense         tense to use
+        @param    dest          buffer to which a tense is appended
+                                (only if true is returned)
+        @param    includePronouns see generateTense()
+        @param    aspirateH     see generateTense()
+        @param    isItalian     deprecated, see generateTense()
+        @returns                true for success, or false if the mode or
+                                tense is unknown.
+    */
+    bool generateTenseInto(const std::string &radical,
+                        const TemplateSpec &templ,
+                        Mode mode,
+                        Tense tense,
+                        ConjugationBuffer &dest,
+                        bool includePronouns,
+                        bool aspirateH,
+                        bool isItalian) const throw();
+
+    /** Returns the tenses of a complete conjugation in the given language.
+        In French, they are, in order: infinitive present, indicative
+        present, imperfect, future and past, conditional present,
+        subjunctive present and imperfect, imperative present, participle
+        present and past.  Italian adds the gerund present.
+        @param    l             language of the conjugation
+        @returns                an array terminated by an element whose
+                                mode is INVALID_MODE
+    */
+    static const ModeTense *getConjugationTenses(Language l);
+
+    /** Generates the complete conjugation of a verb.
+        The tenses are those returned by getConjugationTenses() for the
+        language of this dictionary, in the same order.  A tense that the
+        template does not define is present but empty.
+        @param    infinitive    infinitive of the verb (UTF-8)
+        @param    templateName  conjugation template to apply (e.g., "aim:er")
+        @param    dest          buffer that is cleared, then receives the
+                                tenses; left empty if the template is
+                                unknown or does not match the infinitive
+        @param    includePronouns put pronouns before conjugated verbs in the
+                                modes where pronouns are used
+    */
+    void generateConjugation(const std::string &infinitive,
+                             const std::string &templateName,
+                             ConjugationBuffer &dest,
+                             bool includePronouns) const throw();
+
     /** Indicates if the given verb starts with an aspirate h.
         An aspirate h means that one cannot make a contraction or liaison
         in front of the word.  For example, "hacher" has an aspirate h
@@ -353,6 +595,67 @@ public:
     */
     Language getLanguage() const { return lang; }
 
+    /** Obtains the size of the structures that index the verb radicals.
+        The radicals are first inserted in a trie, which is then converted
+        into a minimal automaton that is used by deconjugate().
+        @param  trieStates          receives the number of nodes of the trie
+        @param  trieBytes           receives the memory used by the trie
+        @param  automatonStates     receives the number of states
+                                    of the minimal automaton
+        @param  automatonBytes      receives the memory used by the states,
+                                    transitions and value pool of the
+                                    automaton
+    */
+    void getRadicalIndexSizes(size_t &trieStates, size_t &trieBytes,
+                              size_t &automatonStates,
+                              size_t &automatonBytes) const;
+
+    /** Obtains the size of the conjugation templates.
+        Identical tense specifications and identical inflection tables
+        are shared among templates.  This method reports the memory saved
+        by this sharing.
+        @param  tenseSpecs          receives the number of tenses in all
+                                    the templates
+        @param  distinctTenseSpecs  receives the number of tense
+                                    specifications actually stored
+        @param  inflectionTables    receives the number of templates
+        @param  distinctInflectionTables    receives the number of inflection
+                                    tables actually stored
+        @param  unsharedBytes       receives the approximate memory that the
+                                    tense specifications and inflection tables
+                                    would use if each template had its own copy
+        @param  sharedBytes         receives the approximate memory that they
+                                    actually use
+    */
+    void getTemplateTableSizes(size_t &tenseSpecs,
+                               size_t &distinctTenseSpecs,
+                               size_t &inflectionTables,
+                               size_t &distinctInflectionTables,
+                               size_t &unsharedBytes,
+                               size_t &sharedBytes) const;
+
+    /** Returns the filter that deconjugate() checks before searching
+        its indexes.  It contains every conjugated form that
+        deconjugate() can recognize, so that most words that are not
+        verbs are rejected without a search.
+        Its false positive rate, i.e., the proportion of the other words
+        that still go through a search, is about 1%.
+        The filter is not built after addVerb() until rebuildVerbIndex().
+    */
+    const BloomFilter &getVerbFormFilter() const { return verbFormFilter; }
+
+    /** Returns the number of calls to deconjugate() that the verb form
+        filter answered without searching the indexes.
+        The count is shared by all the threads that use this dictionary.
+    */
+    unsigned long getNumFilteredLookups() const { return numFilteredLookups; }
+
+    /** Returns the statistics on the loading and the use of this dictionary.
+        The statistics are not part of the contents of the dictionary:
+        they can be enabled and reset through a const dictionary.
+    */
+    DictionaryStats &getStats() const { return stats; }
+
 private:
 
     // User data employed in the Verb Trie.
@@ -360,88 +663,210 @@ private:
     // reached a trie entry through tolerance of missing accents.
     // This way, if the user enters "etaler", the displayed conjugation
     // will show the missing acute accent on the first "e".
+    // The correct radical is left empty when it is the same as the
+    // radical under which the value is stored in the trie.  This makes
+    // the values of unrelated radicals equal when they use the same
+    // templates, which lets the minimal automaton merge their states.
+    //
+    // The template name designates a key of 'conjugSys'.
     //
     class TrieValue
     {
     public:
-        TrieValue(const std::string &t, const std::string &r)
+        TrieValue(const std::string *t, const std::string &r)
         :   templateName(t), correctVerbRadical(r) {}
 
-        std::string templateName;
+        bool operator == (const TrieValue &v) const
+        {
+            return *templateName == *v.templateName
+                && correctVerbRadical == v.correctVerbRadical;
+        }
+
+        bool operator < (const TrieValue &v) const
+        {
+            if (*templateName != *v.templateName)
+                return *templateName < *v.templateName;
+            return correctVerbRadical < v.correctVerbRadical;
+        }
+
+        const std::string *templateName;
         std::string correctVerbRadical;
     };
 
     /** Trie that contains all known verb radicals.
         The associated information is a list of template names
         that can apply to the radical.
-        The verb radicals and the template names are stored in Latin-1.
+        The verb radicals and the template names are stored in UTF-8,
+        so that a conjugated verb can be searched without converting it
+        to wide characters, and so that its termination can be looked up
+        directly in the (UTF-8) inflection table.
+    */
+    typedef Trie< std::vector<TrieValue>, char > VerbTrie;
+
+    /** Minimal automaton built from the VerbTrie once all verbs are loaded.
     */
-    class VerbTrie : public Trie< std::vector<TrieValue> >
+    typedef Dawg< std::vector<TrieValue>, char > VerbDawg;
+
+    /** Work done by one call to deconjugate(), for the statistics.
+        It is counted in local variables, then added to the statistics
+        at once if they are enabled.
+    */
+    struct QueryCounts
     {
-    public:
-        const FrenchVerbDictionary &fvd;
-        std::vector<InflectionDesc> *results;
+        QueryCounts() : numStatesVisited(0), numTemplateProbes(0), rejectedByFilter(false) {}
+
+        size_t numStatesVisited;
+        size_t numTemplateProbes;
+        bool rejectedByFilter;
+    };
 
-        /** Constructs a trie that keeps a reference to the dictionary.
+    /** Visitor passed to VerbTrie::forEachPrefix() by deconjugate().
+        It is called for each prefix of the searched string that
+        corresponds to the radical of a known verb, and stores the
+        possible inflections of the conjugated verb in a vector
+        of InflectionDesc objects or in a DeconjugationResults object.
+    */
+    template <class Results>
+    class InflectionCollector
+    {
+    public:
+        /** Constructs a visitor that stores its results in 'r'.
             @param        d        reference to the verb dictionary
+            @param        r        destination
+            @param        c        counts to which the templates probed
+                                   are added
         */
-        VerbTrie(const FrenchVerbDictionary &d)
-          : Trie< std::vector<TrieValue> >(true),
-            fvd(d),
-            results(NULL)
+        InflectionCollector(const FrenchVerbDictionary &d, Results &r, QueryCounts &c)
+          : fvd(d),
+            results(r),
+            counts(c)
         {
         }
 
-        /** Callback invoked by the Trie<>::get() method.
-            Inherited from Trie<>.
-            This callback will be called for each prefix of the searched
-            string that corresponds to the radical of a known verb.
-            Stores data in the vector<InflectionDesc> designated by
-            the last call to setDestination().
-            @param        conjugatedVerb    the searched string
-            @param        index             length of the prefix
+        /** Called by VerbTrie::forEachPrefix() or VerbDawg::forEachPrefix().
+            @param        conjugatedVerb    the searched string (UTF-8)
+            @param        index             length of the prefix, in bytes
             @param        templateList      list of conjugation templates that
                                             might apply to the conjugated verb
         */
-        virtual void onFoundPrefixWithUserData(
-                        const std::wstring &conjugatedVerb,
-                        std::wstring::size_type index,
-                        const std::vector<TrieValue> *templateList) const
-                                                                throw();
-
-        /** Sets the destination vector in which callback() stores results.
-            When the Trie<>::get() method is called on this object,
-            it may invoke the callback() virtual method.
-            callback() will store any results in the vector designated here.
-            After calling get(), iterate through the vector to obtain
-            the possible inflections of the conjugated verb.
-            @param        d        destination vector designated as the
-                                   repository for results (may be NULL)
-        */
-        void setDestination(std::vector<InflectionDesc> *d)
-        {
-            results = d;
-        }
+        void operator () (const std::string &conjugatedVerb,
+                          std::string::size_type index,
+                          const std::vector<TrieValue> *templateList) const;
 
     private:
+        const FrenchVerbDictionary &fvd;
+        Results &results;
+        QueryCounts &counts;
+
         // Forbidden operations:
-        VerbTrie(const VerbTrie &);
-        VerbTrie &operator = (const VerbTrie &);
+        InflectionCollector &operator = (const InflectionCollector &);
+    };
+
+    template <class Results> friend class InflectionCollector;
+
+    /** Ranks and materializes the results of deconjugate().
+        It designates the values of the radical index.
+    */
+    friend class DeconjugationResults;
+
+    /** Builds the conjugation templates from the elements of a
+        conjugation document, whether they come from an XML file or
+        from compiled data.
+    */
+    class ConjugationLoader;
+
+    friend class ConjugationLoader;
+
+    /** Visitor passed to VerbTrie::forEachKey() by buildVerbFormFilter().
+        Counts the conjugated forms of the radicals of the trie, or adds
+        them to the verb form filter.
+    */
+    class VerbFormEnumerator;
+
+    friend class VerbFormEnumerator;
+
+    /** Searches the verb forms of several dictionaries at once.
+        It copies the radical and termination indexes and uses the
+        inflection tables.
+    */
+    friend class MultiLanguageIndex;
+
+    /** Copies the radical and termination indexes, the inflection slots
+        and the verb form filter into a flat image that can be shared
+        by several processes.
+    */
+    friend class SharedDictionary;
+
+    /** Copies the same indexes into the C++ source generated by the
+        compile-data program, from which the compiled dictionaries
+        load them.
+    */
+    friend class DictionaryCompiler;
+
+    /** User data employed in the termination index.
+        Designates a template that accepts a termination, and the list
+        of mode-tense-person combinations that this termination can
+        correspond to in this template.
+        The pointer designates a key of 'inflectionTable'; the set is
+        designated by its index in 'slotTable'.
+    */
+    class TerminationValue
+    {
+    public:
+        TerminationValue(const std::string *t, unsigned s)
+        :   templateName(t), slotSet(s) {}
+
+        // Used by TerminationDawg to detect equal values.
+        bool operator < (const TerminationValue &v) const
+        {
+            if (*templateName != *v.templateName)
+                return *templateName < *v.templateName;
+            return slotSet < v.slotSet;
+        }
+
+        const std::string *templateName;
+        unsigned slotSet;
     };
 
-    friend class VerbTrie;
+    /** Minimal automaton that contains the reversed (UTF-8) terminations
+        of all templates.  The list associated with a termination is
+        sorted by template name.
+    */
+    typedef Dawg< std::vector<TerminationValue>, char > TerminationDawg;
+
+    /** Accept callback passed to searchSuffixFirst() by
+        deconjugateSuffixFirst().  Stores the inflections of the
+        conjugated verb for each template that accepts its termination.
+    */
+    template <class Results>
+    class SuffixAcceptor;
+
+    template <class Results> friend class SuffixAcceptor;
 
 private:
 
-    ConjugationSystem conjugSys;
-    VerbTable knownVerbs;
-    std::set<std::string> aspirateHVerbs;
-    InflectionTable inflectionTable;
+    SharedConjugationSystem conjugSys;
+    mutable ConjugationSystem conjugSysCopy;  // templates of 'conjugSys' copied by getTemplate()
+    VerbRecordTable knownVerbs;  // built by init()
+    mutable VerbTable *knownVerbTable;  // copy of 'knownVerbs' made by getKnownVerbTable(), or NULL
+    SharedInflectionTable inflectionTable;
+    InflectionSlotTable slotTable;  // sets designated by 'inflectionTable'
+    std::set<PersonSpec> personSpecPool;  // designated by 'conjugSys'
+    std::set<SharedTenseSpec> tenseSpecPool;  // designated by 'conjugSys'
+    std::set<TemplateInflectionTable> inflectionTablePool;  // designated by 'inflectionTable'
     iconv_t wideToUTF8Conv;
     iconv_t utf8ToWideConv;
     char latin1TolowerTable[256];
-    VerbTrie verbTrie;
+    VerbTrie verbTrie;  // also holds 'verbsNotInTrie' once fillVerbTrie() is called
+    VerbDawg verbDawg;  // built from verbTrie by init(), or loaded
+    TerminationDawg terminationDawg;  // built from inflectionTable by init(), or loaded
+    BloomFilter verbFormFilter;  // built from verbTrie and inflectionTable by init(), or loaded
+    const CompiledDictionary *verbsNotInTrie;  // compiled verbs missing from verbTrie, or NULL
+    mutable unsigned long numFilteredLookups;
+    mutable DictionaryStats stats;
+    DeconjugationStrategy strategy;
     Language lang;
+    bool withoutAccents;  // also index the verbs without their accents
 
 private:
 
@@ -449,22 +874,81 @@ private:
                         const std::string &verbsFilename,
                         bool includeWithoutAccents)
                                         throw (std::logic_error);
+    void initConversions() throw (std::logic_error);
+    void buildIndexes();
+    void traceIndexes() const;
+    void readCompiledData(const CompiledDictionary &data,
+                          bool includeWithoutAccents)
+                                        throw (std::logic_error);
+    void loadCompiledIndexes(const CompiledDictionary &data,
+                             bool includeWithoutAccents)
+                                        throw (std::logic_error);
+    void fillVerbTrie();
+    const TemplateSpec &copyTemplate(SharedConjugationSystem::const_iterator it) const;
+    const VerbTable &getKnownVerbTable() const;
+    void forgetKnownVerbTable();
     void loadConjugationDatabase(const char *conjugationFilename,
                                 bool includeWithoutAccents)
                                         throw (std::logic_error);
     void loadVerbDatabase(const char *verbsFilename,
-                        bool includeWithoutAccents)
+                        bool includeWithoutAccents,
+                        bool replace)
                                         throw (std::logic_error);
+    xmlDocPtr parseXMLFile(const char *filename);
     void readConjugation(xmlDocPtr doc,
                         bool includeWithoutAccents) throw(std::logic_error);
     static void generateOtherPastParticiple(const char *mascSing,
                                         std::vector<std::string> &dest);
     void readVerbs(xmlDocPtr doc,
-                   bool includeWithoutAccents)
+                   bool includeWithoutAccents,
+                   bool replace)
+                                throw(std::logic_error);
+    void insertVerb(const std::string &utf8Infinitive,
+                    const std::string &utf8TName,
+                    bool aspirateH,
+                    bool includeWithoutAccents,
+                    bool intoTrie)
                                 throw(std::logic_error);
+    void insertVerbRadicals(const std::wstring &wideInfinitive,
+                            size_t lenTermination,
+                            const std::string *tname,
+                            bool includeWithoutAccents);
+    void removeVerb(const std::string &utf8Infinitive,
+                    bool includeWithoutAccents);
     void insertVerbRadicalInTrie(const std::string &verbRadical,
+                                    const std::string *tname,
+                                    const std::string &correctVerbRadical);
+    void removeVerbRadicalFromTrie(const std::string &verbRadical,
                                     const std::string &tname,
                                     const std::string &correctVerbRadical);
+    bool isRadicalOfTemplate(const std::string &verbRadical,
+                                    const std::string &tname) const;
+    static std::wstring::size_type getTerminationLength(
+                                    const std::wstring &wideTName)
+                                                throw(std::logic_error);
+    void buildTerminationIndex();
+    void buildVerbFormFilter();
+    template <class Results>
+    void deconjugateInto(const std::string &utf8ConjugatedVerb,
+                         Results &results) const;
+    template <class Results>
+    void findInflections(const std::string &utf8ConjugatedVerb,
+                         Results &results,
+                         QueryCounts &counts) const;
+    template <class Results>
+    void deconjugateSuffixFirst(const std::string &utf8ConjugatedVerb,
+                                Results &results,
+                                QueryCounts &counts) const;
+    void appendInflections(const std::string &conjugatedVerb,
+                           std::string::size_type radicalLength,
+                           const TrieValue &trieValue,
+                           unsigned slotSet,
+                           std::vector<InflectionDesc> &results) const;
+    void appendInflections(const std::string &conjugatedVerb,
+                           std::string::size_type radicalLength,
+                           const TrieValue &trieValue,
+                           unsigned slotSet,
+                           DeconjugationResults &results) const;
 
     // Forbidden operations:
     FrenchVerbDictionary(const FrenchVerbDictionary &x);
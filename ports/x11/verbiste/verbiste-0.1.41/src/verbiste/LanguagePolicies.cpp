@@ -0,0 +1,200 @@
+/*  $Id$
+    LanguagePolicies.cpp - Language-specific rules about conjugated verbs
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "LanguagePolicies.h"
+
+using namespace verbiste;
+
+
+// Bits of PhraseWord::persons.
+//
+static const unsigned char
+    S1 = 1 << 0, S2 = 1 << 1, S3 = 1 << 2,
+    P1 = 1 << 3, P2 = 1 << 4, P3 = 1 << 5;
+
+
+const ModeTense FrenchPolicy::tenses[] =
+{
+    { INFINITIVE_MODE, PRESENT_TENSE },
+    { INDICATIVE_MODE, PRESENT_TENSE },
+    { INDICATIVE_MODE, IMPERFECT_TENSE },
+    { INDICATIVE_MODE, FUTURE_TENSE },
+    { INDICATIVE_MODE, PAST_TENSE },
+    { CONDITIONAL_MODE, PRESENT_TENSE },
+    { SUBJUNCTIVE_MODE, PRESENT_TENSE },
+    { SUBJUNCTIVE_MODE, IMPERFECT_TENSE },
+    { IMPERATIVE_MODE, PRESENT_TENSE },
+    { PARTICIPLE_MODE, PRESENT_TENSE },
+    { PARTICIPLE_MODE, PAST_TENSE },
+    { INVALID_MODE, INVALID_TENSE }  // marks the end
+};
+
+const char *const FrenchPolicy::pronouns[6] =
+{
+    "je ", "tu ", "il ", "nous ", "vous ", "ils "
+};
+
+const char FrenchPolicy::elidedFirstPerson[] = "j'";
+
+const PhraseWord FrenchPolicy::phraseWords[] =
+{
+    { "que",      SUBORDINATOR_WORD, 0, SUBJUNCTIVE_MODE },
+    { "qu'",      SUBORDINATOR_WORD, 0, SUBJUNCTIVE_MODE },
+    { "je",       SUBJECT_WORD, S1, INVALID_MODE },
+    { "j'",       SUBJECT_WORD, S1, INVALID_MODE },
+    { "tu",       SUBJECT_WORD, S2, INVALID_MODE },
+    { "il",       SUBJECT_WORD, S3, INVALID_MODE },
+    { "elle",     SUBJECT_WORD, S3, INVALID_MODE },
+    { "on",       SUBJECT_WORD, S3, INVALID_MODE },
+    { "nous",     SUBJECT_WORD, P1, INVALID_MODE },
+    { "vous",     SUBJECT_WORD, P2, INVALID_MODE },
+    { "ils",      SUBJECT_WORD, P3, INVALID_MODE },
+    { "elles",    SUBJECT_WORD, P3, INVALID_MODE },
+    { "me",       REFLEXIVE_WORD, S1, INVALID_MODE },
+    { "m'",       REFLEXIVE_WORD, S1, INVALID_MODE },
+    { "te",       REFLEXIVE_WORD, S2, INVALID_MODE },
+    { "t'",       REFLEXIVE_WORD, S2, INVALID_MODE },
+    { "se",       REFLEXIVE_WORD, S3 | P3, INVALID_MODE },
+    { "s'",       REFLEXIVE_WORD, S3 | P3, INVALID_MODE },
+    { "nous",     REFLEXIVE_WORD, P1, INVALID_MODE },
+    { "vous",     REFLEXIVE_WORD, P2, INVALID_MODE },
+    { "ne",       CLITIC_WORD, 0, INVALID_MODE },
+    { "n'",       CLITIC_WORD, 0, INVALID_MODE },
+    { "le",       CLITIC_WORD, 0, INVALID_MODE },
+    { "la",       CLITIC_WORD, 0, INVALID_MODE },
+    { "l'",       CLITIC_WORD, 0, INVALID_MODE },
+    { "les",      CLITIC_WORD, 0, INVALID_MODE },
+    { "lui",      CLITIC_WORD, 0, INVALID_MODE },
+    { "leur",     CLITIC_WORD, 0, INVALID_MODE },
+    { "y",        CLITIC_WORD, 0, INVALID_MODE },
+    { "en",       CLITIC_WORD, 0, INVALID_MODE },
+    { "pas",      ADVERB_WORD, 0, INVALID_MODE },
+    { "plus",     ADVERB_WORD, 0, INVALID_MODE },
+    { "jamais",   ADVERB_WORD, 0, INVALID_MODE },
+    { "point",    ADVERB_WORD, 0, INVALID_MODE },
+    { "rien",     ADVERB_WORD, 0, INVALID_MODE },
+    { "guère",    ADVERB_WORD, 0, INVALID_MODE },
+    { "déjà",     ADVERB_WORD, 0, INVALID_MODE },
+    { "avoir",    AUXILIARY_WORD, 0, INVALID_MODE },
+    { "être",     AUXILIARY_WORD, 0, INVALID_MODE },
+    { NULL,       SUBORDINATOR_WORD, 0, INVALID_MODE }  // marks the end
+};
+
+
+// Same as French, followed by the gerund.
+//
+const ModeTense ItalianPolicy::tenses[] =
+{
+    { INFINITIVE_MODE, PRESENT_TENSE },
+    { INDICATIVE_MODE, PRESENT_TENSE },
+    { INDICATIVE_MODE, IMPERFECT_TENSE },
+    { INDICATIVE_MODE, FUTURE_TENSE },
+    { INDICATIVE_MODE, PAST_TENSE },
+    { CONDITIONAL_MODE, PRESENT_TENSE },
+    { SUBJUNCTIVE_MODE, PRESENT_TENSE },
+    { SUBJUNCTIVE_MODE, IMPERFECT_TENSE },
+    { IMPERATIVE_MODE, PRESENT_TENSE },
+    { PARTICIPLE_MODE, PRESENT_TENSE },
+    { PARTICIPLE_MODE, PAST_TENSE },
+    { GERUND_MODE, PRESENT_TENSE },
+    { INVALID_MODE, INVALID_TENSE }  // marks the end
+};
+
+const char *const ItalianPolicy::pronouns[6] =
+{
+    "io ", "tu ", "egli ", "noi ", "voi ", "essi "
+};
+
+const char ItalianPolicy::elidedFirstPerson[] = "io ";
+
+const PhraseWord ItalianPolicy::phraseWords[] =
+{
+    { "che",      SUBORDINATOR_WORD, 0, SUBJUNCTIVE_MODE },
+    { "io",       SUBJECT_WORD, S1, INVALID_MODE },
+    { "tu",       SUBJECT_WORD, S2, INVALID_MODE },
+    { "egli",     SUBJECT_WORD, S3, INVALID_MODE },
+    { "ella",     SUBJECT_WORD, S3, INVALID_MODE },
+    { "lui",      SUBJECT_WORD, S3, INVALID_MODE },
+    { "lei",      SUBJECT_WORD, S3, INVALID_MODE },
+    { "esso",     SUBJECT_WORD, S3, INVALID_MODE },
+    { "essa",     SUBJECT_WORD, S3, INVALID_MODE },
+    { "noi",      SUBJECT_WORD, P1, INVALID_MODE },
+    { "voi",      SUBJECT_WORD, P2, INVALID_MODE },
+    { "essi",     SUBJECT_WORD, P3, INVALID_MODE },
+    { "esse",     SUBJECT_WORD, P3, INVALID_MODE },
+    { "loro",     SUBJECT_WORD, P3, INVALID_MODE },
+    { "mi",       REFLEXIVE_WORD, S1, INVALID_MODE },
+    { "ti",       REFLEXIVE_WORD, S2, INVALID_MODE },
+    { "si",       REFLEXIVE_WORD, S3 | P3, INVALID_MODE },
+    { "ci",       REFLEXIVE_WORD, P1, INVALID_MODE },
+    { "vi",       REFLEXIVE_WORD, P2, INVALID_MODE },
+    { "non",      CLITIC_WORD, 0, INVALID_MODE },
+    { "lo",       CLITIC_WORD, 0, INVALID_MODE },
+    { "la",       CLITIC_WORD, 0, INVALID_MODE },
+    { "l'",       CLITIC_WORD, 0, INVALID_MODE },
+    { "li",       CLITIC_WORD, 0, INVALID_MODE },
+    { "le",       CLITIC_WORD, 0, INVALID_MODE },
+    { "gli",      CLITIC_WORD, 0, INVALID_MODE },
+    { "ne",       CLITIC_WORD, 0, INVALID_MODE },
+    { "mai",      ADVERB_WORD, 0, INVALID_MODE },
+    { "più",      ADVERB_WORD, 0, INVALID_MODE },
+    { "già",      ADVERB_WORD, 0, INVALID_MODE },
+    { "avere",    AUXILIARY_WORD, 0, INVALID_MODE },
+    { "essere",   AUXILIARY_WORD, 0, INVALID_MODE },
+    { NULL,       SUBORDINATOR_WORD, 0, INVALID_MODE }  // marks the end
+};
+
+
+const ModeTense GreekPolicy::tenses[] =
+{
+    { PRESENT_INDICATIVE, ACTIVE_TENSE },
+    { PRESENT_INDICATIVE, PASSIVE_TENSE },
+    { PRESENT_SUBJUNCTIVE, ACTIVE_TENSE },
+    { PRESENT_SUBJUNCTIVE, PASSIVE_TENSE },
+    { PRESENT_IMPERATIVE, IMPERATIVE_ACTIVE_TENSE },
+    { PRESENT_IMPERATIVE, IMPERATIVE_PASSIVE_TENSE },
+    { PRESENT_GERUND, PRESENT_TENSE },
+    { PAST_IMPERFECT_INDICATIVE, ACTIVE_TENSE },
+    { PAST_IMPERFECT_INDICATIVE, PASSIVE_TENSE },
+    { PAST_PERFECT_INDICATIVE, ACTIVE_TENSE },
+    { PAST_PERFECT_INDICATIVE, PASSIVE_TENSE },
+    { PAST_PERFECT_SUBJUNCTIVE, ACTIVE_TENSE },
+    { PAST_PERFECT_SUBJUNCTIVE, PASSIVE_TENSE },
+    { PAST_PERFECT_IMPERATIVE, IMPERATIVE_ACTIVE_TENSE },
+    { PAST_PERFECT_IMPERATIVE, IMPERATIVE_PASSIVE_TENSE },
+    { PAST_PERFECT_INFINITIVE, PAST_PERFECT },
+    { INVALID_MODE, INVALID_TENSE }  // marks the end
+};
+
+const char *const GreekPolicy::pronouns[6] =
+{
+    "", "", "", "", "", ""
+};
+
+const char GreekPolicy::elidedFirstPerson[] = "";
+
+// Greek phrases are not analyzed: a verb is only recognized alone.
+//
+const PhraseWord GreekPolicy::phraseWords[] =
+{
+    { NULL,       SUBORDINATOR_WORD, 0, INVALID_MODE }  // marks the end
+};
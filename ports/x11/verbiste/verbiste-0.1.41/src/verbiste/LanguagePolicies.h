@@ -0,0 +1,161 @@
+/*  $Id$
+    LanguagePolicies.h - Language-specific rules about conjugated verbs
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_LanguagePolicies
+#define _H_LanguagePolicies
+
+#include <verbiste/misc-types.h>
+
+#include <stddef.h>
+
+
+namespace verbiste {
+
+
+/*  Each policy class describes how the conjugation of a language is
+    generated.  They are used as template arguments, so that the
+    generation code is instantiated once per language and the tests
+    on the language are resolved at compile time.
+
+    A policy provides:
+    - 'tenses': the tenses of a complete conjugation, in display order,
+      terminated by { INVALID_MODE, INVALID_TENSE };
+    - usesPronouns(): whether a mode takes personal pronouns;
+    - 'pronouns': the pronoun of each of the six persons, followed by
+      a space if the pronoun is separate from the verb;
+    - ELIDES_FIRST_PERSON: whether the first person pronoun is replaced
+      by 'elidedFirstPerson' before a vowel or a silent h;
+    - getSubordinator(): the word that precedes the pronoun of
+      a subjunctive form, for a given person number (0..5);
+    - 'phraseWords': the words that can surround a conjugated verb
+      in a phrase, for PhraseAnalyzer, terminated by a null word.
+*/
+
+
+/*  Role of a word that accompanies a conjugated verb in a phrase.
+    A phrase is made of, in this order: an optional subordinator,
+    an optional subject pronoun, any number of clitics (including one
+    reflexive pronoun), the conjugated verb, and optionally adverbs
+    followed by a past participle if the verb is an auxiliary.
+*/
+enum PhraseWordRole
+{
+    SUBORDINATOR_WORD,  // e.g., "que": selects 'mode' if possible
+    SUBJECT_WORD,       // e.g., "nous"
+    REFLEXIVE_WORD,     // e.g., "nous" in "nous nous sommes"
+    CLITIC_WORD,        // object pronoun or negation, e.g., "l'", "ne"
+    ADVERB_WORD,        // between an auxiliary and the participle, e.g., "pas"
+    AUXILIARY_WORD      // infinitive of an auxiliary, e.g., "avoir"
+};
+
+
+/*  Entry of a policy's 'phraseWords' table.
+    An apostrophe at the end of 'word' also matches the typographic
+    apostrophe (U+2019), and the word is then followed by the next one
+    without a space.
+    'persons' has bit p set if the word can go with person number p
+    (0..5, i.e., 1st singular to 3rd plural); it is only used with the
+    subject and reflexive pronouns.
+*/
+struct PhraseWord
+{
+    const char *word;  // UTF-8
+    PhraseWordRole role;
+    unsigned char persons;
+    Mode mode;  // subordinators only
+};
+
+
+class FrenchPolicy
+{
+public:
+    enum { ELIDES_FIRST_PERSON = true };
+
+    static const ModeTense tenses[];
+    static const char *const pronouns[6];
+    static const char elidedFirstPerson[];
+    static const PhraseWord phraseWords[];
+
+    static bool usesPronouns(Mode mode)
+    {
+        return mode == INDICATIVE_MODE
+            || mode == CONDITIONAL_MODE
+            || mode == SUBJUNCTIVE_MODE;
+    }
+
+    static const char *getSubordinator(size_t personNo)
+    {
+        return (personNo == 2 || personNo == 5 ? "qu'" : "que ");
+    }
+};
+
+
+class ItalianPolicy
+{
+public:
+    enum { ELIDES_FIRST_PERSON = false };
+
+    static const ModeTense tenses[];
+    static const char *const pronouns[6];
+    static const char elidedFirstPerson[];
+    static const PhraseWord phraseWords[];
+
+    static bool usesPronouns(Mode mode)
+    {
+        return FrenchPolicy::usesPronouns(mode);
+    }
+
+    static const char *getSubordinator(size_t /*personNo*/)
+    {
+        return "che ";
+    }
+};
+
+
+// The Greek modes do not take pronouns.
+//
+class GreekPolicy
+{
+public:
+    enum { ELIDES_FIRST_PERSON = false };
+
+    static const ModeTense tenses[];
+    static const char *const pronouns[6];
+    static const char elidedFirstPerson[];
+    static const PhraseWord phraseWords[];
+
+    static bool usesPronouns(Mode /*mode*/)
+    {
+        return false;
+    }
+
+    static const char *getSubordinator(size_t /*personNo*/)
+    {
+        return "";
+    }
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_LanguagePolicies */
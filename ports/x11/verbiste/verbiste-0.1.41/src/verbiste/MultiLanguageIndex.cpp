@@ -0,0 +1,255 @@
+/*  $Id$
+    MultiLanguageIndex.cpp - Deconjugation in several languages at once
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "MultiLanguageIndex.h"
+#include "SuffixSearch.h"
+
+#include <assert.h>
+
+#include <algorithm>
+
+using namespace std;
+using namespace verbiste;
+
+
+// Visitor passed to VerbDawg::forEachKey() or VerbTrie::forEachKey() by
+// the constructor.
+// Adds the radicals of one dictionary to the merged trie.
+//
+class MultiLanguageIndex::RadicalCopier
+{
+public:
+
+    RadicalCopier(RadicalTrie &_trie, unsigned _dictionaryNo)
+      : trie(_trie), dictionaryNo(_dictionaryNo)
+    {
+    }
+
+    void operator () (const string &radical,
+                      const vector<FrenchVerbDictionary::TrieValue> *templateList)
+    {
+        vector<RadicalValue> **values = trie.getUserDataPointer(radical);
+        assert(values != NULL);
+        if (*values == NULL)
+            *values = new vector<RadicalValue>();
+        for (vector<FrenchVerbDictionary::TrieValue>::const_iterator i = templateList->begin();
+                                                                i != templateList->end(); ++i)
+            (*values)->push_back(RadicalValue(dictionaryNo, *i));
+    }
+
+private:
+
+    RadicalTrie &trie;
+    unsigned dictionaryNo;
+
+    // Forbidden operations:
+    RadicalCopier(const RadicalCopier &);
+    RadicalCopier &operator = (const RadicalCopier &);
+};
+
+
+// Accept callback passed to searchSuffixFirst() by search().
+// Accepts the templates of the candidate dictionaries only, and stores
+// the inflections if 'results' is not NULL.  Otherwise, drops a
+// dictionary from the candidates as soon as it accepts the word.
+//
+class MultiLanguageIndex::SuffixAcceptor
+{
+public:
+
+    SuffixAcceptor(const MultiLanguageIndex &i,
+                   const std::string &v,
+                   unsigned c,
+                   std::vector< std::vector<InflectionDesc> > *r)
+      : index(i), conjugatedVerb(v), candidates(c), found(0), results(r)
+    {
+    }
+
+    bool isBefore(const TerminationValue &t, const RadicalValue &r) const
+    {
+        if (t.dictionaryNo != r.dictionaryNo)
+            return t.dictionaryNo < r.dictionaryNo;
+        return *t.value.templateName < *r.trieValue.templateName;
+    }
+
+    bool isSame(const TerminationValue &t, const RadicalValue &r) const
+    {
+        return t.dictionaryNo == r.dictionaryNo
+               && *t.value.templateName == *r.trieValue.templateName;
+    }
+
+    bool operator () (std::string::size_type radicalLength,
+                      const RadicalValue &radicalValue,
+                      const TerminationValue &terminationValue)
+    {
+        const unsigned bit = 1u << radicalValue.dictionaryNo;
+        if ((candidates & bit) == 0)
+            return true;
+
+        found |= bit;
+        if (results == NULL)
+        {
+            candidates &= ~bit;  // the dictionary is known to accept the word
+            return candidates != 0;
+        }
+
+        index.dictionaries[radicalValue.dictionaryNo]->appendInflections(
+                            conjugatedVerb, radicalLength, radicalValue.trieValue,
+                            terminationValue.value.slotSet,
+                            (*results)[radicalValue.dictionaryNo]);
+        return true;
+    }
+
+    unsigned getFound() const { return found; }
+
+private:
+    const MultiLanguageIndex &index;
+    const std::string &conjugatedVerb;
+    unsigned candidates;
+    unsigned found;
+    std::vector< std::vector<InflectionDesc> > *results;
+
+    // Forbidden operations:
+    SuffixAcceptor(const SuffixAcceptor &);
+    SuffixAcceptor &operator = (const SuffixAcceptor &);
+};
+
+
+MultiLanguageIndex::MultiLanguageIndex(
+                        const vector<const FrenchVerbDictionary *> &_dictionaries)
+                                                            throw(logic_error)
+  : dictionaries(_dictionaries),
+    radicalDawg(),
+    terminationDawg()
+{
+    if (dictionaries.size() > MAX_DICTIONARIES)
+        throw logic_error("too many dictionaries for a MultiLanguageIndex");
+
+    // The merged tries are only needed to build the automata.
+    //
+    RadicalTrie radicalTrie(true);
+    Trie< vector<TerminationValue>, char > reversedTerminations(true);
+
+    for (size_t no = 0; no < dictionaries.size(); ++no)
+    {
+        const FrenchVerbDictionary &fvd = *dictionaries[no];
+
+        // A dictionary loaded from compiled data only fills its trie
+        // when its verbs change, which also clears its automaton.
+        //
+        RadicalCopier copier(radicalTrie, unsigned(no));
+        if (fvd.verbDawg.isBuilt())
+            fvd.verbDawg.forEachKey(copier);
+        else
+            fvd.verbTrie.forEachKey(copier);
+
+        // As in FrenchVerbDictionary::buildTerminationIndex(), each
+        // list is sorted by template name within a dictionary, and the
+        // dictionaries are added in order.
+        //
+        for (SharedInflectionTable::const_iterator it = fvd.inflectionTable.begin();
+                                                   it != fvd.inflectionTable.end(); ++it)
+        {
+            const TemplateInflectionTable &ti = *it->second;
+            for (TemplateInflectionTable::const_iterator jt = ti.begin(); jt != ti.end(); ++jt)
+            {
+                const string reversedTerm(jt->first.rbegin(), jt->first.rend());
+                vector<TerminationValue> **templateListPtr =
+                            reversedTerminations.getUserDataPointer(reversedTerm);
+                if (*templateListPtr == NULL)
+                    *templateListPtr = new vector<TerminationValue>();
+                (*templateListPtr)->push_back(TerminationValue(unsigned(no),
+                        FrenchVerbDictionary::TerminationValue(&it->first, jt->second)));
+            }
+        }
+    }
+
+    radicalDawg.build(radicalTrie);
+    terminationDawg.build(reversedTerminations);
+}
+
+
+// Returns the set of dictionaries whose verb form filter accepts the
+// word, or does not exist.  The word is hashed once for all of them.
+//
+unsigned
+MultiLanguageIndex::getCandidateDictionaries(const string &utf8ConjugatedVerb) const
+{
+    const BloomFilter::Hash h = BloomFilter::hash(utf8ConjugatedVerb);
+    unsigned candidates = 0;
+    for (size_t no = 0; no < dictionaries.size(); ++no)
+    {
+        const BloomFilter &filter = dictionaries[no]->getVerbFormFilter();
+        if (!filter.isBuilt() || filter.mayContain(h))
+            candidates |= 1u << no;
+    }
+    return candidates;
+}
+
+
+// Implements deconjugate() and findDictionaries() like
+// FrenchVerbDictionary::deconjugateSuffixFirst(), in all the candidate
+// dictionaries at once.  If 'results' is NULL, stops searching a
+// dictionary as soon as it accepts the word.
+// Returns the set of the dictionaries that accept the word.
+//
+unsigned
+MultiLanguageIndex::search(const string &utf8ConjugatedVerb,
+                           vector< vector<InflectionDesc> > *results) const
+{
+    unsigned candidates = getCandidateDictionaries(utf8ConjugatedVerb);
+    if (candidates == 0)
+        return 0;
+
+    DawgTerminations<TerminationValue> terminations(terminationDawg);
+    DawgRadicals<RadicalValue> radicals(radicalDawg);
+    SuffixAcceptor acceptor(*this, utf8ConjugatedVerb, candidates, results);
+    searchSuffixFirst(utf8ConjugatedVerb, terminations, radicals, acceptor);
+    return acceptor.getFound();
+}
+
+
+void
+MultiLanguageIndex::deconjugate(const string &utf8ConjugatedVerb,
+                                vector< vector<InflectionDesc> > &results) const
+{
+    if (results.size() < dictionaries.size())
+        results.resize(dictionaries.size());
+    (void) search(utf8ConjugatedVerb, &results);
+}
+
+
+unsigned
+MultiLanguageIndex::findDictionaries(const string &utf8ConjugatedVerb) const
+{
+    return search(utf8ConjugatedVerb, NULL);
+}
+
+
+size_t
+MultiLanguageIndex::computeMemoryConsumption() const
+{
+    return sizeof(*this)
+           + dictionaries.size() * sizeof(dictionaries[0])
+           + radicalDawg.computeMemoryConsumption()
+           + terminationDawg.computeMemoryConsumption();
+}
@@ -0,0 +1,190 @@
+/*  $Id$
+    MultiLanguageIndex.h - Deconjugation in several languages at once
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_MultiLanguageIndex
+#define _H_MultiLanguageIndex
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <stddef.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Index of the verb forms of several dictionaries, typically one
+    per language, which deconjugates a word in all of them in a single
+    search.
+
+    Searching each dictionary in turn walks the word through as many
+    pairs of automata (terminations and radicals).  This index merges
+    the terminations of all the dictionaries into one minimal automaton,
+    and their radicals into another, whose values are tagged with the
+    number of their dictionary, so that the word is walked once.
+    The verb form filter of each dictionary is checked first, with a
+    single hash of the word, to skip the languages in which it cannot
+    be a verb.
+
+    The dictionaries must outlive the index.  The index is a copy of
+    their radicals and terminations as they were at construction time: it must be
+    rebuilt after a dictionary is modified by addVerb() or
+    loadVerbOverlay().  It is never modified by the searches, so it
+    can be used by several threads at once.
+*/
+class MultiLanguageIndex
+{
+public:
+
+    /** Maximum number of dictionaries, so that a set of dictionaries
+        can be represented by the bits of an unsigned int.
+    */
+    enum { MAX_DICTIONARIES = 32 };
+
+    /** Builds the index of the given dictionaries.
+        @param  dictionaries    non-null pointers to the dictionaries,
+                                numbered from 0 in this order
+        @throws logic_error     if there are more than MAX_DICTIONARIES
+                                dictionaries
+    */
+    MultiLanguageIndex(const std::vector<const FrenchVerbDictionary *> &dictionaries)
+                                                    throw(std::logic_error);
+
+    /** Returns the number of dictionaries given to the constructor.
+    */
+    size_t getNumDictionaries() const { return dictionaries.size(); }
+
+    /** Returns the dictionary that has the given number.
+    */
+    const FrenchVerbDictionary &getDictionary(size_t dictionaryNo) const
+    {
+        return *dictionaries[dictionaryNo];
+    }
+
+    /** Analyzes a conjugated verb in all the dictionaries.
+        The results of each dictionary are the same, and in the same
+        order, as those of its deconjugate() method.
+        @param  utf8ConjugatedVerb  lowercase UTF-8 word to analyze
+        @param  results             vector of one vector per dictionary,
+                                    to which the analyses found in that
+                                    dictionary are appended; it is first
+                                    resized to getNumDictionaries() if
+                                    it is smaller
+    */
+    void deconjugate(const std::string &utf8ConjugatedVerb,
+                     std::vector< std::vector<InflectionDesc> > &results) const;
+
+    /** Determines in which dictionaries a word is a conjugated verb,
+        without producing the analyses, e.g., to identify the language
+        of a word.
+        @param  utf8ConjugatedVerb  lowercase UTF-8 word to analyze
+        @returns                    set of dictionary numbers: bit n is
+                                    set if the word is known to
+                                    dictionary n
+    */
+    unsigned findDictionaries(const std::string &utf8ConjugatedVerb) const;
+
+    /** Returns the number of states of the merged automata.
+    */
+    size_t getNumStates() const
+    {
+        return radicalDawg.getNumStates() + terminationDawg.getNumStates();
+    }
+
+    /** Returns the approximate number of bytes used by this index,
+        excluding the dictionaries.
+    */
+    size_t computeMemoryConsumption() const;
+
+private:
+
+    /** User data of the merged radical automaton: a value of the radical
+        index of a dictionary, tagged with the number of that dictionary.
+    */
+    class RadicalValue
+    {
+    public:
+        RadicalValue(unsigned no, const FrenchVerbDictionary::TrieValue &v)
+          : dictionaryNo(no), trieValue(v) {}
+
+        bool operator < (const RadicalValue &v) const
+        {
+            if (dictionaryNo != v.dictionaryNo)
+                return dictionaryNo < v.dictionaryNo;
+            return trieValue < v.trieValue;
+        }
+
+        unsigned dictionaryNo;
+        FrenchVerbDictionary::TrieValue trieValue;
+    };
+
+    /** User data of the merged termination automaton: a template that
+        accepts a termination, tagged with the number of its dictionary.
+        A list of these values is sorted by dictionary, then by template.
+    */
+    class TerminationValue
+    {
+    public:
+        TerminationValue(unsigned no, const FrenchVerbDictionary::TerminationValue &v)
+          : dictionaryNo(no), value(v) {}
+
+        bool operator < (const TerminationValue &v) const
+        {
+            if (dictionaryNo != v.dictionaryNo)
+                return dictionaryNo < v.dictionaryNo;
+            return value < v.value;
+        }
+
+        unsigned dictionaryNo;
+        FrenchVerbDictionary::TerminationValue value;
+    };
+
+    typedef Trie< std::vector<RadicalValue>, char > RadicalTrie;
+    typedef Dawg< std::vector<RadicalValue>, char > RadicalDawg;
+    typedef Dawg< std::vector<TerminationValue>, char > TerminationDawg;
+
+    class RadicalCopier;
+    class SuffixAcceptor;
+
+    friend class RadicalCopier;
+    friend class SuffixAcceptor;
+
+    unsigned getCandidateDictionaries(const std::string &utf8ConjugatedVerb) const;
+    unsigned search(const std::string &utf8ConjugatedVerb,
+                    std::vector< std::vector<InflectionDesc> > *results) const;
+
+    std::vector<const FrenchVerbDictionary *> dictionaries;
+    RadicalDawg radicalDawg;
+    TerminationDawg terminationDawg;  // reversed terminations
+
+    // Forbidden operations:
+    MultiLanguageIndex(const MultiLanguageIndex &);
+    MultiLanguageIndex &operator = (const MultiLanguageIndex &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_MultiLanguageIndex */
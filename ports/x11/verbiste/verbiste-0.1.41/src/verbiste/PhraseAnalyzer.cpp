@@ -0,0 +1,342 @@
+/*  $Id$
+    PhraseAnalyzer.cpp - Deconjugation of a verb with its pronouns and auxiliary
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "PhraseAnalyzer.h"
+
+#include "LanguagePolicies.h"
+
+#include <string.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+// Word of the analyzed text: designates bytes of the text.
+//
+struct PhraseToken
+{
+    const char *begin;
+    size_t length;
+};
+
+
+static bool
+isSeparator(unsigned char c)
+{
+    return c <= ' ' || (c < 0x80 && strchr(".,;:!?\"()[]", c) != NULL);
+}
+
+
+// Returns the length of the apostrophe at 'p', which is 1 for "'",
+// 3 for U+2019 and 0 if there is none.
+//
+static size_t
+getApostropheLength(const char *p, const char *end)
+{
+    if (*p == '\'')
+        return 1;
+    if (end - p >= 3 && memcmp(p, "\xE2\x80\x99", 3) == 0)
+        return 3;
+    return 0;
+}
+
+
+// Finds the word that starts at or after 'p' in a text that ends at 'end'.
+// A word ends at a space, at a punctuation mark, or after an apostrophe,
+// so that "qu'ils" is made of "qu'" and "ils".
+// Returns false if the text ends, or continues with a punctuation mark,
+// before the next word.
+//
+static bool
+getNextToken(const char *p, const char *end, PhraseToken &token)
+{
+    while (p != end && (unsigned char) *p <= ' ')
+        ++p;
+    if (p == end || isSeparator(*p) || getApostropheLength(p, end) != 0)
+        return false;
+
+    token.begin = p;
+    while (p != end && !isSeparator(*p))
+    {
+        size_t apostropheLength = getApostropheLength(p, end);
+        if (apostropheLength != 0)
+        {
+            p += apostropheLength;
+            break;
+        }
+        ++p;
+    }
+    token.length = p - token.begin;
+    return true;
+}
+
+
+static const char *
+getTokenEnd(const PhraseToken &token)
+{
+    return token.begin + token.length;
+}
+
+
+// Compares a word of the text with a word of a table, whose final
+// apostrophe, if any, also matches the typographic apostrophe.
+//
+static bool
+matches(const PhraseToken &token, const char *word)
+{
+    const char *p = token.begin, *end = getTokenEnd(token);
+    for ( ; *word != '\0'; ++word)
+    {
+        if (p == end)
+            return false;
+        if (*word == '\'')
+        {
+            size_t apostropheLength = getApostropheLength(p, end);
+            if (apostropheLength == 0)
+                return false;
+            p += apostropheLength;
+        }
+        else if (*p++ != *word)
+            return false;
+    }
+    return p == end;
+}
+
+
+// Returns the entry of 'words' that has the given role and matches
+// the token, or NULL.
+//
+static const PhraseWord *
+findWord(const PhraseWord *words, const PhraseToken &token, PhraseWordRole role)
+{
+    for ( ; words->word != NULL; ++words)
+        if (words->role == role && matches(token, words->word))
+            return words;
+    return NULL;
+}
+
+
+// Returns the bit of PhraseWord::persons that corresponds to a
+// finite verb form, or 0 if the form has no person.
+//
+static unsigned
+getPersonBit(const ModeTensePersonNumber &mtpn)
+{
+    if (mtpn.person < 1 || mtpn.person > 3)
+        return 0;
+    return 1u << ((mtpn.person - 1) + (mtpn.plural ? 3 : 0));
+}
+
+
+// Returns the tense of a compound form whose auxiliary has the given
+// tense, e.g., the passé composé for "j'ai aimé", whose auxiliary is
+// in the present.
+//
+static Tense
+getCompoundTense(Tense auxiliaryTense)
+{
+    switch (auxiliaryTense)
+    {
+        case PRESENT_TENSE:   return COMPOUND_PAST_TENSE;
+        case IMPERFECT_TENSE: return PLUPERFECT_TENSE;
+        case PAST_TENSE:      return PAST_ANTERIOR_TENSE;
+        case FUTURE_TENSE:    return FUTURE_ANTERIOR_TENSE;
+        default:              return auxiliaryTense;
+    }
+}
+
+
+PhraseAnalyzer::PhraseAnalyzer(const FrenchVerbDictionary &d)
+  : fvd(d),
+    words(NULL),
+    usesPronouns(NULL),
+    word(),
+    verbForms(),
+    participles()
+{
+    switch (fvd.getLanguage())
+    {
+        case FrenchVerbDictionary::ITALIAN:
+            words = ItalianPolicy::phraseWords;
+            usesPronouns = ItalianPolicy::usesPronouns;
+            break;
+        case FrenchVerbDictionary::GREEK:
+            words = GreekPolicy::phraseWords;
+            usesPronouns = GreekPolicy::usesPronouns;
+            break;
+        default:
+            words = FrenchPolicy::phraseWords;
+            usesPronouns = FrenchPolicy::usesPronouns;
+            break;
+    }
+}
+
+
+void
+PhraseAnalyzer::deconjugate(const char *utf8Word, size_t len,
+                            vector<InflectionDesc> &results)
+{
+    results.clear();
+    word.assign(utf8Word, len);  // reuses the buffer of the previous word
+    fvd.deconjugate(word, results);
+}
+
+
+bool
+PhraseAnalyzer::isAuxiliary(const string &infinitive) const
+{
+    for (const PhraseWord *w = words; w->word != NULL; ++w)
+        if (w->role == AUXILIARY_WORD && infinitive == w->word)
+            return true;
+    return false;
+}
+
+
+size_t
+PhraseAnalyzer::analyze(const char *utf8Text, size_t len,
+                        vector<PhraseDesc> &results)
+{
+    const char *end = utf8Text + len;
+    PhraseToken token;
+    if (!getNextToken(utf8Text, end, token))
+        return 0;
+
+    // Words before the verb.  Each one narrows the persons or the mode
+    // that the verb can have.
+    //
+    Mode subordinatorMode = INVALID_MODE;
+    unsigned persons = ~0u;
+    bool hasPronoun = false, reflexive = false;
+    const PhraseWord *w;
+
+    if ((w = findWord(words, token, SUBORDINATOR_WORD)) != NULL)
+    {
+        subordinatorMode = w->mode;
+        if (!getNextToken(getTokenEnd(token), end, token))
+            return 0;
+    }
+    if ((w = findWord(words, token, SUBJECT_WORD)) != NULL)
+    {
+        persons &= w->persons;
+        hasPronoun = true;
+        if (!getNextToken(getTokenEnd(token), end, token))
+            return 0;
+    }
+    for (;;)
+    {
+        if (!reflexive && (w = findWord(words, token, REFLEXIVE_WORD)) != NULL)
+        {
+            persons &= w->persons;
+            hasPronoun = reflexive = true;
+        }
+        else if (findWord(words, token, CLITIC_WORD) == NULL)
+            break;
+        if (!getNextToken(getTokenEnd(token), end, token))
+            return 0;
+    }
+
+    // The conjugated verb, which must agree with the pronouns, and be
+    // in the mode of the subordinator if it can.
+    //
+    deconjugate(token.begin, token.length, verbForms);
+    size_t numForms = 0;
+    bool hasSubordinatorMode = false;
+    for (vector<InflectionDesc>::const_iterator it = verbForms.begin();
+                                                it != verbForms.end(); ++it)
+    {
+        const ModeTensePersonNumber &mtpn = it->mtpn;
+        if (hasPronoun
+                && (!usesPronouns(mtpn.mode) || (getPersonBit(mtpn) & persons) == 0))
+            continue;
+        verbForms[numForms++] = *it;
+        hasSubordinatorMode = hasSubordinatorMode || mtpn.mode == subordinatorMode;
+    }
+    verbForms.resize(numForms);
+
+    numForms = 0;
+    bool hasAuxiliary = false;
+    for (vector<InflectionDesc>::const_iterator it = verbForms.begin();
+                                                it != verbForms.end(); ++it)
+    {
+        if (hasSubordinatorMode && it->mtpn.mode != subordinatorMode)
+            continue;
+        verbForms[numForms++] = *it;
+        hasAuxiliary = hasAuxiliary || isAuxiliary(it->infinitive);
+    }
+    verbForms.resize(numForms);
+
+    if (verbForms.empty())
+        return 0;
+    const char *phraseEnd = getTokenEnd(token);
+
+    // An auxiliary followed by a past participle, possibly with adverbs
+    // in between, forms a compound form.  The other forms of the
+    // conjugated verb are then excluded.
+    //
+    participles.clear();
+    if (hasAuxiliary)
+    {
+        bool hasNextToken;
+        while ((hasNextToken = getNextToken(getTokenEnd(token), end, token))
+                    && findWord(words, token, ADVERB_WORD) != NULL)
+            ;
+        if (hasNextToken)
+        {
+            deconjugate(token.begin, token.length, participles);
+            numForms = 0;
+            for (vector<InflectionDesc>::const_iterator it = participles.begin();
+                                                        it != participles.end(); ++it)
+                if (it->mtpn.mode == PARTICIPLE_MODE && it->mtpn.tense == PAST_TENSE)
+                    participles[numForms++] = *it;
+            participles.resize(numForms);
+        }
+    }
+
+    for (vector<InflectionDesc>::const_iterator it = verbForms.begin();
+                                                it != verbForms.end(); ++it)
+    {
+        if (participles.empty())
+        {
+            results.push_back(PhraseDesc());
+            results.back().verb = *it;
+            results.back().reflexive = reflexive;
+            results.back().mtpn = it->mtpn;
+        }
+        else if (isAuxiliary(it->infinitive))
+        {
+            for (vector<InflectionDesc>::const_iterator jt = participles.begin();
+                                                        jt != participles.end(); ++jt)
+            {
+                results.push_back(PhraseDesc());
+                results.back().verb = *jt;
+                results.back().auxiliary = *it;
+                results.back().reflexive = reflexive;
+                results.back().mtpn = it->mtpn;
+                results.back().mtpn.tense = getCompoundTense(it->mtpn.tense);
+            }
+        }
+    }
+
+    if (!participles.empty())
+        phraseEnd = getTokenEnd(token);
+    return phraseEnd - utf8Text;
+}
@@ -0,0 +1,153 @@
+/*  $Id$
+    PhraseAnalyzer.h - Deconjugation of a verb with its pronouns and auxiliary
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_PhraseAnalyzer
+#define _H_PhraseAnalyzer
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+struct PhraseWord;
+
+
+/** Description of a conjugated verb found by PhraseAnalyzer, with
+    its subordinator, pronouns and auxiliary taken into account.
+*/
+class PhraseDesc
+{
+public:
+
+    /** Main verb.  In a compound form (e.g., "tu es allé"), its
+        inflection is the past participle.
+    */
+    InflectionDesc verb;
+
+    /** Auxiliary of a compound form (e.g., "être" in "tu es allé").
+        Its infinitive is empty in a simple form (e.g., "tu vas").
+    */
+    InflectionDesc auxiliary;
+
+    /** Indicates if the phrase contains a reflexive pronoun
+        (e.g., "je me suis levé").
+    */
+    bool reflexive;
+
+    /** Mode, tense, person and number of the phrase.
+        In a simple form, these are those of the verb.  In a compound
+        form, the mode, person and number are those of the auxiliary,
+        and the tense is the compound tense formed with the tense of
+        the auxiliary: e.g., COMPOUND_PAST_TENSE (French passé composé)
+        with an auxiliary in the present, PLUPERFECT_TENSE with an
+        auxiliary in the imperfect.
+    */
+    ModeTensePersonNumber mtpn;
+
+    PhraseDesc() : verb(), auxiliary(), reflexive(false), mtpn() {}
+
+    /** Indicates if the phrase is a compound form. */
+    bool isCompound() const { return !auxiliary.infinitive.empty(); }
+
+    /** Returns the mode, tense, person and number of the phrase.
+    */
+    const ModeTensePersonNumber &getModeTensePersonNumber() const
+    {
+        return mtpn;
+    }
+};
+
+
+/** Deconjugates a verb preceded by its subordinator, subject pronoun,
+    reflexive and object pronouns, and a compound form made of an
+    auxiliary and a past participle, e.g., "qu'ils aient", "tu es allé",
+    "je ne me suis pas levé" or "che io abbia".
+
+    The words that can accompany a verb come from a table for each
+    language.  The subject and reflexive pronouns select the persons
+    of the verb, and the subordinator its mode when possible
+    (e.g., the subjunctive after "que").
+
+    The text is read once, from left to right.  Only the verb and the
+    participle are copied, into a buffer that is reused by each call.
+    An analyzer must thus not be used by several threads at once.
+    The text must be in lowercase UTF-8, like the words passed to
+    FrenchVerbDictionary::deconjugate().
+*/
+class PhraseAnalyzer
+{
+public:
+
+    /** Creates an analyzer that uses the given dictionary.
+        The dictionary must outlive the analyzer.
+    */
+    PhraseAnalyzer(const FrenchVerbDictionary &d);
+
+    /** Analyzes the phrase at the start of a text.
+        The text may continue after the phrase, e.g., "tu es allé à Rome".
+        @param  utf8Text        text to analyze
+        @param  len             length of the text in bytes
+        @param  results         vector to which the descriptions of the
+                                phrase are appended, one for each
+                                possible analysis
+        @returns                the length in bytes of the phrase, from
+                                the start of the text to the end of the
+                                verb or participle, or 0 if the text does
+                                not start with a conjugated verb
+    */
+    size_t analyze(const char *utf8Text, size_t len,
+                   std::vector<PhraseDesc> &results);
+
+    /** Analyzes the phrase at the start of a string.
+    */
+    size_t analyze(const std::string &utf8Text, std::vector<PhraseDesc> &results)
+    {
+        return analyze(utf8Text.data(), utf8Text.length(), results);
+    }
+
+private:
+
+    void deconjugate(const char *utf8Word, size_t len,
+                     std::vector<InflectionDesc> &results);
+    bool isAuxiliary(const std::string &infinitive) const;
+
+    const FrenchVerbDictionary &fvd;
+    const PhraseWord *words;  // table of the dictionary's language
+    bool (*usesPronouns)(Mode mode);
+    std::string word;  // copy of the token being deconjugated
+    std::vector<InflectionDesc> verbForms, participles;
+
+    // Forbidden operations:
+    PhraseAnalyzer(const PhraseAnalyzer &);
+    PhraseAnalyzer &operator = (const PhraseAnalyzer &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_PhraseAnalyzer */
@@ -0,0 +1,115 @@
+/*  $Id$
+    RefCounted.h - Intrusive reference count for objects shared by handles
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_RefCounted
+#define _H_RefCounted
+
+#include <stddef.h>
+
+
+namespace verbiste {
+
+
+/** Base of an object of class T that is destroyed when the last reference
+    to it is released.  The object is created with one reference.
+
+    ConjugationCache and DictionaryHolder give out handles to such objects.
+    The count is modified atomically because handles may be copied and
+    destroyed in different threads without holding the mutex of the object
+    that gave them out.
+
+    T must make its destructor private and befriend RefCounted<T>,
+    so that only release() destroys it.
+    This header is internal to the library and is not installed.
+*/
+template <class T>
+class RefCounted
+{
+public:
+
+    /** Adds a reference. */
+    void addRef()
+    {
+        (void) __sync_add_and_fetch(&refCount, 1);
+    }
+
+    /** Releases a reference, and destroys the object if it was the last. */
+    void release()
+    {
+        if (__sync_sub_and_fetch(&refCount, 1) == 0)
+            delete static_cast<T *>(this);
+    }
+
+protected:
+
+    RefCounted() : refCount(1) {}
+
+    ~RefCounted() {}
+
+private:
+
+    int refCount;
+
+    // Forbidden operations:
+    RefCounted(const RefCounted &);
+    RefCounted &operator = (const RefCounted &);
+};
+
+
+/** Adds a reference to the object designated by 'p', if not NULL. */
+template <class T>
+inline void
+addRef(T *p)
+{
+    if (p != NULL)
+        p->addRef();
+}
+
+
+/** Releases a reference to the object designated by 'p', if not NULL. */
+template <class T>
+inline void
+release(T *p)
+{
+    if (p != NULL)
+        p->release();
+}
+
+
+/** Makes 'dest' designate the object designated by 'src', moving
+    a reference from the former object of 'dest' to that of 'src'.
+    Either pointer can be NULL.
+*/
+template <class T>
+inline void
+assignRef(T *&dest, T *src)
+{
+    addRef(src);  // first, in case of self-assignment
+    release(dest);
+    dest = src;
+}
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_RefCounted */
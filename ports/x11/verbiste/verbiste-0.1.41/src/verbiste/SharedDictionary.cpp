@@ -0,0 +1,1182 @@
+/*  $Id$
+    SharedDictionary.cpp - Deconjugation index shared by several processes
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "SharedDictionary.h"
+#include "SuffixSearch.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <map>
+
+using namespace std;
+using namespace verbiste;
+
+
+// Sections of an image, in the order in which they are stored.
+//
+enum
+{
+    ARENA,                   // char: template names and correct radicals
+    TEMPLATE_NAMES,          // StringRef, sorted by name
+    RADICAL_STATES,          // State
+    RADICAL_TRANSITIONS,     // Transition
+    RADICAL_VALUE_LISTS,     // ValueList in RADICAL_VALUES
+    RADICAL_VALUES,          // RadicalValue
+    TERMINATION_STATES,      // State
+    TERMINATION_TRANSITIONS, // Transition
+    TERMINATION_VALUE_LISTS, // ValueList in TERMINATION_VALUES
+    TERMINATION_VALUES,      // TerminationValue, sorted by template
+    SLOTS,                   // PackedModeTensePersonNumber
+    SLOT_SET_WORDS,          // unsigned: wordsPerSlotSet words per set
+    FILTER_WORDS,            // BloomFilter::Hash, none if no filter
+    RANKED_VERBS,            // RankedVerb, sorted by infinitive
+    NUM_SECTIONS
+};
+
+static const char IMAGE_MAGIC[8] = { 'v', 'e', 'r', 'b', 'i', 's', 't', 'e' };
+static const unsigned BYTE_ORDER_MARK = 0x01020304;
+static const unsigned NO_VALUE = ~0u;
+
+// An incomplete image that is older than this number of seconds was
+// left by a process that failed to finish it.
+//
+static const time_t BUILD_TIMEOUT = 60;
+
+
+struct SharedDictionary::Section
+{
+    unsigned offset;  // in bytes, from the start of the image
+    unsigned count;   // number of elements
+};
+
+
+struct SharedDictionary::Header
+{
+    char magic[8];                  // IMAGE_MAGIC
+    unsigned formatVersion;         // FORMAT_VERSION
+    unsigned byteOrder;             // BYTE_ORDER_MARK in the creator's order
+    char libraryVersion[16];        // VERSION, null-terminated
+    unsigned language;              // FrenchVerbDictionary::Language
+    unsigned includeWithoutAccents;
+    Stamp sourceStamp;              // see computeSourceStamp(); 0 if private
+    unsigned imageSize;             // in bytes
+    unsigned creatorPid;
+    unsigned complete;              // set last, once the image is written
+    unsigned wordsPerSlotSet;
+    unsigned radicalInitialState;
+    unsigned terminationInitialState;
+    Section sections[NUM_SECTIONS];
+};
+
+
+// Same meaning as in Dawg.
+//
+struct SharedDictionary::State
+{
+    unsigned firstTransition;
+    unsigned numTransitions;  // sorted by label
+    unsigned valueIndex;  // in the value lists, or NO_VALUE
+};
+
+
+struct SharedDictionary::Transition
+{
+    int label;  // a char, so that the transitions keep the order of Dawg
+    unsigned target;
+};
+
+
+struct SharedDictionary::ValueList
+{
+    unsigned first;
+    unsigned count;
+};
+
+
+// The template numbers are the ranks of the names in TEMPLATE_NAMES,
+// so they compare like the names.
+//
+struct SharedDictionary::RadicalValue
+{
+    unsigned templateNo;
+    unsigned correctRadicalOffset;  // in ARENA
+    unsigned correctRadicalLength;  // 0 if the radical is correct
+};
+
+
+struct SharedDictionary::TerminationValue
+{
+    unsigned templateNo;
+    unsigned slotSet;
+};
+
+
+// Designates a string of the arena.
+//
+struct StringRef
+{
+    unsigned offset;
+    unsigned length;
+};
+
+
+// Frequency rank of a verb, as given by
+// FrenchVerbDictionary::getFrequencyRank().
+//
+struct RankedVerb
+{
+    StringRef infinitive;
+    unsigned rank;
+};
+
+
+static const size_t sectionElementSizes[NUM_SECTIONS] =
+{
+    sizeof(char),
+    sizeof(StringRef),
+    sizeof(unsigned) * 3,  // State
+    sizeof(unsigned) * 2,  // Transition
+    sizeof(unsigned) * 2,  // ValueList
+    sizeof(unsigned) * 3,  // RadicalValue
+    sizeof(unsigned) * 3,  // State
+    sizeof(unsigned) * 2,  // Transition
+    sizeof(unsigned) * 2,  // ValueList
+    sizeof(unsigned) * 2,  // TerminationValue
+    sizeof(PackedModeTensePersonNumber),
+    sizeof(unsigned),
+    sizeof(BloomFilter::Hash),
+    sizeof(unsigned) * 3   // RankedVerb
+};
+
+
+// A name that starts with '/' and contains no other '/' designates
+// a POSIX shared memory object; any other name designates a file.
+//
+static bool
+isSharedMemoryName(const string &name)
+{
+    return !name.empty() && name[0] == '/' && name.find('/', 1) == string::npos;
+}
+
+
+static int
+openObject(const string &name, int flags, mode_t mode)
+{
+    if (isSharedMemoryName(name))
+        return shm_open(name.c_str(), flags, mode);
+    return ::open(name.c_str(), flags, mode);
+}
+
+
+// Indicates if the process that created an image may still be writing it.
+//
+static bool
+isCreatorAlive(unsigned pid, time_t modificationTime)
+{
+    if (time(NULL) - modificationTime > BUILD_TIMEOUT)
+        return false;
+    return pid == 0 || kill(pid_t(pid), 0) == 0 || errno == EPERM;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+
+// Converts a dictionary into the sections of an image, then lays them
+// out in a buffer.
+//
+class SharedDictionary::ImageBuilder
+{
+public:
+
+    ImageBuilder(const FrenchVerbDictionary &_fvd)
+      : fvd(_fvd),
+        arena(),
+        templateNames(),
+        templateNos(),
+        radicalStates(),
+        radicalTransitions(),
+        radicalValueLists(),
+        radicalValues(),
+        terminationStates(),
+        terminationTransitions(),
+        terminationValueLists(),
+        terminationValues(),
+        slots(),
+        slotSetWords(),
+        rankedVerbs(),
+        radicalInitialState(0),
+        terminationInitialState(0)
+    {
+    }
+
+    void build(vector<unsigned long long> &buffer);
+
+private:
+
+    unsigned addString(const string &s);
+    void numberTemplates(const FrenchVerbDictionary::VerbDawg &verbDawg);
+    template <class T>
+    static void copyAutomaton(const Dawg<T, char> &dawg,
+                              vector<State> &states,
+                              vector<Transition> &transitions,
+                              unsigned &initialState);
+    template <class T>
+    static void appendSection(vector<unsigned long long> &buffer,
+                              Section &section,
+                              const vector<T> &elements);
+    static void appendSection(vector<unsigned long long> &buffer,
+                              Section &section,
+                              const void *elements,
+                              size_t count, size_t elementSize);
+
+    const FrenchVerbDictionary &fvd;
+    string arena;
+    vector<StringRef> templateNames;
+    map<string, unsigned> templateNos;
+    vector<State> radicalStates;
+    vector<Transition> radicalTransitions;
+    vector<ValueList> radicalValueLists;
+    vector<RadicalValue> radicalValues;
+    vector<State> terminationStates;
+    vector<Transition> terminationTransitions;
+    vector<ValueList> terminationValueLists;
+    vector<TerminationValue> terminationValues;
+    vector<PackedModeTensePersonNumber> slots;
+    vector<unsigned> slotSetWords;
+    vector<RankedVerb> rankedVerbs;
+    unsigned radicalInitialState;
+    unsigned terminationInitialState;
+
+    // Forbidden operations:
+    ImageBuilder(const ImageBuilder &);
+    ImageBuilder &operator = (const ImageBuilder &);
+};
+
+
+unsigned
+SharedDictionary::ImageBuilder::addString(const string &s)
+{
+    unsigned offset = unsigned(arena.length());
+    arena.append(s.c_str(), s.length() + 1);
+    return offset;
+}
+
+
+// Numbers the templates of both automata in alphabetical order, so
+// that the termination lists, sorted by template name, are also sorted
+// by template number.
+//
+void
+SharedDictionary::ImageBuilder::numberTemplates(
+                            const FrenchVerbDictionary::VerbDawg &verbDawg)
+{
+    for (vector< vector<FrenchVerbDictionary::TerminationValue> >::const_iterator it =
+                fvd.terminationDawg.values.begin(); it != fvd.terminationDawg.values.end(); ++it)
+        for (size_t i = 0; i < it->size(); ++i)
+            templateNos[*(*it)[i].templateName] = 0;
+    for (vector< vector<FrenchVerbDictionary::TrieValue> >::const_iterator it =
+                verbDawg.values.begin(); it != verbDawg.values.end(); ++it)
+        for (size_t i = 0; i < it->size(); ++i)
+            templateNos[*(*it)[i].templateName] = 0;
+
+    for (map<string, unsigned>::iterator it = templateNos.begin(); it != templateNos.end(); ++it)
+    {
+        it->second = unsigned(templateNames.size());
+        StringRef ref;
+        ref.offset = addString(it->first);
+        ref.length = unsigned(it->first.length());
+        templateNames.push_back(ref);
+    }
+}
+
+
+template <class T>
+void
+SharedDictionary::ImageBuilder::copyAutomaton(const Dawg<T, char> &dawg,
+                                             vector<State> &states,
+                                             vector<Transition> &transitions,
+                                             unsigned &initialState)
+{
+    states.reserve(dawg.states.size());
+    for (size_t i = 0; i < dawg.states.size(); ++i)
+    {
+        State s;
+        s.firstTransition = dawg.states[i].firstTransition;
+        s.numTransitions = dawg.states[i].numTransitions;
+        s.valueIndex = dawg.states[i].valueIndex;
+        states.push_back(s);
+    }
+    transitions.reserve(dawg.transitions.size());
+    for (size_t i = 0; i < dawg.transitions.size(); ++i)
+    {
+        Transition t;
+        t.label = dawg.transitions[i].label;
+        t.target = dawg.transitions[i].target;
+        transitions.push_back(t);
+    }
+    initialState = dawg.initialState;
+}
+
+
+void
+SharedDictionary::ImageBuilder::build(vector<unsigned long long> &buffer)
+{
+    // The verb automaton is missing after FrenchVerbDictionary::addVerb()
+    // until rebuildVerbIndex().
+    //
+    FrenchVerbDictionary::VerbDawg rebuiltVerbDawg;
+    const FrenchVerbDictionary::VerbDawg *verbDawg = &fvd.verbDawg;
+    if (!verbDawg->isBuilt())
+    {
+        rebuiltVerbDawg.build(fvd.verbTrie);
+        verbDawg = &rebuiltVerbDawg;
+    }
+
+    numberTemplates(*verbDawg);
+
+    copyAutomaton(*verbDawg, radicalStates, radicalTransitions, radicalInitialState);
+    for (size_t i = 0; i < verbDawg->values.size(); ++i)
+    {
+        const vector<FrenchVerbDictionary::TrieValue> &list = verbDawg->values[i];
+        ValueList vl = { unsigned(radicalValues.size()), unsigned(list.size()) };
+        radicalValueLists.push_back(vl);
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            RadicalValue v;
+            v.templateNo = templateNos[*list[j].templateName];
+            v.correctRadicalLength = unsigned(list[j].correctVerbRadical.length());
+            v.correctRadicalOffset = (v.correctRadicalLength == 0
+                                      ? 0 : addString(list[j].correctVerbRadical));
+            radicalValues.push_back(v);
+        }
+    }
+
+    const FrenchVerbDictionary::TerminationDawg &terminationDawg = fvd.terminationDawg;
+    copyAutomaton(terminationDawg, terminationStates, terminationTransitions,
+                  terminationInitialState);
+    for (size_t i = 0; i < terminationDawg.values.size(); ++i)
+    {
+        const vector<FrenchVerbDictionary::TerminationValue> &list = terminationDawg.values[i];
+        ValueList vl = { unsigned(terminationValues.size()), unsigned(list.size()) };
+        terminationValueLists.push_back(vl);
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            TerminationValue v;
+            v.templateNo = templateNos[*list[j].templateName];
+            v.slotSet = list[j].slotSet;
+            terminationValues.push_back(v);
+        }
+    }
+
+    const InflectionSlotTable &slotTable = fvd.slotTable;
+    for (unsigned i = 0; i < slotTable.getNumSlots(); ++i)
+        slots.push_back(PackedModeTensePersonNumber(slotTable.getSlot(i)));
+    for (unsigned i = 0; i < slotTable.getNumSets(); ++i)
+        slotSetWords.insert(slotSetWords.end(), slotTable.getSetWords(i),
+                            slotTable.getSetWords(i) + slotTable.getNumWordsPerSet());
+
+    // The infinitives are few: they are stored in the arena, in the
+    // order of the map.
+    //
+    vector<string> infinitives;
+    fvd.getMostFrequentVerbs(fvd.knownVerbs.getNumRankedVerbs(), infinitives);
+    map<string, unsigned> ranks;
+    for (vector<string>::const_iterator it = infinitives.begin(); it != infinitives.end(); ++it)
+        ranks[*it] = fvd.getFrequencyRank(*it);
+    for (map<string, unsigned>::const_iterator it = ranks.begin(); it != ranks.end(); ++it)
+    {
+        RankedVerb rv;
+        rv.infinitive.offset = addString(it->first);
+        rv.infinitive.length = unsigned(it->first.length());
+        rv.rank = it->second;
+        rankedVerbs.push_back(rv);
+    }
+
+    // Lay out the header, then the sections, each on an 8-byte boundary.
+    //
+    buffer.assign((sizeof(Header) + 7) / 8, 0);
+    Header header;
+    memset(&header, 0, sizeof(header));
+    Section *sections = header.sections;
+    appendSection(buffer, sections[ARENA], arena.data(), arena.length(), 1);
+    appendSection(buffer, sections[TEMPLATE_NAMES], templateNames);
+    appendSection(buffer, sections[RADICAL_STATES], radicalStates);
+    appendSection(buffer, sections[RADICAL_TRANSITIONS], radicalTransitions);
+    appendSection(buffer, sections[RADICAL_VALUE_LISTS], radicalValueLists);
+    appendSection(buffer, sections[RADICAL_VALUES], radicalValues);
+    appendSection(buffer, sections[TERMINATION_STATES], terminationStates);
+    appendSection(buffer, sections[TERMINATION_TRANSITIONS], terminationTransitions);
+    appendSection(buffer, sections[TERMINATION_VALUE_LISTS], terminationValueLists);
+    appendSection(buffer, sections[TERMINATION_VALUES], terminationValues);
+    appendSection(buffer, sections[SLOTS], slots);
+    appendSection(buffer, sections[SLOT_SET_WORDS], slotSetWords);
+    const BloomFilter &filter = fvd.verbFormFilter;
+    if (filter.isBuilt())
+        appendSection(buffer, sections[FILTER_WORDS], filter.getWords(),
+                      filter.getNumWords(), sizeof(BloomFilter::Hash));
+    else
+        appendSection(buffer, sections[FILTER_WORDS], NULL, 0, sizeof(BloomFilter::Hash));
+    appendSection(buffer, sections[RANKED_VERBS], rankedVerbs);
+
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(header.magic));
+    header.formatVersion = FORMAT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    strncpy(header.libraryVersion, VERSION, sizeof(header.libraryVersion) - 1);
+    header.language = unsigned(fvd.getLanguage());
+    header.includeWithoutAccents = fvd.withoutAccents;
+    header.sourceStamp = 0;
+    header.imageSize = unsigned(buffer.size() * 8);
+    header.creatorPid = 0;
+    header.complete = 1;
+    header.wordsPerSlotSet = unsigned(slotTable.getNumWordsPerSet());
+    header.radicalInitialState = radicalInitialState;
+    header.terminationInitialState = terminationInitialState;
+    memcpy(&buffer[0], &header, sizeof(header));
+}
+
+
+template <class T>
+void
+SharedDictionary::ImageBuilder::appendSection(vector<unsigned long long> &buffer,
+                                             Section &section,
+                                             const vector<T> &elements)
+{
+    appendSection(buffer, section, elements.empty() ? NULL : &elements[0],
+                  elements.size(), sizeof(T));
+}
+
+
+void
+SharedDictionary::ImageBuilder::appendSection(vector<unsigned long long> &buffer,
+                                             Section &section,
+                                             const void *elements,
+                                             size_t count, size_t elementSize)
+{
+    size_t numBytes = count * elementSize;
+    section.offset = unsigned(buffer.size() * 8);
+    section.count = unsigned(count);
+    buffer.resize(buffer.size() + (numBytes + 7) / 8, 0);
+    if (numBytes != 0)
+        memcpy(reinterpret_cast<char *>(&buffer[0]) + section.offset, elements, numBytes);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+
+SharedDictionary::SharedDictionary(const FrenchVerbDictionary &fvd)
+  : image(NULL),
+    size(0),
+    origin(PRIVATE),
+    buffer()
+{
+    ImageBuilder builder(fvd);
+    builder.build(buffer);
+    image = &buffer[0];
+    size = buffer.size() * 8;
+}
+
+
+SharedDictionary::SharedDictionary(const void *_image, size_t _size, Origin _origin)
+  : image(_image),
+    size(_size),
+    origin(_origin),
+    buffer()
+{
+}
+
+
+SharedDictionary::~SharedDictionary()
+{
+    if (origin != PRIVATE)
+        (void) munmap(const_cast<void *>(image), size);
+}
+
+
+//static
+string
+SharedDictionary::getDefaultName(FrenchVerbDictionary::Language lang,
+                                 bool includeWithoutAccents)
+{
+    const char *name = getenv("VERBISTE_SHARED_NAME");
+    if (name != NULL && name[0] != '\0')
+        return name;
+
+    char uid[32];
+    snprintf(uid, sizeof(uid), "%lu", (unsigned long) getuid());
+    return string("/verbiste-") + VERSION + "-"
+           + FrenchVerbDictionary::getLanguageCode(lang)
+           + (includeWithoutAccents ? "-accents-" : "-")
+           + uid;
+}
+
+
+// Hashes the names, sizes and modification times of the files from
+// which the dictionary is loaded, so that an image built from other
+// files, or before they were modified, is stale.
+//
+//static
+SharedDictionary::Stamp
+SharedDictionary::computeSourceStamp(const string &conjugationFilename,
+                                     const string &verbsFilename,
+                                     bool includeWithoutAccents,
+                                     FrenchVerbDictionary::Language lang)
+{
+    vector<string> filenames;
+    filenames.push_back(conjugationFilename);
+    filenames.push_back(verbsFilename);
+    const char *home = getenv("HOME");  // see FrenchVerbDictionary::init()
+    if (home != NULL)
+        filenames.push_back(string(home) + "/.verbiste/verbs-"
+                            + FrenchVerbDictionary::getLanguageCode(lang) + ".xml");
+    string::size_type slash = verbsFilename.rfind('/');
+    filenames.push_back((slash == string::npos ? string() : verbsFilename.substr(0, slash + 1))
+                        + "verb-frequencies-" + FrenchVerbDictionary::getLanguageCode(lang) + ".txt");
+
+    unsigned long long fields[3] = { (unsigned long long) lang, includeWithoutAccents, 0 };
+    Stamp h = BloomFilter::continueHash(BloomFilter::beginHash(),
+                                        (const char *) fields, sizeof(fields));
+    for (vector<string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+    {
+        h = BloomFilter::continueHash(h, it->c_str(), it->length() + 1);
+        struct stat statbuf;
+        if (stat(it->c_str(), &statbuf) != 0)
+            continue;
+        fields[0] = (unsigned long long) statbuf.st_size;
+        fields[1] = (unsigned long long) statbuf.st_mtime;
+        fields[2] = (unsigned long long) statbuf.st_ino;
+        h = BloomFilter::continueHash(h, (const char *) fields, sizeof(fields));
+    }
+    return h != 0 ? h : 1;  // 0 designates a private image
+}
+
+
+// Indicates if the image of the given size can be used by this
+// process, is being written by another one, or must be replaced.
+//
+//static
+SharedDictionary::Status
+SharedDictionary::checkImage(const void *image, size_t size,
+                             Stamp stamp, time_t modificationTime)
+{
+    // An image is filled with zeroes before it is written.
+    //
+    const Header &h = *static_cast<const Header *>(image);
+    if (size < sizeof(Header) || h.magic[0] == '\0')
+        return isCreatorAlive(0, modificationTime) ? BUSY : STALE;
+
+    if (memcmp(h.magic, IMAGE_MAGIC, sizeof(h.magic)) != 0
+            || h.formatVersion != FORMAT_VERSION
+            || h.byteOrder != BYTE_ORDER_MARK
+            || strncmp(h.libraryVersion, VERSION, sizeof(h.libraryVersion)) != 0)
+        return STALE;
+
+    if (!h.complete)
+        return isCreatorAlive(h.creatorPid, modificationTime) ? BUSY : STALE;
+
+    if (h.imageSize != size || h.sourceStamp != stamp)
+        return STALE;
+
+    for (size_t i = 0; i < NUM_SECTIONS; ++i)
+    {
+        const Section &s = h.sections[i];
+        if (s.offset % 8 != 0
+                || s.offset < sizeof(Header)
+                || s.offset > size
+                || s.count > (size - s.offset) / sectionElementSizes[i])
+            return STALE;
+    }
+
+    // deconjugate() divides the slot set words into sets of
+    // wordsPerSlotSet words, and the filter words into blocks.
+    //
+    const unsigned numSlotSetWords = h.sections[SLOT_SET_WORDS].count;
+    if (h.wordsPerSlotSet == 0 ? numSlotSetWords != 0
+                               : numSlotSetWords % h.wordsPerSlotSet != 0)
+        return STALE;
+    if (h.sections[FILTER_WORDS].count % BloomFilter::WORDS_PER_BLOCK != 0)
+        return STALE;
+
+    return checkIndices(h) ? VALID : STALE;
+}
+
+
+// Indicates if 'count' elements starting at 'first' fit in 'limit'.
+//
+static bool
+isRangeValid(unsigned first, unsigned count, unsigned limit)
+{
+    return first <= limit && count <= limit - first;
+}
+
+
+// Checks that the states and transitions of an automaton only refer to
+// elements that exist.  An empty automaton has no initial state.
+//
+//static
+bool
+SharedDictionary::checkAutomaton(const Header &header,
+                                 unsigned statesSection,
+                                 unsigned transitionsSection,
+                                 unsigned valueListsSection,
+                                 unsigned initialState)
+{
+    const char *image = reinterpret_cast<const char *>(&header);
+    const Section &stateSection = header.sections[statesSection];
+    const Section &transitionSection = header.sections[transitionsSection];
+    const unsigned numValueLists = header.sections[valueListsSection].count;
+
+    if (stateSection.count != 0 && initialState >= stateSection.count)
+        return false;
+
+    const State *states = reinterpret_cast<const State *>(image + stateSection.offset);
+    for (unsigned i = 0; i < stateSection.count; ++i)
+        if (!isRangeValid(states[i].firstTransition, states[i].numTransitions,
+                          transitionSection.count)
+                || (states[i].valueIndex != NO_VALUE
+                    && states[i].valueIndex >= numValueLists))
+            return false;
+
+    const Transition *transitions =
+            reinterpret_cast<const Transition *>(image + transitionSection.offset);
+    for (unsigned i = 0; i < transitionSection.count; ++i)
+        if (transitions[i].target >= stateSection.count)
+            return false;
+    return true;
+}
+
+
+// Checks that every index stored in the sections of an image designates
+// an element that exists, so that deconjugate() needs no checks.  This
+// is done once, when an image is attached.
+//
+//static
+bool
+SharedDictionary::checkIndices(const Header &header)
+{
+    const char *image = reinterpret_cast<const char *>(&header);
+    const Section *sections = header.sections;
+    const unsigned arenaLength = sections[ARENA].count;
+    const unsigned numTemplates = sections[TEMPLATE_NAMES].count;
+
+    if (!checkAutomaton(header, RADICAL_STATES, RADICAL_TRANSITIONS,
+                        RADICAL_VALUE_LISTS, header.radicalInitialState)
+            || !checkAutomaton(header, TERMINATION_STATES, TERMINATION_TRANSITIONS,
+                               TERMINATION_VALUE_LISTS, header.terminationInitialState))
+        return false;
+
+    const StringRef *templateNames =
+            reinterpret_cast<const StringRef *>(image + sections[TEMPLATE_NAMES].offset);
+    for (unsigned i = 0; i < numTemplates; ++i)
+        if (!isRangeValid(templateNames[i].offset, templateNames[i].length, arenaLength))
+            return false;
+
+    const ValueList *radValueLists =
+            reinterpret_cast<const ValueList *>(image + sections[RADICAL_VALUE_LISTS].offset);
+    for (unsigned i = 0; i < sections[RADICAL_VALUE_LISTS].count; ++i)
+        if (!isRangeValid(radValueLists[i].first, radValueLists[i].count,
+                          sections[RADICAL_VALUES].count))
+            return false;
+
+    const RadicalValue *radValues =
+            reinterpret_cast<const RadicalValue *>(image + sections[RADICAL_VALUES].offset);
+    for (unsigned i = 0; i < sections[RADICAL_VALUES].count; ++i)
+        if (radValues[i].templateNo >= numTemplates
+                || !isRangeValid(radValues[i].correctRadicalOffset,
+                                 radValues[i].correctRadicalLength, arenaLength))
+            return false;
+
+    const ValueList *termValueLists =
+            reinterpret_cast<const ValueList *>(image + sections[TERMINATION_VALUE_LISTS].offset);
+    for (unsigned i = 0; i < sections[TERMINATION_VALUE_LISTS].count; ++i)
+        if (!isRangeValid(termValueLists[i].first, termValueLists[i].count,
+                          sections[TERMINATION_VALUES].count))
+            return false;
+
+    // The slot sets are groups of wordsPerSlotSet words, whose bits
+    // designate slots.
+    //
+    const unsigned numSlotSetWords = sections[SLOT_SET_WORDS].count;
+    const unsigned numSlotSets = (header.wordsPerSlotSet == 0
+                                  ? 0 : numSlotSetWords / header.wordsPerSlotSet);
+    const TerminationValue *termValues =
+            reinterpret_cast<const TerminationValue *>(image + sections[TERMINATION_VALUES].offset);
+    for (unsigned i = 0; i < sections[TERMINATION_VALUES].count; ++i)
+        if (termValues[i].templateNo >= numTemplates
+                || termValues[i].slotSet >= numSlotSets)
+            return false;
+
+    const unsigned *slotSetWords =
+            reinterpret_cast<const unsigned *>(image + sections[SLOT_SET_WORDS].offset);
+    for (unsigned i = 0; i < numSlotSetWords; ++i)
+        for (unsigned word = slotSetWords[i]; word != 0; word &= word - 1)
+        {
+            const size_t slotNumber = size_t(i % header.wordsPerSlotSet)
+                                      * InflectionSlotTable::BITS_PER_WORD
+                                      + InflectionSlotTable::findLowestBit(word);
+            if (slotNumber >= sections[SLOTS].count)
+                return false;
+        }
+
+    const RankedVerb *rankedVerbs =
+            reinterpret_cast<const RankedVerb *>(image + sections[RANKED_VERBS].offset);
+    for (unsigned i = 0; i < sections[RANKED_VERBS].count; ++i)
+        if (!isRangeValid(rankedVerbs[i].infinitive.offset,
+                          rankedVerbs[i].infinitive.length, arenaLength))
+            return false;
+    return true;
+}
+
+
+// Maps the image of the given name.
+// Returns NULL if there is none, with 'status' set to STALE, or if it
+// cannot be used, with 'status' set by checkImage().
+//
+//static
+SharedDictionary *
+SharedDictionary::attach(const string &name, Stamp stamp, Status &status)
+{
+    status = STALE;
+    int fd = openObject(name, O_RDONLY, 0);
+    if (fd < 0)
+        return NULL;
+
+    struct stat statbuf;
+    if (fstat(fd, &statbuf) != 0)
+    {
+        (void) close(fd);
+        status = BUSY;  // do not replace what could not be examined
+        return NULL;
+    }
+
+    // Another user could make this process deconjugate anything.
+    // An image that cannot be trusted is neither used nor replaced.
+    //
+    if (statbuf.st_uid != geteuid() || (statbuf.st_mode & (S_IWGRP | S_IWOTH)) != 0)
+    {
+        (void) close(fd);
+        status = BUSY;
+        return NULL;
+    }
+
+    size_t imageSize = size_t(statbuf.st_size);
+    if (imageSize < sizeof(Header))
+    {
+        (void) close(fd);
+        status = (isCreatorAlive(0, statbuf.st_mtime) ? BUSY : STALE);
+        return NULL;
+    }
+
+    void *p = mmap(NULL, imageSize, PROT_READ, MAP_SHARED, fd, 0);
+    (void) close(fd);  // the mapping remains
+    if (p == MAP_FAILED)
+    {
+        status = BUSY;
+        return NULL;
+    }
+
+    status = checkImage(p, imageSize, stamp, statbuf.st_mtime);
+    if (status != VALID)
+    {
+        (void) munmap(p, imageSize);
+        return NULL;
+    }
+    return new SharedDictionary(p, imageSize, ATTACHED);
+}
+
+
+// Copies a private image into a new object of the given name.
+// Returns NULL if the object exists or cannot be written.
+//
+//static
+SharedDictionary *
+SharedDictionary::publish(const string &name, const SharedDictionary &privateImage)
+{
+    // O_EXCL: if another process has just published the image,
+    // keep the private one rather than replace it.
+    //
+    int fd = openObject(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
+        return NULL;
+
+    const size_t imageSize = privateImage.size;
+    void *p = MAP_FAILED;
+    if (ftruncate(fd, off_t(imageSize)) == 0)
+        p = mmap(NULL, imageSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    (void) close(fd);
+    if (p == MAP_FAILED)
+    {
+        (void) remove(name);
+        return NULL;
+    }
+
+    // Write the header as incomplete, then the sections, then mark
+    // the image as complete.
+    //
+    Header header = privateImage.getHeader();
+    header.creatorPid = unsigned(getpid());
+    header.complete = 0;
+    memcpy(static_cast<char *>(p) + sizeof(Header),
+           static_cast<const char *>(privateImage.image) + sizeof(Header),
+           imageSize - sizeof(Header));
+    memcpy(p, &header, sizeof(Header));
+    __sync_synchronize();
+    static_cast<Header *>(p)->complete = 1;
+
+    (void) mprotect(p, imageSize, PROT_READ);
+    return new SharedDictionary(p, imageSize, PUBLISHED);
+}
+
+
+//static
+SharedDictionary *
+SharedDictionary::open(const string &name,
+                       const string &conjugationFilename,
+                       const string &verbsFilename,
+                       bool includeWithoutAccents,
+                       FrenchVerbDictionary::Language lang)
+                                                    throw(logic_error)
+{
+    const Stamp stamp = computeSourceStamp(conjugationFilename, verbsFilename,
+                                           includeWithoutAccents, lang);
+
+    Status status;
+    SharedDictionary *sd = attach(name, stamp, status);
+    if (sd != NULL)
+        return sd;
+    if (status == STALE)
+        (void) remove(name);  // the processes attached to it keep it
+
+    SharedDictionary *privateImage;
+    {
+        FrenchVerbDictionary fvd(conjugationFilename, verbsFilename,
+                                 includeWithoutAccents, lang);
+        privateImage = new SharedDictionary(fvd);
+    }
+    reinterpret_cast<Header *>(&privateImage->buffer[0])->sourceStamp = stamp;
+
+    // Do not wait for the process that is writing the image.
+    //
+    if (status == BUSY)
+        return privateImage;
+
+    sd = publish(name, *privateImage);
+    if (sd == NULL)
+        return privateImage;
+    delete privateImage;
+    return sd;
+}
+
+
+//static
+bool
+SharedDictionary::remove(const string &name)
+{
+    if (isSharedMemoryName(name))
+        return shm_unlink(name.c_str()) == 0;
+    return unlink(name.c_str()) == 0;
+}
+
+
+const SharedDictionary::Header &
+SharedDictionary::getHeader() const
+{
+    return *static_cast<const Header *>(image);
+}
+
+
+template <class T>
+const T *
+SharedDictionary::getSection(unsigned sectionNo) const
+{
+    return reinterpret_cast<const T *>(static_cast<const char *>(image)
+                                       + getHeader().sections[sectionNo].offset);
+}
+
+
+FrenchVerbDictionary::Language
+SharedDictionary::getLanguage() const
+{
+    return FrenchVerbDictionary::Language(getHeader().language);
+}
+
+
+size_t
+SharedDictionary::getImageSize() const
+{
+    return size;
+}
+
+
+// Binary search in the infinitives, which are sorted like std::string.
+//
+unsigned
+SharedDictionary::getFrequencyRank(const string &utf8Infinitive) const
+{
+    const char *arena = getSection<char>(ARENA);
+    const RankedVerb *lo = getSection<RankedVerb>(RANKED_VERBS);
+    const RankedVerb *hi = lo + getHeader().sections[RANKED_VERBS].count;
+    while (lo < hi)
+    {
+        const RankedVerb *mid = lo + (hi - lo) / 2;
+        int cmp = utf8Infinitive.compare(0, string::npos,
+                                         arena + mid->infinitive.offset,
+                                         mid->infinitive.length);
+        if (cmp == 0)
+            return mid->rank;
+        if (cmp > 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return VerbRecordTable::NO_RANK;
+}
+
+
+// Same as Dawg::findTransition().
+//
+const SharedDictionary::State *
+SharedDictionary::findTransition(const State *states,
+                                 const Transition *transitions,
+                                 const State &state, char c) const
+{
+    const Transition *lo = transitions + state.firstTransition;
+    const Transition *hi = lo + state.numTransitions;
+    while (lo < hi)
+    {
+        const Transition *mid = lo + (hi - lo) / 2;
+        if (mid->label < c)
+            lo = mid + 1;
+        else if (c < mid->label)
+            hi = mid;
+        else
+            return &states[mid->target];
+    }
+    return NULL;
+}
+
+
+// Termination index of searchSuffixFirst() held in the sections of
+// the image.  The word is read backwards.
+//
+class SharedDictionary::ImageTerminations
+{
+public:
+
+    typedef const TerminationValue *ValueIterator;
+
+    ImageTerminations(const SharedDictionary &d)
+      : dict(d)
+    {
+    }
+
+    size_t findSuffixes(const string &word,
+                        SuffixMatch<ValueIterator> matches[],
+                        size_t maxMatches) const
+    {
+        const Header &header = dict.getHeader();
+        const State *states = dict.getSection<State>(TERMINATION_STATES);
+        const Transition *transitions = dict.getSection<Transition>(TERMINATION_TRANSITIONS);
+        const ValueList *valueLists = dict.getSection<ValueList>(TERMINATION_VALUE_LISTS);
+        const TerminationValue *values = dict.getSection<TerminationValue>(TERMINATION_VALUES);
+
+        const size_t len = word.length();
+        size_t numMatches = 0;
+        const State *state = &states[header.terminationInitialState];
+        for (size_t index = 0; ; ++index)
+        {
+            if (state->valueIndex != NO_VALUE && numMatches < maxMatches)
+            {
+                const ValueList &list = valueLists[state->valueIndex];
+                SuffixMatch<ValueIterator> &match = matches[numMatches++];
+                match.length = index;
+                match.first = values + list.first;
+                match.last = match.first + list.count;
+            }
+            if (index == len || state->numTransitions == 0)
+                break;
+            state = dict.findTransition(states, transitions, *state, word[len - 1 - index]);
+            if (state == NULL)
+                break;
+        }
+        return numMatches;
+    }
+
+private:
+    const SharedDictionary &dict;
+
+    // Forbidden operations:
+    ImageTerminations &operator = (const ImageTerminations &);
+};
+
+
+// Radical index of searchSuffixFirst() held in the sections of the image.
+//
+class SharedDictionary::ImageRadicals
+{
+public:
+
+    typedef const RadicalValue *ValueIterator;
+
+    ImageRadicals(const SharedDictionary &d)
+      : dict(d)
+    {
+    }
+
+    bool find(const string &word, size_t radicalLength,
+              ValueIterator &first, ValueIterator &last) const
+    {
+        const Header &header = dict.getHeader();
+        const State *states = dict.getSection<State>(RADICAL_STATES);
+        const Transition *transitions = dict.getSection<Transition>(RADICAL_TRANSITIONS);
+
+        const State *state = &states[header.radicalInitialState];
+        for (size_t index = 0; index < radicalLength && state != NULL; ++index)
+            state = (state->numTransitions == 0 ? NULL
+                     : dict.findTransition(states, transitions, *state, word[index]));
+        if (state == NULL || state->valueIndex == NO_VALUE)
+            return false;
+
+        const ValueList &list =
+                dict.getSection<ValueList>(RADICAL_VALUE_LISTS)[state->valueIndex];
+        first = dict.getSection<RadicalValue>(RADICAL_VALUES) + list.first;
+        last = first + list.count;
+        return true;
+    }
+
+private:
+    const SharedDictionary &dict;
+
+    // Forbidden operations:
+    ImageRadicals &operator = (const ImageRadicals &);
+};
+
+
+// Accept callback passed to searchSuffixFirst() by deconjugate().
+// Does what FrenchVerbDictionary::appendInflections() does, with the
+// sections of the image.
+//
+class SharedDictionary::SuffixAcceptor
+{
+public:
+
+    SuffixAcceptor(const SharedDictionary &dict,
+                   const string &v,
+                   vector<InflectionDesc> &r)
+      : conjugatedVerb(v),
+        results(r),
+        wordsPerSlotSet(dict.getHeader().wordsPerSlotSet),
+        arena(dict.getSection<char>(ARENA)),
+        templateNames(dict.getSection<StringRef>(TEMPLATE_NAMES)),
+        slots(dict.getSection<PackedModeTensePersonNumber>(SLOTS)),
+        slotSetWords(dict.getSection<unsigned>(SLOT_SET_WORDS))
+    {
+    }
+
+    bool isBefore(const TerminationValue &t, const RadicalValue &r) const
+    {
+        return t.templateNo < r.templateNo;
+    }
+
+    bool isSame(const TerminationValue &t, const RadicalValue &r) const
+    {
+        return t.templateNo == r.templateNo;
+    }
+
+    bool operator () (size_t radicalLength,
+                      const RadicalValue &rv,
+                      const TerminationValue &tv)
+    {
+        // The infinitive is formed from the (correct) radical and from
+        // the termination of the template name.
+        //
+        const StringRef &tref = templateNames[rv.templateNo];
+        const string tname(arena + tref.offset, tref.length);
+        string infinitive = (rv.correctRadicalLength == 0
+                ? string(conjugatedVerb, 0, radicalLength)
+                : string(arena + rv.correctRadicalOffset, rv.correctRadicalLength));
+        infinitive.append(tname, tname.find(':') + 1, string::npos);
+
+        const unsigned *words = slotSetWords + size_t(tv.slotSet) * wordsPerSlotSet;
+        for (size_t w = 0; w < wordsPerSlotSet; ++w)
+            for (unsigned word = words[w]; word != 0; word &= word - 1)
+            {
+                const unsigned slotNumber = unsigned(w * InflectionSlotTable::BITS_PER_WORD
+                                + InflectionSlotTable::findLowestBit(word));
+                results.push_back(InflectionDesc(infinitive, tname,
+                                                 slots[slotNumber].unpack()));
+            }
+        return true;
+    }
+
+private:
+    const string &conjugatedVerb;
+    vector<InflectionDesc> &results;
+    size_t wordsPerSlotSet;
+    const char *arena;
+    const StringRef *templateNames;
+    const PackedModeTensePersonNumber *slots;
+    const unsigned *slotSetWords;
+
+    // Forbidden operations:
+    SuffixAcceptor(const SuffixAcceptor &);
+    SuffixAcceptor &operator = (const SuffixAcceptor &);
+};
+
+
+// Same algorithm as FrenchVerbDictionary::deconjugateSuffixFirst(),
+// on the sections of the image.
+//
+void
+SharedDictionary::deconjugate(const string &utf8ConjugatedVerb,
+                              vector<InflectionDesc> &results) const
+{
+    const Header &header = getHeader();
+
+    const Section &filterSection = header.sections[FILTER_WORDS];
+    if (filterSection.count != 0
+            && !BloomFilter::mayContain(getSection<BloomFilter::Hash>(FILTER_WORDS),
+                                        filterSection.count,
+                                        BloomFilter::hash(utf8ConjugatedVerb)))
+        return;
+
+    if (header.sections[TERMINATION_STATES].count == 0
+            || header.sections[RADICAL_STATES].count == 0)
+        return;
+
+    ImageTerminations terminations(*this);
+    ImageRadicals radicals(*this);
+    SuffixAcceptor acceptor(*this, utf8ConjugatedVerb, results);
+    searchSuffixFirst(utf8ConjugatedVerb, terminations, radicals, acceptor);
+}
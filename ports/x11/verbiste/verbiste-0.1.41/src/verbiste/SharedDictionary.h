@@ -0,0 +1,220 @@
+/*  $Id$
+    SharedDictionary.h - Deconjugation index shared by several processes
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_SharedDictionary
+#define _H_SharedDictionary
+
+#include <verbiste/FrenchVerbDictionary.h>
+
+#include <stddef.h>
+#include <time.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Read-only image of what a FrenchVerbDictionary needs to deconjugate
+    verbs, which several processes of a host can share.
+
+    A dictionary takes several megabytes per process, and takes much
+    longer to load than to use.  The image is a single block of memory
+    that contains the radical and termination automata, the template
+    names, the inflection slots and the verb form filter, designated by
+    offsets rather than pointers.  The first process that calls open()
+    loads the dictionary, then publishes its image in a named POSIX
+    shared memory object, or in a file; the following processes map
+    that image read-only, without reading the XML files.
+
+    The image records the version of its format and of the library, the
+    language, whether missing accents are tolerated, and the size and
+    modification time of the files it was built from (the conjugation,
+    verb and verb frequency files, and the $HOME/.verbiste overlay).
+    An image that does not match is stale: open() replaces it.  If it
+    cannot be published, e.g., because another process is building it,
+    the image is kept in private memory.
+
+    Only deconjugation is provided, with the frequency ranks of the
+    verbs to order the results: conjugating a verb or analyzing phrases
+    still need a FrenchVerbDictionary.
+    The methods are const and can be called by several threads at once.
+*/
+class SharedDictionary
+{
+public:
+
+    /** Version of the image format.  An image of another version is stale.
+    */
+    enum { FORMAT_VERSION = 1 };
+
+    /** How an image was obtained.
+    */
+    enum Origin
+    {
+        ATTACHED,   // mapped from the image published by another process
+        PUBLISHED,  // built, then published by this process
+        PRIVATE     // built in the memory of this process only
+    };
+
+    /** Returns the name under which open() publishes the image of a
+        dictionary by default.
+        The name is that of a POSIX shared memory object, of the form
+        "/verbiste-<API>-<language>[-accents]-<user id>": an image is
+        only shared by the processes of one user.  An image that belongs
+        to another user, or that the group or the other users can write,
+        is not attached to.  The VERBISTE_SHARED_NAME environment
+        variable, if it is set, replaces this name.
+    */
+    static std::string getDefaultName(FrenchVerbDictionary::Language lang,
+                                      bool includeWithoutAccents);
+
+    /** Attaches to the published image of a dictionary, or loads the
+        dictionary from its files and publishes its image if there is
+        none or if it is stale.
+        @param  name            name of a POSIX shared memory object if it
+                                starts with '/' and contains no other '/',
+                                or name of a file otherwise
+        @param  conjugationFilename, verbsFilename, includeWithoutAccents, lang
+                                arguments of the FrenchVerbDictionary
+                                constructor
+        @returns                an object allocated with new, to be
+                                destroyed by the caller
+        @throws logic_error     the dictionary had to be loaded and could
+                                not be
+    */
+    static SharedDictionary *open(const std::string &name,
+                                  const std::string &conjugationFilename,
+                                  const std::string &verbsFilename,
+                                  bool includeWithoutAccents,
+                                  FrenchVerbDictionary::Language lang)
+                                                    throw(std::logic_error);
+
+    /** Removes the published image of the given name, if any.
+        The processes that are attached to it keep their mapping.
+        @returns        true if an image was removed
+    */
+    static bool remove(const std::string &name);
+
+    /** Builds the private image of a dictionary.
+        The dictionary is not used afterwards.
+    */
+    explicit SharedDictionary(const FrenchVerbDictionary &fvd);
+
+    /** Unmaps or frees the image.
+    */
+    ~SharedDictionary();
+
+    /** Indicates how this image was obtained.
+    */
+    Origin getOrigin() const { return origin; }
+
+    /** Returns the language of the dictionary.
+    */
+    FrenchVerbDictionary::Language getLanguage() const;
+
+    /** Returns the size of the image in bytes.
+    */
+    size_t getImageSize() const;
+
+    /** Returns the frequency rank of a verb, as given by
+        FrenchVerbDictionary::getFrequencyRank() on the dictionary of
+        the image: VerbRecordTable::NO_RANK if the verb is unknown or
+        has no rank.
+        @param  utf8Infinitive  infinitive of the verb
+    */
+    unsigned getFrequencyRank(const std::string &utf8Infinitive) const;
+
+    /** Analyzes a conjugated verb.
+        Gives the same results, in the same order, as
+        FrenchVerbDictionary::deconjugate(const std::string &, std::vector<InflectionDesc> &)
+        on the dictionary of the image.
+        @param  utf8ConjugatedVerb  lowercase UTF-8 word to analyze
+        @param  results             vector to which the analyses are appended
+    */
+    void deconjugate(const std::string &utf8ConjugatedVerb,
+                     std::vector<InflectionDesc> &results) const;
+
+private:
+
+    typedef unsigned long long Stamp;
+
+    struct Header;
+    struct Section;
+    struct State;
+    struct Transition;
+    struct ValueList;
+    struct RadicalValue;
+    struct TerminationValue;
+
+    class ImageBuilder;
+    class ImageTerminations;
+    class ImageRadicals;
+    class SuffixAcceptor;
+    friend class ImageBuilder;
+    friend class ImageTerminations;
+    friend class ImageRadicals;
+    friend class SuffixAcceptor;
+
+    enum Status { VALID, BUSY, STALE };
+
+    SharedDictionary(const void *image, size_t size, Origin origin);
+
+    static Stamp computeSourceStamp(const std::string &conjugationFilename,
+                                    const std::string &verbsFilename,
+                                    bool includeWithoutAccents,
+                                    FrenchVerbDictionary::Language lang);
+    static Status checkImage(const void *image, size_t size,
+                             Stamp stamp, time_t modificationTime);
+    static bool checkAutomaton(const Header &header,
+                               unsigned statesSection,
+                               unsigned transitionsSection,
+                               unsigned valueListsSection,
+                               unsigned initialState);
+    static bool checkIndices(const Header &header);
+    static SharedDictionary *attach(const std::string &name, Stamp stamp,
+                                    Status &status);
+    static SharedDictionary *publish(const std::string &name,
+                                     const SharedDictionary &privateImage);
+
+    const Header &getHeader() const;
+    template <class T> const T *getSection(unsigned sectionNo) const;
+    const State *findTransition(const State *states,
+                                const Transition *transitions,
+                                const State &state, char c) const;
+
+    const void *image;
+    size_t size;
+    Origin origin;
+    std::vector<unsigned long long> buffer;  // image of a PRIVATE object
+
+    // Forbidden operations:
+    SharedDictionary(const SharedDictionary &);
+    SharedDictionary &operator = (const SharedDictionary &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_SharedDictionary */
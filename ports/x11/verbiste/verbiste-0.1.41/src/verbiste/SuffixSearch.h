@@ -0,0 +1,246 @@
+/*  $Id$
+    SuffixSearch.h - Search of a conjugated verb by termination first
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_SuffixSearch
+#define _H_SuffixSearch
+
+#include "Dawg.h"
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Termination found at the end of a searched word.
+    [first, last) is the list of the templates that accept it,
+    sorted by template.
+*/
+template <class Iterator>
+struct SuffixMatch
+{
+    size_t length;  // in bytes
+    Iterator first;
+    Iterator last;
+};
+
+
+/** Maximum number of terminations kept for one word.
+    There is at most one termination per length, and the longest
+    terminations are much shorter than this.
+*/
+enum { MAX_SUFFIX_MATCHES = 64 };
+
+
+/** Searches a conjugated verb for a known radical followed by a
+    termination that the template of the radical accepts.
+    This is the SUFFIX_FIRST strategy of FrenchVerbDictionary, which
+    MultiLanguageIndex and SharedDictionary also use on their own indexes.
+
+    'terminations' must provide a ValueIterator type and
+        size_t findSuffixes(const std::string &word,
+                            SuffixMatch<ValueIterator> matches[],
+                            size_t maxMatches) const;
+    which stores the terminations that 'word' ends with, by increasing
+    length, and returns their number.
+
+    'radicals' must provide a ValueIterator type and
+        bool find(const std::string &word, size_t radicalLength,
+                  ValueIterator &first, ValueIterator &last) const;
+    which gives the templates of the radical formed by the first
+    'radicalLength' bytes of 'word', and returns false if there is
+    no such radical.
+
+    'accept' must provide
+        bool isBefore(const TerminationValue &, const RadicalValue &) const;
+        bool isSame(const TerminationValue &, const RadicalValue &) const;
+    which compare the template of a termination value with that of a
+    radical value in the order of the termination lists, and
+        bool operator () (size_t radicalLength,
+                          const RadicalValue &, const TerminationValue &);
+    which is called for each template that accepts the termination
+    that follows the radical, and returns false to end the search.
+
+    The calls come by increasing radical length, then in the order
+    of the templates of the radical.
+    @param  numTemplateProbes   if not NULL, the number of templates
+                                looked up in a termination list is added
+                                to *numTemplateProbes
+*/
+template <class Terminations, class Radicals, class Accept>
+void
+searchSuffixFirst(const std::string &word,
+                  const Terminations &terminations,
+                  const Radicals &radicals,
+                  Accept &accept,
+                  size_t *numTemplateProbes = NULL)
+{
+    typedef typename Terminations::ValueIterator TerminationIterator;
+    typedef typename Radicals::ValueIterator RadicalIterator;
+
+    SuffixMatch<TerminationIterator> matches[MAX_SUFFIX_MATCHES];
+    const size_t numMatches = terminations.findSuffixes(word, matches, MAX_SUFFIX_MATCHES);
+
+    // Longest termination first, i.e., shortest radical first.
+    //
+    size_t numProbes = 0;
+    bool searching = true;
+    for (size_t m = numMatches; m-- > 0 && searching; )
+    {
+        const size_t radicalLength = word.length() - matches[m].length;
+        RadicalIterator i, end;
+        if (!radicals.find(word, radicalLength, i, end))
+            continue;  // not a known radical
+
+        for ( ; i != end && searching; ++i)
+        {
+            // Look for the template among those that accept the termination.
+            //
+            TerminationIterator lo = matches[m].first, hi = matches[m].last;
+            while (lo < hi)
+            {
+                TerminationIterator mid = lo + (hi - lo) / 2;
+                if (accept.isBefore(*mid, *i))
+                    lo = mid + 1;
+                else
+                    hi = mid;
+            }
+            ++numProbes;
+            if (lo == matches[m].last || !accept.isSame(*lo, *i))
+                continue;
+
+            searching = accept(radicalLength, *i, *lo);
+        }
+    }
+
+    if (numTemplateProbes != NULL)
+        *numTemplateProbes += numProbes;
+}
+
+
+/** Termination index of searchSuffixFirst() held in a Dawg of the
+    reversed terminations.
+*/
+template <class Value>
+class DawgTerminations
+{
+public:
+
+    typedef typename std::vector<Value>::const_iterator ValueIterator;
+    typedef Dawg< std::vector<Value>, char > Automaton;
+
+    /** @param  numStatesVisited    as in Dawg<>::forEachPrefix()
+    */
+    DawgTerminations(const Automaton &a, size_t *numStatesVisited = NULL)
+      : automaton(a), statesVisited(numStatesVisited)
+    {
+    }
+
+    size_t findSuffixes(const std::string &word,
+                        SuffixMatch<ValueIterator> matches[],
+                        size_t maxMatches) const
+    {
+        const std::string reversedWord(word.rbegin(), word.rend());
+        Collector collector(matches, maxMatches);
+        (void) automaton.forEachPrefix(reversedWord, collector, statesVisited);
+        return collector.numMatches;
+    }
+
+private:
+
+    // Visitor passed to Automaton::forEachPrefix().
+    //
+    struct Collector
+    {
+        Collector(SuffixMatch<ValueIterator> m[], size_t max)
+          : matches(m), maxMatches(max), numMatches(0) {}
+
+        void operator () (const std::string &,
+                          std::string::size_type index,
+                          const std::vector<Value> *templateList)
+        {
+            if (numMatches == maxMatches)
+                return;
+            SuffixMatch<ValueIterator> &match = matches[numMatches++];
+            match.length = index;
+            match.first = templateList->begin();
+            match.last = templateList->end();
+        }
+
+        SuffixMatch<ValueIterator> *matches;
+        size_t maxMatches;
+        size_t numMatches;
+    };
+
+    const Automaton &automaton;
+    size_t *statesVisited;
+
+    // Forbidden operations:
+    DawgTerminations &operator = (const DawgTerminations &);
+};
+
+
+/** Radical index of searchSuffixFirst() held in a Dawg.
+*/
+template <class Value>
+class DawgRadicals
+{
+public:
+
+    typedef typename std::vector<Value>::const_iterator ValueIterator;
+    typedef Dawg< std::vector<Value>, char > Automaton;
+
+    /** @param  numStatesVisited    as in Dawg<>::find()
+    */
+    DawgRadicals(const Automaton &a, size_t *numStatesVisited = NULL)
+      : automaton(a), statesVisited(numStatesVisited)
+    {
+    }
+
+    bool find(const std::string &word, size_t radicalLength,
+              ValueIterator &first, ValueIterator &last) const
+    {
+        const std::vector<Value> *templateList =
+                        automaton.find(word, radicalLength, statesVisited);
+        if (templateList == NULL)
+            return false;
+        first = templateList->begin();
+        last = templateList->end();
+        return true;
+    }
+
+private:
+
+    const Automaton &automaton;
+    size_t *statesVisited;
+
+    // Forbidden operations:
+    DawgRadicals &operator = (const DawgRadicals &);
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_SuffixSearch */
@@ -31,6 +31,13 @@
 namespace verbiste {
 
 
+// Returns the stream on which to write trace messages about keys whose
+// characters are of the same type as the argument.
+//
+inline std::wostream &trieTraceStream(wchar_t) { return std::wcout; }
+inline std::ostream &trieTraceStream(char) { return std::cout; }
+
+
 ///////////////////////////////////////////////////////////////////////////////
 //
 // Descriptor local class
@@ -38,8 +45,8 @@ namespace verbiste {
 //
 
 
-template <class T>
-Trie<T>::Descriptor::Descriptor(wchar_t u)
+template <class T, class CharT>
+Trie<T, CharT>::Descriptor::Descriptor(CharT u)
   : unichar(u),
     inferiorRow(NULL),
     userData(NULL)
@@ -47,16 +54,16 @@ Trie<T>::Descriptor::Descriptor(wchar_t u)
 }
 
 
-template <class T>
-Trie<T>::Descriptor::~Descriptor()
+template <class T, class CharT>
+Trie<T, CharT>::Descriptor::~Descriptor()
 {
     assert(inferiorRow == NULL);
 }
 
 
-template <class T>
+template <class T, class CharT>
 void
-Trie<T>::Descriptor::recursiveDelete(bool deleteUserData)
+Trie<T, CharT>::Descriptor::recursiveDelete(bool deleteUserData)
 {
     if (deleteUserData)
     {
@@ -72,9 +79,9 @@ Trie<T>::Descriptor::recursiveDelete(bool deleteUserData)
 }
 
 
-template <class T>
+template <class T, class CharT>
 size_t
-Trie<T>::Descriptor::computeMemoryConsumption() const
+Trie<T, CharT>::Descriptor::computeMemoryConsumption() const
 {
     return sizeof(*this) + (inferiorRow != NULL ? inferiorRow->computeMemoryConsumption() : 0);
 }
@@ -87,16 +94,16 @@ Trie<T>::Descriptor::computeMemoryConsumption() const
 //
 
 
-template <class T>
-Trie<T>::Row::~Row()
+template <class T, class CharT>
+Trie<T, CharT>::Row::~Row()
 {
     assert(elements.size() == 0);  // recursiveDelete() should have been called
 }
 
 
-template <class T>
+template <class T, class CharT>
 size_t
-Trie<T>::Row::computeMemoryConsumption() const
+Trie<T, CharT>::Row::computeMemoryConsumption() const
 {
     size_t sum = 0;
     for (typename DescVec::const_iterator it = elements.begin(); it != elements.end(); ++it)
@@ -105,9 +112,9 @@ Trie<T>::Row::computeMemoryConsumption() const
 }
 
 
-template <class T>
+template <class T, class CharT>
 void
-Trie<T>::Row::recursiveDelete(bool deleteUserData)
+Trie<T, CharT>::Row::recursiveDelete(bool deleteUserData)
 {
     for (typename DescVec::iterator it = elements.begin(); it != elements.end(); it++)
     {
@@ -120,9 +127,9 @@ Trie<T>::Row::recursiveDelete(bool deleteUserData)
 }
 
 
-template <class T>
-typename Trie<T>::Descriptor *
-Trie<T>::Row::find(wchar_t unichar)
+template <class T, class CharT>
+typename Trie<T, CharT>::Descriptor *
+Trie<T, CharT>::Row::find(CharT unichar)
 {
     for (typename DescVec::iterator it = elements.begin(); it != elements.end(); it++)
     {
@@ -135,9 +142,24 @@ Trie<T>::Row::find(wchar_t unichar)
 }
 
 
-template <class T>
-typename Trie<T>::Descriptor &
-Trie<T>::Row::operator [] (wchar_t unichar)
+template <class T, class CharT>
+const typename Trie<T, CharT>::Descriptor *
+Trie<T, CharT>::Row::find(CharT unichar) const
+{
+    for (typename DescVec::const_iterator it = elements.begin(); it != elements.end(); it++)
+    {
+        assert(*it != NULL);
+        if ((*it)->unichar == unichar)
+            return *it;
+    }
+
+    return NULL;
+}
+
+
+template <class T, class CharT>
+typename Trie<T, CharT>::Descriptor &
+Trie<T, CharT>::Row::operator [] (CharT unichar)
 {
     Descriptor *pd = find(unichar);
     if (pd != NULL)
@@ -156,8 +178,8 @@ Trie<T>::Row::operator [] (wchar_t unichar)
 //
 //
 
-template <class T>
-Trie<T>::Trie(bool _userDataFromNew)
+template <class T, class CharT>
+Trie<T, CharT>::Trie(bool _userDataFromNew)
   : emptyKeyUserData(NULL),
     firstRow(new Row()),
     userDataFromNew(_userDataFromNew)
@@ -165,8 +187,8 @@ Trie<T>::Trie(bool _userDataFromNew)
 }
 
 
-template <class T>
-Trie<T>::~Trie()
+template <class T, class CharT>
+Trie<T, CharT>::~Trie()
 {
     if (userDataFromNew)
         delete emptyKeyUserData;
@@ -176,24 +198,84 @@ Trie<T>::~Trie()
 }
 
 
-template <class T>
+template <class T, class CharT>
+T *
+Trie<T, CharT>::get(const String &key) const
+{
+    VirtualCallbackVisitor visitor(*this);
+    return forEachPrefix(key, visitor);
+}
+
+
+template <class T, class CharT>
+template <class Visitor>
 T *
-Trie<T>::get(const std::wstring &key) const
+Trie<T, CharT>::forEachPrefix(const String &key, Visitor &visitor) const
 {
     if (emptyKeyUserData != NULL)
-        onFoundPrefixWithUserData(key, 0, emptyKeyUserData);
+        visitor(key, 0, emptyKeyUserData);
 
     if (key.empty())
         return emptyKeyUserData;
 
-    Descriptor *d = const_cast<Trie<T> *>(this)->getDesc(firstRow, key, 0, false, true);
-    return (d != NULL ? d->userData : NULL);
+    const typename String::size_type len = key.length();
+    const Row *row = firstRow;
+    for (typename String::size_type index = 0; ; )
+    {
+        const Descriptor *pd = row->find(key[index]);
+        if (pd == NULL)  // if expected character not found
+            return NULL;
+
+        ++index;  // length of the prefix that leads to pd
+
+        if (pd->userData != NULL)
+            visitor(key, index, pd->userData);
+
+        if (index == len)  // if reached end of key
+            return pd->userData;
+
+        row = pd->inferiorRow;
+        if (row == NULL)  // if pd is a leaf
+            return NULL;
+    }
+}
+
+
+template <class T, class CharT>
+template <class Visitor>
+void
+Trie<T, CharT>::forEachKey(Visitor &visitor) const
+{
+    String key;
+    if (emptyKeyUserData != NULL)
+        visitor(key, static_cast<const T *>(emptyKeyUserData));
+    forEachKeyInRow(*firstRow, key, visitor);
 }
 
 
-template <class T>
+//static
+template <class T, class CharT>
+template <class Visitor>
+void
+Trie<T, CharT>::forEachKeyInRow(const Row &row, String &key, Visitor &visitor)
+{
+    const DescVec &elements = row.getElements();
+    for (typename DescVec::const_iterator it = elements.begin(); it != elements.end(); ++it)
+    {
+        const Descriptor *pd = *it;
+        key += pd->unichar;
+        if (pd->userData != NULL)
+            visitor(key, static_cast<const T *>(pd->userData));
+        if (pd->inferiorRow != NULL)
+            forEachKeyInRow(*pd->inferiorRow, key, visitor);
+        key.erase(key.length() - 1);
+    }
+}
+
+
+template <class T, class CharT>
 T **
-Trie<T>::getUserDataPointer(const std::wstring &key)
+Trie<T, CharT>::getUserDataPointer(const String &key)
 {
     if (key.empty())
         return &emptyKeyUserData;
@@ -201,88 +283,49 @@ Trie<T>::getUserDataPointer(const std::wstring &key)
     // Get descriptor associated with 'key' (and create a new entry
     // if the key is not known).
     //
-    Descriptor *d = getDesc(firstRow, key, 0, true, false);
+    Descriptor *d = createDesc(key);
     assert(d != NULL);
     return &d->userData;
 }
 
 
-template <class T>
-typename Trie<T>::Descriptor *
-Trie<T>::getDesc(Row *row,
-                const std::wstring &key,
-                std::wstring::size_type index,
-                bool create,
-                bool callFoundPrefixCallback)
+template <class T, class CharT>
+typename Trie<T, CharT>::Descriptor *
+Trie<T, CharT>::createDesc(const String &key)
 {
-    assert(row != NULL);
-    assert(index < key.length());
-
-    wchar_t unichar = key[index];  // the "expected" character
-    assert(unichar != '\0');
+    assert(!key.empty());
 
-    Descriptor *pd = row->find(unichar);
-
-    static bool trieTrace = getenv("TRACE") != NULL;
-    if (trieTrace)
-        std::wcout << "getDesc(row=" << row
-                   << ", key='" << key << "' (len=" << key.length()
-                   << "), index=" << index
-                   << ", create=" << create
-                   << ", call=" << callFoundPrefixCallback
-                   << "): unichar=" << unichar << ", pd=" << pd << "\n";
-
-    if (pd == NULL)  // if expected character not found
+    Row *row = firstRow;
+    Descriptor *pd = NULL;
+    for (typename String::size_type index = 0; index < key.length(); ++index)
     {
-        if (!create)
-            return NULL;
-
-        Descriptor &newDesc = (*row)[unichar];
-        assert(row->find(unichar) != NULL);
-        assert(row->find(unichar) == &newDesc);
-
-        if (index + 1 == key.length())  // if last char of string
-            return &newDesc;
-
-        // Create new descriptor that points to a new inferior row:
-        newDesc.inferiorRow = new Row();
-        assert(row->find(unichar)->inferiorRow == newDesc.inferiorRow);
-
-        return getDesc(newDesc.inferiorRow,
-                        key, index + 1, create, callFoundPrefixCallback);
+        if (pd != NULL)  // if not first char: go down below previous char
+        {
+            if (pd->inferiorRow == NULL)
+                pd->inferiorRow = new Row();
+            row = pd->inferiorRow;
+        }
+
+        assert(key[index] != '\0');
+        pd = &(*row)[key[index]];  // find or create
+        assert(pd->unichar == key[index]);
     }
 
+    static bool trieTrace = getenv("TRACE") != NULL;
     if (trieTrace)
-        std::wcout << "getDesc: userData=" << pd->userData
-                   << ", inferiorRow=" << pd->inferiorRow
-                   << "\n";
-
-    if (callFoundPrefixCallback && pd->userData != NULL)
-        onFoundPrefixWithUserData(key, index + 1, pd->userData);  // virtual call
-
-    if (index + 1 == key.length())  // if reached end of key
-    {
-        if (trieTrace)
-            std::wcout << "getDesc: reached end of key\n";
-        return pd;
-    }
-
-    if (pd->inferiorRow == NULL)  // if pd is a leaf:
-    {
-        if (!create)
-            return NULL;  // not found
-
-        pd->inferiorRow = new Row();
-    }
-
-    return getDesc(pd->inferiorRow,
-                        key, index + 1, create, callFoundPrefixCallback);
+        trieTraceStream(CharT()) << "createDesc(key='" << key
+                                 << "' (len=" << key.length()
+                                 << ")): desc=" << pd
+                                 << ", userData=" << pd->userData
+                                 << ", inferiorRow=" << pd->inferiorRow
+                                 << "\n";
+    return pd;
 }
 
 
-template <class T>
+template <class T, class CharT>
 size_t
-Trie<T>::computeMemoryConsumption() const
+Trie<T, CharT>::computeMemoryConsumption() const
 {
     return sizeof(*this) + (firstRow != NULL ? firstRow->computeMemoryConsumption() : 0);
 }
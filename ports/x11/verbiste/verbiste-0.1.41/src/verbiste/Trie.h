@@ -30,17 +30,28 @@
 namespace verbiste {
 
 
-/** Tree structure for (wide character) string storage.
+template <class T, class CharT> class Dawg;
+
+
+/** Tree structure for string storage.
     @param        T     type of the user data attached to the stored strings;
                         pointers to objects of type T will be stored in the
                         trie, but no T object will be created, copied,
                         assigned or destroyed by the trie.
+    @param        CharT type of the characters of the keys;
+                        with wchar_t (the default), each row of the trie
+                        is indexed by a Unicode character; with char,
+                        the keys are typically UTF-8 byte strings and
+                        each row is indexed by a byte
 */
-template <class T>
+template <class T, class CharT = wchar_t>
 class Trie
 {
 public:
 
+    /** Type of the keys stored in the trie. */
+    typedef std::basic_string<CharT> String;
+
     /** Constructs an empty trie.
         @param        userDataFromNew   determines if the destructor
                                         must assume that all "user data"
@@ -55,15 +66,44 @@ public:
     virtual ~Trie();
 
 
-    /** Searches the trie with the given (wide character) key.
+    /** Searches the trie with the given key.
         Invokes the virtual function onFoundPrefixWithUserData()
         for each find.
-        @param  key         wide character string to search for
+        Equivalent to calling forEachPrefix() with a visitor that
+        forwards its arguments to onFoundPrefixWithUserData().
+        @param  key         string to search for
         @returns            a pointer to the user data pointer
                             associated with 'key', or NULL if
                             nothing was found
     */
-    T *get(const std::wstring &key) const;
+    T *get(const String &key) const;
+
+
+    /** Searches the trie with the given key, without creating anything.
+        For each prefix of 'key' (including the empty prefix and 'key'
+        itself) that has some user data in the trie, from the shortest
+        to the longest, calls visitor(key, index, userData), where
+        'index' is the length of the prefix and 'userData' is a
+        const T * that is not null.
+        The visitor is a template parameter, so that the calls to it
+        can be inlined, unlike calls to onFoundPrefixWithUserData().
+        @param  key         string to search for
+        @param  visitor     function object to call on each prefix found
+        @returns            the user data associated with 'key',
+                            or NULL if none
+    */
+    template <class Visitor>
+    T *forEachPrefix(const String &key, Visitor &visitor) const;
+
+
+    /** Visits all the keys that have some user data.
+        Calls visitor(key, userData) for each of them, in no particular
+        order, where 'userData' is a const T * that is not null.
+        The key passed to the visitor is only valid during the call.
+        @param  visitor     function object to call on each key
+    */
+    template <class Visitor>
+    void forEachKey(Visitor &visitor) const;
 
 
     /** Obtains the address of the user data associated with 'key'
@@ -72,7 +112,7 @@ public:
                         associated with 'key';
                         if a new entry was created, the T * is null.
     */
-    T **getUserDataPointer(const std::wstring &key);
+    T **getUserDataPointer(const String &key);
 
 
     /** Callback invoked by the Trie<>::get() method.
@@ -83,8 +123,8 @@ public:
         @param  index       length of the prefix
         @param  userData    user data that is associated with the prefix
     */
-    virtual void onFoundPrefixWithUserData(const std::wstring &/*key*/,
-                                        std::wstring::size_type /*index*/,
+    virtual void onFoundPrefixWithUserData(const String &/*key*/,
+                                        typename String::size_type /*index*/,
                                         const T * /*userData*/) const
                                                         throw()
     {
@@ -98,6 +138,8 @@ public:
 
 private:
 
+    template <class U, class C> friend class Dawg;  // reads the rows
+
     class Row;
 
     /** Associates user data with a character, and points to the row
@@ -106,7 +148,7 @@ private:
     class Descriptor
     {
     public:
-        Descriptor(wchar_t u);
+        Descriptor(CharT u);
 
         /** Does nothing: recursiveDelete() must have been called before.
         */
@@ -126,7 +168,7 @@ private:
         size_t computeMemoryConsumption() const;
 
     public:
-        wchar_t unichar;  // Unicode character code
+        CharT unichar;  // Unicode character code, or byte of a UTF-8 key
         Row *inferiorRow;
         T *userData;
 
@@ -163,17 +205,18 @@ private:
         void recursiveDelete(bool deleteUserData);
 
 
-        /** Finds an element of this row whose (wide) character field is
+        /** Finds an element of this row whose character field is
             equal to 'unichar'.
             Returns NULL if no such element exists.
         */
-        Descriptor *find(wchar_t unichar);
+        Descriptor *find(CharT unichar);
+        const Descriptor *find(CharT unichar) const;
 
         /** Finds or creates an element of this row whose char. field is 'unichar'.
             If no such element exists, one is created using the
             default constructor of the Descriptor class.
         */
-        Descriptor &operator [] (wchar_t unichar);
+        Descriptor &operator [] (CharT unichar);
 
         /** Computes and returns the number of memory bytes consumed by
             this object, excluding the size of the Descriptors' user data.
@@ -181,16 +224,46 @@ private:
         */
         size_t computeMemoryConsumption() const;
 
+        const DescVec &getElements() const
+        {
+            return elements;
+        }
+
     private:
         DescVec elements;  // members allocated with operator new
     };
 
 
-    Descriptor *getDesc(Row *row,
-                        const std::wstring &key,
-                        std::wstring::size_type index,
-                        bool create,
-                        bool callFoundPrefixCallback);
+    /** Returns the descriptor associated with the non-empty string 'key',
+        creating it and the rows that lead to it if necessary.
+    */
+    Descriptor *createDesc(const String &key);
+
+
+    /** Calls forEachKey()'s visitor on the keys below 'row', which
+        start with 'key'.  'key' is restored before returning.
+    */
+    template <class Visitor>
+    static void forEachKeyInRow(const Row &row, String &key, Visitor &visitor);
+
+
+    /** Visitor used by get() to invoke onFoundPrefixWithUserData().
+    */
+    class VirtualCallbackVisitor
+    {
+    public:
+        VirtualCallbackVisitor(const Trie &t) : trie(t) {}
+
+        void operator () (const String &key,
+                          typename String::size_type index,
+                          const T *userData) const
+        {
+            trie.onFoundPrefixWithUserData(key, index, userData);
+        }
+
+    private:
+        const Trie &trie;
+    };
 
 
     T *emptyKeyUserData;  // user data associated with the empty string key
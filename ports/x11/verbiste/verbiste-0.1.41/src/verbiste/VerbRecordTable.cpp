@@ -0,0 +1,342 @@
+/*  $Id$
+    VerbRecordTable.cpp - Compact, sorted table of the known verbs
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#include "VerbRecordTable.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace std;
+using namespace verbiste;
+
+
+const VerbRecordTable::VerbId VerbRecordTable::NO_VERB;
+const unsigned VerbRecordTable::NO_TEMPLATE;
+const unsigned VerbRecordTable::NO_RANK;
+
+
+VerbRecordTable::VerbRecordTable()
+  : arena(),
+    records(),
+    templateIds(),
+    templateNames(),
+    templateVerbOffsets(),
+    templateVerbs(),
+    pendingVerbs(),
+    pendingRanks(),
+    numRankedVerbs(0)
+{
+}
+
+
+void
+VerbRecordTable::addVerb(const string &infinitive,
+                         const string &templateName,
+                         unsigned flags)
+{
+    assert(!isBuilt());
+    PendingVerb v;
+    v.infinitive = infinitive;
+    v.templateName = templateName;
+    v.flags = flags;
+    pendingVerbs.push_back(v);
+}
+
+
+void
+VerbRecordTable::build() throw(logic_error)
+{
+    assert(!isBuilt());
+
+    sort(pendingVerbs.begin(), pendingVerbs.end());
+
+    // Assign the template identifiers in alphabetical order.
+    //
+    for (vector<PendingVerb>::const_iterator it = pendingVerbs.begin();
+                                             it != pendingVerbs.end(); ++it)
+        templateNames.push_back(it->templateName);
+    sort(templateNames.begin(), templateNames.end());
+    templateNames.erase(unique(templateNames.begin(), templateNames.end()),
+                        templateNames.end());
+    if (templateNames.size() > 0x10000)  // must fit in templateIds
+    {
+        templateNames.clear();
+        throw logic_error("too many conjugation templates for the verb table");
+    }
+    vector<string>(templateNames).swap(templateNames);
+
+    // Pack the verbs.  Since the pending verbs are sorted by infinitive,
+    // then by template name, the entries of a verb are consecutive and
+    // its templates are found in increasing identifier order.
+    //
+    for (vector<PendingVerb>::const_iterator it = pendingVerbs.begin();
+                                             it != pendingVerbs.end(); ++it)
+    {
+        if (records.empty() || it->infinitive != (it - 1)->infinitive)
+        {
+            Record r;
+            r.infinitiveOffset = unsigned(arena.length());
+            r.firstTemplate = unsigned(templateIds.size());
+            r.flags = 0;
+            r.frequencyRank = NO_RANK;
+            records.push_back(r);
+            arena.append(it->infinitive.c_str(), it->infinitive.length() + 1);
+        }
+        else if (it->templateName == (it - 1)->templateName)
+        {
+            records.back().flags |= it->flags;
+            continue;  // same verb and template added twice
+        }
+
+        records.back().flags |= it->flags;
+        templateIds.push_back((unsigned short)
+                (lower_bound(templateNames.begin(), templateNames.end(), it->templateName)
+                 - templateNames.begin()));
+    }
+
+    // Sentinel that marks the end of the last verb.
+    //
+    Record sentinel;
+    sentinel.infinitiveOffset = unsigned(arena.length());
+    sentinel.firstTemplate = unsigned(templateIds.size());
+    sentinel.flags = 0;
+    sentinel.frequencyRank = NO_RANK;
+    records.push_back(sentinel);
+
+    // Use swap() to really free the memory.
+    string(arena).swap(arena);
+    vector<Record>(records).swap(records);
+    vector<unsigned short>(templateIds).swap(templateIds);
+    vector<PendingVerb>().swap(pendingVerbs);
+
+    buildTemplateIndex();
+
+    // The ranks of the verbs that have been removed are lost.
+    //
+    numRankedVerbs = 0;
+    for (vector< pair<string, unsigned> >::const_iterator it = pendingRanks.begin();
+                                                          it != pendingRanks.end(); ++it)
+        setFrequencyRank(find(it->first), it->second);
+    vector< pair<string, unsigned> >().swap(pendingRanks);
+}
+
+
+// Fills templateVerbOffsets and templateVerbs from the packed records,
+// with a counting sort on the template identifiers.  The verbs are
+// visited in increasing identifier order, so the verbs of each template
+// end up sorted.
+//
+void
+VerbRecordTable::buildTemplateIndex()
+{
+    size_t numTemplates = templateNames.size();
+    templateVerbOffsets.assign(numTemplates + 1, 0);
+    for (vector<unsigned short>::const_iterator it = templateIds.begin();
+                                                it != templateIds.end(); ++it)
+        ++templateVerbOffsets[*it + 1];
+    for (size_t t = 0; t < numTemplates; ++t)
+        templateVerbOffsets[t + 1] += templateVerbOffsets[t];
+
+    templateVerbs.resize(templateIds.size());
+    vector<unsigned> next(templateVerbOffsets.begin(), templateVerbOffsets.end() - 1);
+    for (VerbId id = 0; id < size(); ++id)
+        for (size_t i = 0; i < getNumTemplates(id); ++i)
+            templateVerbs[next[getTemplateId(id, i)]++] = id;
+}
+
+
+void
+VerbRecordTable::reopen()
+{
+    assert(isBuilt());
+
+    for (VerbId id = 0; id < size(); ++id)
+        for (size_t i = 0; i < getNumTemplates(id); ++i)
+        {
+            PendingVerb v;
+            v.infinitive = getInfinitive(id);
+            v.templateName = getTemplateName(id, i);
+            v.flags = records[id].flags;
+            pendingVerbs.push_back(v);
+        }
+
+    for (VerbId id = 0; id < size(); ++id)
+        if (records[id].frequencyRank != NO_RANK)
+            pendingRanks.push_back(make_pair(string(getInfinitive(id)),
+                                             records[id].frequencyRank));
+
+    arena.clear();
+    records.clear();
+    templateIds.clear();
+    templateNames.clear();
+    templateVerbOffsets.clear();
+    templateVerbs.clear();
+}
+
+
+void
+VerbRecordTable::removeVerb(const string &infinitive,
+                            const string &templateName)
+{
+    assert(!isBuilt());
+    PendingVerb key;
+    key.infinitive = infinitive;
+    key.templateName = templateName;
+    pendingVerbs.erase(remove(pendingVerbs.begin(), pendingVerbs.end(), key),
+                       pendingVerbs.end());
+}
+
+
+void
+VerbRecordTable::getTemplateNames(const string &infinitive,
+                                  vector<string> &names) const
+{
+    if (isBuilt())
+    {
+        VerbId id = find(infinitive);
+        for (size_t i = 0; i < getNumTemplates(id); ++i)
+            names.push_back(getTemplateName(id, i));
+        return;
+    }
+
+    for (vector<PendingVerb>::const_iterator it = pendingVerbs.begin();
+                                             it != pendingVerbs.end(); ++it)
+        if (it->infinitive == infinitive)
+            names.push_back(it->templateName);
+}
+
+
+VerbRecordTable::VerbId
+VerbRecordTable::find(const char *infinitive) const
+{
+    if (infinitive == NULL || records.empty())
+        return NO_VERB;
+
+    // Binary search among the real records, i.e., excluding the sentinel.
+    // strcmp() compares the characters as unsigned, like std::string,
+    // so the arena is in the order in which build() sorted it.
+    //
+    const char *base = arena.data();
+    size_t lo = 0, hi = records.size() - 1;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = strcmp(base + records[mid].infinitiveOffset, infinitive);
+        if (cmp < 0)
+            lo = mid + 1;
+        else if (cmp > 0)
+            hi = mid;
+        else
+            return VerbId(mid);
+    }
+    return NO_VERB;
+}
+
+
+unsigned
+VerbRecordTable::findTemplate(const string &templateName) const
+{
+    vector<string>::const_iterator it =
+            lower_bound(templateNames.begin(), templateNames.end(), templateName);
+    if (it == templateNames.end() || *it != templateName)
+        return NO_TEMPLATE;
+    return unsigned(it - templateNames.begin());
+}
+
+
+void
+VerbRecordTable::setFrequencyRank(VerbId id, unsigned rank)
+{
+    assert(isBuilt());
+    if (id == NO_VERB)
+        return;
+    assert(id < size());
+    unsigned &r = records[id].frequencyRank;
+    numRankedVerbs += (rank != NO_RANK) - (r != NO_RANK);
+    r = rank;
+}
+
+
+void
+VerbRecordTable::clearFrequencyRanks()
+{
+    for (VerbId id = 0; id < size(); ++id)
+        records[id].frequencyRank = NO_RANK;
+    numRankedVerbs = 0;
+}
+
+
+// Orders verb identifiers by frequency rank.
+//
+class VerbRecordTable::RankComparator
+{
+public:
+
+    RankComparator(const VerbRecordTable &t) : table(t) {}
+
+    bool operator () (VerbId a, VerbId b) const
+    {
+        return table.records[a].frequencyRank < table.records[b].frequencyRank;
+    }
+
+private:
+
+    const VerbRecordTable &table;
+};
+
+
+void
+VerbRecordTable::getMostFrequentVerbs(size_t maxVerbs, vector<VerbId> &ids) const
+{
+    size_t first = ids.size();
+    for (VerbId id = 0; id < size(); ++id)
+        if (records[id].frequencyRank != NO_RANK)
+            ids.push_back(id);
+
+    if (ids.size() - first > maxVerbs)
+    {
+        partial_sort(ids.begin() + first, ids.begin() + first + maxVerbs, ids.end(),
+                     RankComparator(*this));
+        ids.resize(first + maxVerbs);
+    }
+    else
+        sort(ids.begin() + first, ids.end(), RankComparator(*this));
+}
+
+
+size_t
+VerbRecordTable::computeMemoryConsumption() const
+{
+    size_t sum = sizeof(*this)
+                 + arena.size()
+                 + records.size() * sizeof(Record)
+                 + templateIds.size() * sizeof(unsigned short)
+                 + templateNames.size() * sizeof(string)
+                 + templateVerbOffsets.size() * sizeof(unsigned)
+                 + templateVerbs.size() * sizeof(VerbId)
+                 + pendingVerbs.size() * sizeof(PendingVerb)
+                 + pendingRanks.size() * sizeof(pendingRanks[0]);
+    for (vector<string>::const_iterator it = templateNames.begin();
+                                        it != templateNames.end(); ++it)
+        sum += it->size();
+    return sum;
+}
@@ -0,0 +1,338 @@
+/*  $Id$
+    VerbRecordTable.h - Compact, sorted table of the known verbs
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+#ifndef _H_VerbRecordTable
+#define _H_VerbRecordTable
+
+#include <assert.h>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+namespace verbiste {
+
+
+/** Table of the known verbs, sorted by infinitive.
+
+    Each verb has a dense identifier (its rank in the table), an
+    infinitive stored in a single character arena, a list of template
+    identifiers and flag bits.  The verbs are first added one
+    (infinitive, template) pair at a time, then build() packs them.
+    Lookups are binary searches over the arena.
+
+    The infinitives and the template names are in UTF-8.
+    Template identifiers are ranks in the sorted list of the template
+    names used by at least one verb, so the templates of a verb are
+    listed in alphabetical order.
+
+    build() also creates the reverse index, which gives the verbs of
+    each template, in increasing identifier order, thus sorted by
+    infinitive.
+
+    A verb can also have a frequency rank, 0 being the most frequent
+    verb, which is set after build() and kept by reopen() and build().
+*/
+class VerbRecordTable
+{
+public:
+
+    typedef unsigned VerbId;
+
+    /** Value returned by find() when the verb is unknown. */
+    static const VerbId NO_VERB = ~0u;
+
+    /** Value returned by findTemplate() when no verb uses the template. */
+    static const unsigned NO_TEMPLATE = ~0u;
+
+    /** Frequency rank of the verbs that have none. */
+    static const unsigned NO_RANK = ~0u;
+
+    /** Bits that can be passed to addVerb() and returned by getFlags(). */
+    enum Flag
+    {
+        ASPIRATE_H = 1 << 0  // see FrenchVerbDictionary::isVerbStartingWithAspirateH()
+    };
+
+    /** Creates an empty table.
+    */
+    VerbRecordTable();
+
+    /** Adds a verb, or a template or flags to a verb already added.
+        Must not be called after build().
+        @param  infinitive      infinitive of the verb (e.g., "aimer")
+        @param  templateName    template that the verb uses (e.g., "aim:er")
+        @param  flags           combination of the Flag bits; they are
+                                added to those of previous calls for the
+                                same verb
+    */
+    void addVerb(const std::string &infinitive,
+                 const std::string &templateName,
+                 unsigned flags);
+
+    /** Sorts and packs the verbs added by addVerb().
+        The memory used to collect them is freed.
+        Must be called once, before the verbs are looked up.
+        @throws logic_error     the verbs use more than 65536 templates,
+                                which template identifiers cannot number;
+                                the table is then left unbuilt
+    */
+    void build() throw(std::logic_error);
+
+    /** Indicates if build() has been called. */
+    bool isBuilt() const { return !records.empty(); }
+
+    /** Returns the table to the state it had before build(), so that
+        verbs can be added or removed.  build() must then be called
+        again before the verbs are looked up.
+        Must only be called after build().
+    */
+    void reopen();
+
+    /** Removes a template from a verb, and the verb if it has no other
+        template.  Nothing is done if the verb does not have this template.
+        Must not be called after build().
+        @param  infinitive      infinitive of the verb
+        @param  templateName    template to remove
+    */
+    void removeVerb(const std::string &infinitive,
+                    const std::string &templateName);
+
+    /** Appends the names of the templates of a verb to a vector.
+        Can be called before or after build().
+        @param  infinitive      infinitive of the verb
+        @param  names           vector to which the names are appended,
+                                in alphabetical order and without
+                                duplicates after build(); nothing is
+                                appended if the verb is unknown
+    */
+    void getTemplateNames(const std::string &infinitive,
+                          std::vector<std::string> &names) const;
+
+    /** Returns the number of verbs in the table.
+    */
+    size_t size() const
+    {
+        return records.empty() ? 0 : records.size() - 1;
+    }
+
+    /** Searches for a verb by its infinitive.
+        @returns        the identifier of the verb, or NO_VERB if it is
+                        unknown or if 'infinitive' is NULL
+    */
+    VerbId find(const char *infinitive) const;
+
+    /** Searches for a verb by its infinitive.
+        @returns        the identifier of the verb, or NO_VERB
+    */
+    VerbId find(const std::string &infinitive) const
+    {
+        return find(infinitive.c_str());
+    }
+
+    /** Returns the null-terminated infinitive of the given verb.
+    */
+    const char *getInfinitive(VerbId id) const
+    {
+        assert(id < size());
+        return arena.data() + records[id].infinitiveOffset;
+    }
+
+    /** Returns the length in bytes of the infinitive of the given verb.
+    */
+    size_t getInfinitiveLength(VerbId id) const
+    {
+        assert(id < size());
+        return records[id + 1].infinitiveOffset - records[id].infinitiveOffset - 1;
+    }
+
+    /** Returns the flags of the given verb, or 0 if 'id' is NO_VERB.
+    */
+    unsigned getFlags(VerbId id) const
+    {
+        return id == NO_VERB ? 0 : records[id].flags;
+    }
+
+    /** Returns the number of templates of the given verb,
+        or 0 if 'id' is NO_VERB.
+    */
+    size_t getNumTemplates(VerbId id) const
+    {
+        return id == NO_VERB ? 0 : records[id + 1].firstTemplate - records[id].firstTemplate;
+    }
+
+    /** Returns the identifier of the i-th template of the given verb.
+    */
+    unsigned getTemplateId(VerbId id, size_t i) const
+    {
+        assert(i < getNumTemplates(id));
+        return templateIds[records[id].firstTemplate + i];
+    }
+
+    /** Returns the name of the i-th template of the given verb.
+    */
+    const std::string &getTemplateName(VerbId id, size_t i) const
+    {
+        return templateNames[getTemplateId(id, i)];
+    }
+
+    /** Returns the number of distinct templates used by the verbs.
+    */
+    size_t getNumTemplateNames() const { return templateNames.size(); }
+
+    /** Returns the name of a template from its identifier.
+    */
+    const std::string &getTemplateNameById(unsigned templateId) const
+    {
+        assert(templateId < templateNames.size());
+        return templateNames[templateId];
+    }
+
+    /** Searches for a template by its name.
+        @returns        the identifier of the template, or NO_TEMPLATE
+                        if no verb uses it
+    */
+    unsigned findTemplate(const std::string &templateName) const;
+
+    /** Returns the number of verbs that use the given template,
+        or 0 if 'templateId' is NO_TEMPLATE.
+    */
+    size_t getNumVerbsOfTemplate(unsigned templateId) const
+    {
+        if (templateId == NO_TEMPLATE)
+            return 0;
+        assert(templateId < templateNames.size());
+        return templateVerbOffsets[templateId + 1] - templateVerbOffsets[templateId];
+    }
+
+    /** Returns the identifier of the i-th verb that uses the given
+        template.  The verbs of a template are sorted by infinitive.
+    */
+    VerbId getVerbOfTemplate(unsigned templateId, size_t i) const
+    {
+        assert(i < getNumVerbsOfTemplate(templateId));
+        return templateVerbs[templateVerbOffsets[templateId] + i];
+    }
+
+    /** Sets the frequency rank of a verb.  Nothing is done if 'id' is
+        NO_VERB.  Must only be called after build().
+        @param  rank    0 for the most frequent verb, 1 for the next one,
+                        etc., or NO_RANK to remove the verb's rank
+    */
+    void setFrequencyRank(VerbId id, unsigned rank);
+
+    /** Returns the frequency rank of the given verb, or NO_RANK if it
+        has none or if 'id' is NO_VERB.
+    */
+    unsigned getFrequencyRank(VerbId id) const
+    {
+        return id == NO_VERB ? NO_RANK : records[id].frequencyRank;
+    }
+
+    /** Removes the frequency ranks of all the verbs.
+    */
+    void clearFrequencyRanks();
+
+    /** Returns the number of verbs that have a frequency rank.
+    */
+    size_t getNumRankedVerbs() const { return numRankedVerbs; }
+
+    /** Appends the identifiers of the most frequent verbs to a vector.
+        @param  maxVerbs        maximum number of verbs to append
+        @param  ids             vector to which the verbs are appended,
+                                by increasing frequency rank; the verbs
+                                without a rank are not appended
+    */
+    void getMostFrequentVerbs(size_t maxVerbs, std::vector<VerbId> &ids) const;
+
+    /** Returns the approximate number of bytes used by this table.
+    */
+    size_t computeMemoryConsumption() const;
+
+private:
+
+    // The templates of verb 'id' are templateIds[records[id].firstTemplate]
+    // up to templateIds[records[id + 1].firstTemplate], exclusively.
+    // Likewise, the infinitive and its terminating null character end
+    // where the next one begins.  The last record is a sentinel.
+    //
+    struct Record
+    {
+        unsigned infinitiveOffset;  // in 'arena'
+        unsigned firstTemplate;     // in 'templateIds'
+        unsigned flags;
+        unsigned frequencyRank;     // NO_RANK if none
+    };
+
+    // Verb added by addVerb() and not yet packed by build().
+    //
+    struct PendingVerb
+    {
+        std::string infinitive;
+        std::string templateName;
+        unsigned flags;
+
+        bool operator < (const PendingVerb &v) const
+        {
+            if (infinitive != v.infinitive)
+                return infinitive < v.infinitive;
+            return templateName < v.templateName;
+        }
+
+        // Same verb and template, whatever the flags.
+        bool operator == (const PendingVerb &v) const
+        {
+            return infinitive == v.infinitive && templateName == v.templateName;
+        }
+    };
+
+    class RankComparator;
+    friend class RankComparator;
+
+    void buildTemplateIndex();
+
+    std::string arena;  // null-terminated infinitives, in increasing order
+    std::vector<Record> records;
+    std::vector<unsigned short> templateIds;
+    std::vector<std::string> templateNames;  // sorted
+
+    // The verbs of template 't' are templateVerbs[templateVerbOffsets[t]]
+    // up to templateVerbs[templateVerbOffsets[t + 1]], exclusively.
+    //
+    std::vector<unsigned> templateVerbOffsets;
+    std::vector<VerbId> templateVerbs;
+
+    std::vector<PendingVerb> pendingVerbs;
+
+    // Ranks saved by reopen() and set again by build(), by infinitive,
+    // so that they survive the removal and the addition of a verb.
+    //
+    std::vector< std::pair<std::string, unsigned> > pendingRanks;
+    size_t numRankedVerbs;
+};
+
+
+}  // namespace verbiste
+
+
+#endif  /* _H_VerbRecordTable */
@@ -21,10 +21,12 @@
 */
 
 #include <verbiste/FrenchVerbDictionary.h>
+#include <verbiste/DictionaryHolder.h>
 
 #include <verbiste/misc-types.h>
 
 #include <iostream>
+#include <sstream>
 #include <errno.h>
 #include <string.h>
 
@@ -35,10 +37,6 @@ using namespace verbiste;
 #define free @FORBIDDEN@
 
 
-typedef vector<string> VS;
-typedef vector<VS> VVS;
-
-
 const Verbiste_ModeTense verbiste_valid_modes_and_tenses[] =
 {
     { VERBISTE_INFINITIVE_MODE,   VERBISTE_PRESENT_TENSE },
@@ -65,8 +63,12 @@ const Verbiste_ModeTense verbiste_valid_modes_and_tenses[] =
 
 
 
-static FrenchVerbDictionary *fvd = NULL;
+// Each function works on the dictionary that is current when it starts,
+// so that a reload can take place while other threads use the API.
+//
+static DictionaryHolder *holder = NULL;
 static string constructionLogicError;
+static string reloadError;
 
 
 /*  Returns a dynamically allocated copy of the given C string.
@@ -101,10 +103,28 @@ strnew(const string &s)
 }
 
 
+/*  Returns a dynamically allocated, '\0'-terminated copy of the
+    given characters.
+    @param        s             characters to copy (need not be
+                                '\0'-terminated)
+    @param        len           number of characters to copy
+    @returns                    a pointer as with strnew(const char *)
+*/
+inline
+char *
+strnew(const char *s, size_t len)
+{
+    char *copy = new char[len + 1];
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+
 int
 verbiste_init(const char *conjugation_filename, const char *verbs_filename, const char *lang_code)
 {
-    if (fvd != NULL)
+    if (holder != NULL)
         return -1;
     if (lang_code == NULL)
         lang_code = "";
@@ -112,7 +132,7 @@ verbiste_init(const char *conjugation_filename, const char *verbs_filename, cons
     try
     {
         FrenchVerbDictionary::Language lang = FrenchVerbDictionary::parseLanguageCode(lang_code);
-        fvd = new FrenchVerbDictionary(conjugation_filename, verbs_filename, false, lang);
+        holder = new DictionaryHolder(conjugation_filename, verbs_filename, false, lang);
     }
     catch (logic_error &e)
     {
@@ -134,15 +154,103 @@ verbiste_get_init_error()
 int
 verbiste_close(void)
 {
-    if (fvd == NULL)
+    if (holder == NULL)
+        return -1;
+
+    delete holder;
+    holder = NULL;
+    return 0;
+}
+
+
+int
+verbiste_start_reload(void)
+{
+    if (holder == NULL)
         return -1;
 
-    delete fvd;
-    fvd = NULL;
+    try
+    {
+        if (!holder->startReload())
+            return -3;
+    }
+    catch (logic_error &e)
+    {
+        reloadError = e.what();
+        return -2;
+    }
     return 0;
 }
 
 
+int
+verbiste_wait_for_reload(void)
+{
+    if (holder == NULL)
+        return -1;
+
+    if (holder->waitForReload(reloadError))
+        return 0;
+    return reloadError.empty() ? -3 : -2;  // the error is empty if no reload
+}
+
+
+const char *
+verbiste_get_reload_error()
+{
+    return reloadError.c_str();
+}
+
+
+int
+verbiste_enable_stats(int enable)
+{
+    if (holder == NULL)
+        return -1;
+
+    holder->get()->getStats().setEnabled(enable != 0);
+    return 0;
+}
+
+
+int
+verbiste_get_stats(Verbiste_Stats *stats)
+{
+    if (holder == NULL || stats == NULL)
+        return -1;
+
+    DictionaryHolder::Handle fvd = holder->get();
+    const DictionaryStats &s = fvd->getStats();
+    stats->deconjugate_calls = s.getCount(DictionaryStats::DECONJUGATE_CALLS);
+    stats->deconjugate_hits = s.getCount(DictionaryStats::DECONJUGATE_HITS);
+    stats->filter_rejects = s.getCount(DictionaryStats::FILTER_REJECTS);
+    stats->states_visited = s.getCount(DictionaryStats::STATES_VISITED);
+    stats->template_probes = s.getCount(DictionaryStats::TEMPLATE_PROBES);
+    stats->tenses_generated = s.getCount(DictionaryStats::TENSES_GENERATED);
+    stats->deconjugate_ns = s.getTotalNanoseconds(DictionaryStats::DECONJUGATE);
+    stats->conjugate_ns = s.getTotalNanoseconds(DictionaryStats::GENERATE_TENSE);
+
+    // The phases that are part of others are not added.
+    stats->load_ns = 0;
+    for (int i = 0; i < DictionaryStats::NUM_LOAD_PHASES; ++i)
+        if (i != DictionaryStats::ACCENT_VARIANTS && i != DictionaryStats::TRIE_INSERT)
+            stats->load_ns += s.getLoadNanoseconds(DictionaryStats::LoadPhase(i));
+    return 0;
+}
+
+
+char *
+verbiste_get_stats_report(void)
+{
+    if (holder == NULL)
+        return NULL;
+
+    stringstream report;
+    holder->get()->getStats().print(report);
+    return strnew(report.str());
+}
+
+
 void
 verbiste_free_string(char *str)
 {
@@ -195,7 +303,7 @@ Verbiste_ModeTensePersonNumber *
 verbiste_deconjugate(const char *verb)
 {
     vector<InflectionDesc> vec;
-    fvd->deconjugate(verb, vec);
+    holder->get()->deconjugate(verb, vec);
     return createModeTensePersonNumberArray(vec);
 }
 
@@ -215,22 +323,24 @@ verbiste_free_mtpn_array(Verbiste_ModeTensePersonNumber *array)
 
 static
 int
-generateTense(VVS &conjug,
+generateTense(const FrenchVerbDictionary &fvd,
+                ConjugationBuffer &conjug,
                 const char *infinitive,
                 const char *templateName,
                 Verbiste_Mode mode,
                 Verbiste_Tense tense,
                 bool include_pronouns)
 {
-    const TemplateSpec *templ = fvd->getTemplate(templateName);
+    const TemplateSpec *templ = fvd.getTemplate(templateName);
     if (templ == NULL)
         return -2;
     string radical = FrenchVerbDictionary::getRadical(infinitive, templateName);
 
-    fvd->generateTense(radical, *templ, (Mode) mode, (Tense) tense, conjug,
-                        include_pronouns,
-                        fvd->isVerbStartingWithAspirateH(infinitive),
-                        false);
+    if (!fvd.generateTenseInto(radical, *templ, (Mode) mode, (Tense) tense, conjug,
+                               include_pronouns,
+                               fvd.isVerbStartingWithAspirateH(infinitive),
+                               false))
+        conjug.endTense();  // unknown tense: no persons
     return 0;
 }
 
@@ -240,15 +350,17 @@ verbiste_get_verb_template_array(const char *infinitive_verb)
 {
     if (infinitive_verb == NULL)
         return NULL;
-    const std::set<std::string> &templateSet = fvd->getVerbTemplateSet(infinitive_verb);
-    if (templateSet.empty())
+    DictionaryHolder::Handle fvd = holder->get();
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    VerbRecordTable::VerbId id = knownVerbs.find(infinitive_verb);
+    size_t numTemplates = knownVerbs.getNumTemplates(id);
+    if (numTemplates == 0)
         return NULL;
 
-    Verbiste_TemplateArray a = new char *[templateSet.size() + 1];
+    Verbiste_TemplateArray a = new char *[numTemplates + 1];
     size_t i = 0;
-    for (std::set<std::string>::const_iterator it = templateSet.begin();
-                                               it != templateSet.end(); ++it, ++i)
-        a[i] = strnew(it->c_str());
+    for ( ; i < numTemplates; ++i)
+        a[i] = strnew(knownVerbs.getTemplateName(id, i).c_str());
     a[i] = NULL;
     return a;
 }
@@ -272,6 +384,45 @@ verbiste_free_verb_template_array(Verbiste_TemplateArray array)
 }
 
 
+size_t
+verbiste_get_template_verb_count(const char *template_name)
+{
+    if (template_name == NULL)
+        return 0;
+    DictionaryHolder::Handle fvd = holder->get();
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    return knownVerbs.getNumVerbsOfTemplate(knownVerbs.findTemplate(template_name));
+}
+
+
+Verbiste_InfinitiveArray
+verbiste_get_template_verb_array(const char *template_name)
+{
+    if (template_name == NULL)
+        return NULL;
+    DictionaryHolder::Handle fvd = holder->get();
+    const VerbRecordTable &knownVerbs = fvd->getKnownVerbs();
+    unsigned templateId = knownVerbs.findTemplate(template_name);
+    size_t numVerbs = knownVerbs.getNumVerbsOfTemplate(templateId);
+    if (numVerbs == 0)
+        return NULL;
+
+    Verbiste_InfinitiveArray a = new char *[numVerbs + 1];
+    size_t i = 0;
+    for ( ; i < numVerbs; ++i)
+        a[i] = strnew(knownVerbs.getInfinitive(knownVerbs.getVerbOfTemplate(templateId, i)));
+    a[i] = NULL;
+    return a;
+}
+
+
+void
+verbiste_free_template_verb_array(Verbiste_InfinitiveArray array)
+{
+    free_string_array(array);
+}
+
+
 Verbiste_PersonArray
 verbiste_conjugate(const char *infinitive_verb,
                    const char *template_name,
@@ -279,22 +430,22 @@ verbiste_conjugate(const char *infinitive_verb,
                    const Verbiste_Tense tense,
                    int include_pronouns)
 {
-    VVS tenseConjug;
-    if (::generateTense(tenseConjug, infinitive_verb, template_name, mode, tense,
+    ConjugationBuffer tenseConjug;
+    if (::generateTense(*holder->get(), tenseConjug, infinitive_verb, template_name, mode, tense,
                                                 include_pronouns != 0) != 0)
         return NULL;
 
-    size_t numPersons = tenseConjug.size();
+    size_t numPersons = tenseConjug.getNumPersons(0);
     Verbiste_PersonArray personArray =
                                 new Verbiste_InflectionArray[numPersons + 1];
 
     for (size_t i = 0; i < numPersons; i++)
     {
-        const VS &inflections = tenseConjug[i];
-        size_t numInf = inflections.size();
+        size_t numInf = tenseConjug.getNumForms(0, i);
         Verbiste_InflectionArray infArray = new char *[numInf + 1];
         for (size_t j = 0; j < numInf; j++)
-            infArray[j] = strnew(inflections[j]);
+            infArray[j] = strnew(tenseConjug.getFormData(0, i, j),
+                                 tenseConjug.getFormLength(0, i, j));
         infArray[numInf] = NULL;
         personArray[i] = infArray;
     }
@@ -67,7 +67,13 @@ typedef enum
     VERBISTE_PASSIVE_TENSE,
     VERBISTE_IMPERATIVE_ACTIVE_TENSE,
     VERBISTE_IMPERATIVE_PASSIVE_TENSE,
-    VERBISTE_PAST_PERFECT
+    VERBISTE_PAST_PERFECT,
+
+    // Compound tenses (auxiliary and past participle):
+    VERBISTE_COMPOUND_PAST_TENSE,
+    VERBISTE_PLUPERFECT_TENSE,
+    VERBISTE_PAST_ANTERIOR_TENSE,
+    VERBISTE_FUTURE_ANTERIOR_TENSE
 
 /** Valid conjugation tenses. */
 } Verbiste_Tense;
@@ -77,6 +83,11 @@ typedef enum
 */
 typedef char **Verbiste_TemplateArray;
 
+/** List of infinitives (e.g., "aimer").
+    The last character pointer in an array of this type is NULL.
+*/
+typedef char **Verbiste_InfinitiveArray;
+
 
 typedef struct
 {
@@ -153,6 +164,81 @@ const char *verbiste_get_init_error();
 int verbiste_close(void);
 
 
+/** Starts reloading the dictionary from the files given to verbiste_init().
+    The reload takes place in a background thread.  The other functions
+    of this library can be called meanwhile: they use the previous
+    dictionary until the new one is ready.
+    @returns                    0 if the reload was started,
+                                -1 if the object has not been initialized,
+                                -2 if the thread could not be created
+                                (see verbiste_get_reload_error()), or
+                                -3 if a reload is already in progress
+*/
+int verbiste_start_reload(void);
+
+
+/** Waits for the end of the reload started by verbiste_start_reload().
+    @returns                    0 if the new dictionary is now in use,
+                                -1 if the object has not been initialized,
+                                -2 if the reload failed, in which case the
+                                previous dictionary remains in use and
+                                verbiste_get_reload_error() describes the
+                                failure, or
+                                -3 if no reload had been started
+*/
+int verbiste_wait_for_reload(void);
+
+
+/** Gets a text description of the last failure of a reload.
+    This function must only be called if verbiste_start_reload() or
+    verbiste_wait_for_reload() has returned -2.
+*/
+const char *verbiste_get_reload_error();
+
+
+/** Counters and latencies of the dictionary in use.
+    The query fields are only updated after verbiste_enable_stats(1).
+    The times are in nanoseconds.
+*/
+typedef struct
+{
+  unsigned long deconjugate_calls;
+  unsigned long deconjugate_hits;     /* calls that found at least one verb */
+  unsigned long filter_rejects;       /* calls rejected by the verb form filter */
+  unsigned long states_visited;       /* states of the automata visited */
+  unsigned long template_probes;      /* templates checked against a termination */
+  unsigned long tenses_generated;
+  unsigned long long deconjugate_ns;  /* total latency of the deconjugations */
+  unsigned long long conjugate_ns;    /* total latency of the tenses generated */
+  unsigned long long load_ns;         /* time taken to load the dictionary */
+} Verbiste_Stats;
+
+
+/** Starts or stops counting and timing the queries.
+    The setting is kept when the dictionary is reloaded.
+    @param  enable              non-zero to start, zero to stop
+    @returns                    0 on success, or -1 if the object has not
+                                been initialized
+*/
+int verbiste_enable_stats(int enable);
+
+
+/** Gets the statistics of the dictionary in use.
+    @param  stats               structure to fill
+    @returns                    0 on success, or -1 if the object has not
+                                been initialized
+*/
+int verbiste_get_stats(Verbiste_Stats *stats);
+
+
+/** Describes the statistics of the dictionary in use as a table.
+    @returns                    a dynamically allocated string that must be
+                                freed with verbiste_free_string(), or NULL
+                                if the object has not been initialized
+*/
+char *verbiste_get_stats_report(void);
+
+
 /** Frees the memory associated with the given string.
     The string to deallocate must have been received from a function
     of this API that specifically requires the deallocation to be
@@ -216,6 +302,33 @@ Verbiste_TemplateArray verbiste_get_verb_template_array(const char *infinitive_v
 void verbiste_free_verb_template_array(Verbiste_TemplateArray array);
 
 
+/** Returns the number of known verbs that use the given conjugation template.
+    @param  template_name       name of the template (e.g., "aim:er")
+    @returns                    the number of verbs, or 0 if the template
+                                is unknown or used by no verb
+*/
+size_t verbiste_get_template_verb_count(const char *template_name);
+
+
+/** Returns the list of known verbs that use the given conjugation template.
+    @param  template_name       name of the template (e.g., "aim:er")
+    @returns                    an array of infinitives sorted in increasing
+                                order, the last element being a null pointer;
+                                a NULL pointer is returned if no verb uses
+                                the template; this array must be passed to
+                                verbiste_free_template_verb_array() to free
+                                the memory
+*/
+Verbiste_InfinitiveArray verbiste_get_template_verb_array(const char *template_name);
+
+
+/** Frees the memory allocated by verbiste_get_template_verb_array().
+    @param  array               an array returned by verbiste_get_template_verb_array();
+                                can be NULL: this function does nothing in such a case
+*/
+void verbiste_free_template_verb_array(Verbiste_InfinitiveArray array);
+
+
 /** Conjugates a verb in a certain mode and tense.
     @param  infinitiveVerb      Latin-1 infinitive form of the verb
                                 to be conjugated
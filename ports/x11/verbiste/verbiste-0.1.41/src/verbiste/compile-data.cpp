@@ -0,0 +1,594 @@
+/*  $Id$
+    compile-data.cpp - Converts a pair of XML data files into C++ source
+
+    verbiste - French conjugation system
+    Copyright (C) 2003-2014 Pierre Sarrazin <http://sarrazip.com/>
+
+    This program is free software; you can redistribute it and/or
+    modify it under the terms of the GNU General Public License
+    as published by the Free Software Foundation; either version 2
+    of the License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+    02110-1301, USA.
+*/
+
+/*  Usage: compile-data LANG CONJUGATION.xml VERBS.xml > compiled-data-LANG.cpp
+
+    Writes to standard output the definition of the CompiledDictionary
+    object named compiledDictionaryXx, where Xx is LANG with an initial
+    capital.  The documents are walked like FrenchVerbDictionary does
+    when it reads them, but their contents are not interpreted: mode
+    and tense names, for example, are checked when the dictionary is
+    constructed from the compiled data.
+
+    The indexes are those of two FrenchVerbDictionary objects constructed
+    from the same documents, with and without the unaccented variants.
+    The frequency ranks are those that these objects load from the
+    verb-frequencies-LANG.txt file next to VERBS.xml, if any.
+    This program is linked with the sources of the dictionary, but not
+    with the compiled data, which it defines as empty below.
+*/
+
+#include "CompiledDictionary.h"
+#include "FrenchVerbDictionary.h"
+
+#include <libxml/xmlmemory.h>
+#include <libxml/parser.h>
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace verbiste;
+
+
+static const char *commandName = "compile-data";
+
+
+namespace verbiste {
+
+
+// Not used: the dictionaries are constructed from the XML documents.
+extern const CompiledDictionary compiledDictionaryFr = { "fr", "", 1, NULL, 0, NULL, 0, NULL, 0, NULL, NULL };
+extern const CompiledDictionary compiledDictionaryIt = { "it", "", 1, NULL, 0, NULL, 0, NULL, 0, NULL, NULL };
+extern const CompiledDictionary compiledDictionaryEl = { "el", "", 1, NULL, 0, NULL, 0, NULL, 0, NULL, NULL };
+
+
+static bool
+equal(const xmlChar *a, const char *b)
+{
+    return xmlStrcmp(a, reinterpret_cast<const xmlChar *>(b)) == 0;
+}
+
+
+static string
+getNodeText(xmlDocPtr doc, xmlNodePtr node)
+{
+    xmlChar *s = xmlNodeListGetString(doc, node, 1);
+    if (s == NULL)
+        return string();
+    string result = reinterpret_cast<char *>(s);
+    xmlFree(s);
+    return result;
+}
+
+
+class DictionaryCompiler
+{
+public:
+
+    DictionaryCompiler()
+      : arena(), offsets(), events(), verbs(), rankedVerbs(),
+        indexes(), indexesWithoutAccents()
+    {
+    }
+
+    void readConjugation(xmlDocPtr doc, const string &langCode) throw(logic_error);
+
+    void readVerbs(xmlDocPtr doc, const string &langCode) throw(logic_error);
+
+    void addIndexes(const FrenchVerbDictionary &fvd, bool includeWithoutAccents);
+
+    void addFrequencyRanks(const FrenchVerbDictionary &fvd);
+
+    void write(ostream &out, const string &langCode) const;
+
+private:
+
+    struct AutomatonArrays
+    {
+        AutomatonArrays()
+          : states(), transitions(), valueLists(), initialState(0), numTrieStates(0) {}
+
+        vector<CompiledDictionary::State> states;
+        vector<CompiledDictionary::Transition> transitions;
+        vector<CompiledDictionary::ValueList> valueLists;
+        unsigned initialState;
+        size_t numTrieStates;
+    };
+
+    // Contents of a CompiledDictionary::Indexes.
+    struct IndexArrays
+    {
+        IndexArrays()
+          : numSlots(0), numSlotSets(0), radicals(), radicalValues(),
+            terminations(), terminationValues(), filterWords(), numFilterKeys(0) {}
+
+        size_t numSlots;
+        size_t numSlotSets;
+        AutomatonArrays radicals;
+        vector<CompiledDictionary::RadicalValue> radicalValues;
+        AutomatonArrays terminations;
+        vector<CompiledDictionary::TerminationValue> terminationValues;
+        vector<unsigned long long> filterWords;
+        size_t numFilterKeys;
+    };
+
+    unsigned addString(const string &s);
+    void addEvent(CompiledDictionary::EventType type, const string &s);
+    template <class T>
+    static void copyAutomaton(const Dawg<T, char> &dawg, AutomatonArrays &arrays);
+    static void writeAutomaton(ostream &out, const string &name,
+                               const AutomatonArrays &arrays);
+    static void writeIndexes(ostream &out, const string &name,
+                             const IndexArrays &arrays);
+
+    string arena;
+    map<string, unsigned> offsets;  // offset in 'arena' of each string
+    vector<CompiledDictionary::Event> events;
+    vector<CompiledDictionary::Verb> verbs;
+    vector<unsigned> rankedVerbs;  // offsets of infinitives in 'arena'
+    IndexArrays indexes;
+    IndexArrays indexesWithoutAccents;
+};
+
+
+// Returns the offset of 's' in the arena, adding 's' if needed.
+//
+unsigned
+DictionaryCompiler::addString(const string &s)
+{
+    map<string, unsigned>::const_iterator it = offsets.find(s);
+    if (it != offsets.end())
+        return it->second;
+
+    unsigned offset = unsigned(arena.length());
+    arena.append(s.c_str(), s.length() + 1);
+    offsets.insert(make_pair(s, offset));
+    return offset;
+}
+
+
+void
+DictionaryCompiler::addEvent(CompiledDictionary::EventType type, const string &s)
+{
+    CompiledDictionary::Event e;
+    e.type = (unsigned char) type;
+    e.string = addString(s);
+    events.push_back(e);
+}
+
+
+// Follows the walk of FrenchVerbDictionary::readConjugation().
+//
+void
+DictionaryCompiler::readConjugation(xmlDocPtr doc, const string &langCode) throw(logic_error)
+{
+    xmlNodePtr rootNodePtr = xmlDocGetRootElement(doc);
+    if (rootNodePtr == NULL)
+        throw logic_error("empty conjugation document");
+    if (!equal(rootNodePtr->name, ("conjugation-" + langCode).c_str()))
+        throw logic_error("wrong top node in conjugation document");
+
+    for (xmlNodePtr templ = rootNodePtr->xmlChildrenNode; templ != NULL; templ = templ->next)
+    {
+        if (!equal(templ->name, "template"))
+            continue;
+
+        xmlChar *name = xmlGetProp(templ, reinterpret_cast<const xmlChar *>("name"));
+        string tname = (name != NULL ? reinterpret_cast<char *>(name) : "");
+        xmlFree(name);
+        if (tname.empty())
+            throw logic_error("missing template name attribute");
+        addEvent(CompiledDictionary::TEMPLATE, tname);
+
+        for (xmlNodePtr mode = templ->xmlChildrenNode; mode != NULL; mode = mode->next)
+        {
+            if (equal(mode->name, "text") || equal(mode->name, "comment"))
+                continue;
+            addEvent(CompiledDictionary::MODE, reinterpret_cast<const char *>(mode->name));
+
+            for (xmlNodePtr tense = mode->xmlChildrenNode; tense != NULL; tense = tense->next)
+            {
+                if (equal(tense->name, "text") || equal(tense->name, "comment"))
+                    continue;
+                addEvent(CompiledDictionary::TENSE, reinterpret_cast<const char *>(tense->name));
+
+                for (xmlNodePtr person = tense->xmlChildrenNode; person != NULL; person = person->next)
+                {
+                    if (!equal(person->name, "p"))
+                        continue;
+                    addEvent(CompiledDictionary::PERSON, "");
+
+                    for (xmlNodePtr inf = person->xmlChildrenNode; inf != NULL; inf = inf->next)
+                        addEvent(CompiledDictionary::INFLECTION,
+                                 getNodeText(doc, inf->xmlChildrenNode));
+                }
+            }
+        }
+    }
+}
+
+
+// Follows the walk of FrenchVerbDictionary::readVerbs().
+//
+void
+DictionaryCompiler::readVerbs(xmlDocPtr doc, const string &langCode) throw(logic_error)
+{
+    xmlNodePtr rootNodePtr = xmlDocGetRootElement(doc);
+    if (rootNodePtr == NULL)
+        throw logic_error("empty verbs document");
+    if (!equal(rootNodePtr->name, ("verbs-" + langCode).c_str()))
+        throw logic_error("wrong top node in verbs document");
+
+    for (xmlNodePtr v = rootNodePtr->xmlChildrenNode; v != NULL; v = v->next)
+    {
+        if (equal(v->name, "text") || equal(v->name, "comment"))
+            continue;
+
+        xmlNodePtr i = v->xmlChildrenNode;
+        if (i == NULL || i->xmlChildrenNode == NULL)
+            throw logic_error("missing <i> node");
+        string infinitive = getNodeText(doc, i->xmlChildrenNode);
+
+        if (i->next == NULL)
+            throw logic_error("unexpected end after <i> node");
+        xmlNodePtr t = i->next->next;
+        if (t == NULL)
+            throw logic_error("missing <t> node");
+        string tname = getNodeText(doc, t->xmlChildrenNode);
+
+        CompiledDictionary::Verb verb;
+        verb.infinitive = addString(infinitive);
+        verb.templateName = addString(tname);
+        verb.aspirateH = (t->next != NULL && t->next->next != NULL);
+        verbs.push_back(verb);
+    }
+}
+
+
+// Copies the frequency ranks of a dictionary constructed from the documents.
+// The ranks go from 0 to the number of ranked verbs minus one.
+//
+void
+DictionaryCompiler::addFrequencyRanks(const FrenchVerbDictionary &fvd)
+{
+    vector<string> infinitives;
+    fvd.getMostFrequentVerbs(fvd.getKnownVerbs().getNumRankedVerbs(), infinitives);
+    rankedVerbs.clear();
+    for (vector<string>::const_iterator it = infinitives.begin(); it != infinitives.end(); ++it)
+        rankedVerbs.push_back(addString(*it));
+}
+
+
+// Copies the indexes of a dictionary constructed from the documents.
+// The strings that they refer to are added to the arena.
+//
+void
+DictionaryCompiler::addIndexes(const FrenchVerbDictionary &fvd, bool includeWithoutAccents)
+{
+    IndexArrays &arrays = (includeWithoutAccents ? indexesWithoutAccents : indexes);
+    arrays.numSlots = fvd.slotTable.getNumSlots();
+    arrays.numSlotSets = fvd.slotTable.getNumSets();
+
+    // Number the templates like FrenchVerbDictionary::loadCompiledIndexes().
+    //
+    map<string, unsigned> templateNos;
+    for (SharedConjugationSystem::const_iterator it = fvd.conjugSys.begin();
+                                                 it != fvd.conjugSys.end(); ++it)
+        templateNos.insert(make_pair(it->first, unsigned(templateNos.size())));
+    map<string, unsigned> inflectionTableNos;
+    for (SharedInflectionTable::const_iterator it = fvd.inflectionTable.begin();
+                                               it != fvd.inflectionTable.end(); ++it)
+        inflectionTableNos.insert(make_pair(it->first, unsigned(inflectionTableNos.size())));
+
+    copyAutomaton(fvd.verbDawg, arrays.radicals);
+    for (size_t i = 0; i < fvd.verbDawg.values.size(); ++i)
+    {
+        const vector<FrenchVerbDictionary::TrieValue> &list = fvd.verbDawg.values[i];
+        CompiledDictionary::ValueList vl = { unsigned(arrays.radicalValues.size()),
+                                             unsigned(list.size()) };
+        arrays.radicals.valueLists.push_back(vl);
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            CompiledDictionary::RadicalValue v;
+            v.templateNo = templateNos[*list[j].templateName];
+            v.correctRadical = addString(list[j].correctVerbRadical);
+            arrays.radicalValues.push_back(v);
+        }
+    }
+
+    copyAutomaton(fvd.terminationDawg, arrays.terminations);
+    for (size_t i = 0; i < fvd.terminationDawg.values.size(); ++i)
+    {
+        const vector<FrenchVerbDictionary::TerminationValue> &list =
+                                                fvd.terminationDawg.values[i];
+        CompiledDictionary::ValueList vl = { unsigned(arrays.terminationValues.size()),
+                                             unsigned(list.size()) };
+        arrays.terminations.valueLists.push_back(vl);
+        for (size_t j = 0; j < list.size(); ++j)
+        {
+            CompiledDictionary::TerminationValue v;
+            v.templateNo = inflectionTableNos[*list[j].templateName];
+            v.slotSet = list[j].slotSet;
+            arrays.terminationValues.push_back(v);
+        }
+    }
+
+    const BloomFilter &filter = fvd.verbFormFilter;
+    arrays.filterWords.assign(filter.getWords(), filter.getWords() + filter.getNumWords());
+    arrays.numFilterKeys = filter.getNumKeys();
+}
+
+
+//static
+template <class T>
+void
+DictionaryCompiler::copyAutomaton(const Dawg<T, char> &dawg, AutomatonArrays &arrays)
+{
+    for (size_t i = 0; i < dawg.states.size(); ++i)
+    {
+        CompiledDictionary::State state;
+        state.firstTransition = dawg.states[i].firstTransition;
+        state.numTransitions = dawg.states[i].numTransitions;
+        state.valueIndex = dawg.states[i].valueIndex;
+        arrays.states.push_back(state);
+    }
+    for (size_t i = 0; i < dawg.transitions.size(); ++i)
+    {
+        CompiledDictionary::Transition t;
+        t.label = (unsigned char) dawg.transitions[i].label;
+        t.target = dawg.transitions[i].target;
+        arrays.transitions.push_back(t);
+    }
+    arrays.initialState = dawg.initialState;
+    arrays.numTrieStates = dawg.getNumTrieStates();
+}
+
+
+// Writes the arrays of an automaton, whose names start with 'name',
+// followed by the initializer of the Automaton structure, without
+// a newline.
+//
+//static
+void
+DictionaryCompiler::writeAutomaton(ostream &out, const string &name,
+                                   const AutomatonArrays &arrays)
+{
+    out << "static const CompiledDictionary::State " << name << "States[] =\n{\n";
+    for (size_t i = 0; i < arrays.states.size(); ++i)
+    {
+        const CompiledDictionary::State &state = arrays.states[i];
+        out << "    { " << state.firstTransition << ", " << state.numTransitions
+            << ", " << state.valueIndex << "u },\n";
+    }
+    out << "};\n\n\n";
+
+    out << "static const CompiledDictionary::Transition " << name << "Transitions[] =\n{\n";
+    for (size_t i = 0; i < arrays.transitions.size(); ++i)
+        out << "    { " << unsigned(arrays.transitions[i].label)
+            << ", " << arrays.transitions[i].target << " },\n";
+    out << "};\n\n\n";
+
+    out << "static const CompiledDictionary::ValueList " << name << "ValueLists[] =\n{\n";
+    for (size_t i = 0; i < arrays.valueLists.size(); ++i)
+        out << "    { " << arrays.valueLists[i].first
+            << ", " << arrays.valueLists[i].count << " },\n";
+    out << "};\n\n\n";
+}
+
+
+// Writes the arrays of the indexes named 'name', followed by their
+// Indexes structure.
+//
+//static
+void
+DictionaryCompiler::writeIndexes(ostream &out, const string &name,
+                                 const IndexArrays &arrays)
+{
+    writeAutomaton(out, name + "Radical", arrays.radicals);
+    out << "static const CompiledDictionary::RadicalValue " << name << "RadicalValues[] =\n{\n";
+    for (size_t i = 0; i < arrays.radicalValues.size(); ++i)
+        out << "    { " << arrays.radicalValues[i].templateNo
+            << ", " << arrays.radicalValues[i].correctRadical << " },\n";
+    out << "};\n\n\n";
+
+    writeAutomaton(out, name + "Termination", arrays.terminations);
+    out << "static const CompiledDictionary::TerminationValue " << name << "TerminationValues[] =\n{\n";
+    for (size_t i = 0; i < arrays.terminationValues.size(); ++i)
+        out << "    { " << arrays.terminationValues[i].templateNo
+            << ", " << arrays.terminationValues[i].slotSet << " },\n";
+    out << "};\n\n\n";
+
+    out << "static const unsigned long long " << name << "FilterWords[] =\n{\n";
+    for (size_t i = 0; i < arrays.filterWords.size(); ++i)
+    {
+        char word[32];
+        sprintf(word, "0x%016llxULL,", arrays.filterWords[i]);
+        out << (i % 4 == 0 ? "    " : " ") << word << (i % 4 == 3 ? "\n" : "");
+    }
+    if (arrays.filterWords.size() % 4 != 0)
+        out << "\n";
+    out << "};\n\n\n";
+
+    const char *automata[] = { "Radical", "Termination" };
+    const AutomatonArrays *automatonArrays[] = { &arrays.radicals, &arrays.terminations };
+    out << "static const CompiledDictionary::Indexes " << name << " =\n"
+        << "{\n"
+        << "    " << arrays.numSlots << ", " << arrays.numSlotSets << ",\n";
+    for (size_t k = 0; k < 2; ++k)
+    {
+        const string prefix = name + automata[k];
+        out << "    {\n"
+            << "        " << prefix << "States, sizeof(" << prefix << "States) / sizeof("
+                          << prefix << "States[0]),\n"
+            << "        " << prefix << "Transitions, sizeof(" << prefix << "Transitions) / sizeof("
+                          << prefix << "Transitions[0]),\n"
+            << "        " << prefix << "ValueLists, sizeof(" << prefix << "ValueLists) / sizeof("
+                          << prefix << "ValueLists[0]),\n"
+            << "        " << automatonArrays[k]->initialState << ", "
+                          << automatonArrays[k]->numTrieStates << "\n"
+            << "    },\n"
+            << "    " << prefix << "Values,\n";
+    }
+    out << "    " << name << "FilterWords, sizeof(" << name << "FilterWords) / sizeof("
+                  << name << "FilterWords[0]), " << arrays.numFilterKeys << "\n"
+        << "};\n\n\n";
+}
+
+
+void
+DictionaryCompiler::write(ostream &out, const string &langCode) const
+{
+    string suffix = langCode;
+    suffix[0] = char(toupper(suffix[0]));
+
+    out << "// Generated by " << commandName << ".  Do not edit.\n"
+        << "\n"
+        << "#include \"CompiledDictionary.h\"\n"
+        << "\n"
+        << "namespace verbiste {\n"
+        << "\n"
+        << "\n";
+
+    // Each string on its own line.  Octal escapes always have three
+    // digits, so that they cannot absorb a following digit.
+    //
+    out << "static const char arena[] =\n\"";
+    static const char octal[] = "01234567";
+    for (string::size_type i = 0; i < arena.length(); ++i)
+    {
+        unsigned char c = (unsigned char) arena[i];
+        if (c == '\0')
+        {
+            out << (i + 1 < arena.length() ? "\\000\"\n\"" : "\"");
+            continue;
+        }
+        if (c == '"' || c == '\\')
+            out << '\\' << char(c);
+        else if (c >= 0x20 && c < 0x7F && c != '?')  // '?' could form a trigraph
+            out << char(c);
+        else
+            out << '\\' << octal[c >> 6] << octal[(c >> 3) & 7] << octal[c & 7];
+    }
+    if (arena.empty())
+        out << '"';
+    out << ";\n\n\n";
+
+    out << "static const CompiledDictionary::Event events[] =\n{\n";
+    for (size_t i = 0; i < events.size(); ++i)
+        out << "    { " << unsigned(events[i].type) << ", " << events[i].string << " },\n";
+    out << "};\n\n\n";
+
+    out << "static const CompiledDictionary::Verb verbs[] =\n{\n";
+    for (size_t i = 0; i < verbs.size(); ++i)
+        out << "    { " << verbs[i].infinitive << ", " << verbs[i].templateName
+            << ", " << unsigned(verbs[i].aspirateH) << " },\n";
+    out << "};\n\n\n";
+
+    // A zero-length array is not valid C++, so the list ends with
+    // an entry that is not counted.
+    //
+    out << "static const unsigned rankedVerbs[] =\n{\n";
+    for (size_t i = 0; i < rankedVerbs.size(); ++i)
+        out << "    " << rankedVerbs[i] << ",\n";
+    out << "    0\n};\n\n\n";
+
+    writeIndexes(out, "indexes", indexes);
+    writeIndexes(out, "indexesWithoutAccents", indexesWithoutAccents);
+
+    out << "extern const CompiledDictionary compiledDictionary" << suffix << " =\n"
+        << "{\n"
+        << "    \"" << langCode << "\",\n"
+        << "    arena, sizeof(arena),\n"
+        << "    events, sizeof(events) / sizeof(events[0]),\n"
+        << "    verbs, sizeof(verbs) / sizeof(verbs[0]),\n"
+        << "    rankedVerbs, " << rankedVerbs.size() << ",\n"
+        << "    &indexes,\n"
+        << "    &indexesWithoutAccents\n"
+        << "};\n"
+        << "\n"
+        << "\n"
+        << "}  // namespace verbiste\n";
+}
+
+
+}  // namespace verbiste
+
+
+int
+main(int argc, char *argv[])
+{
+    if (argc != 4)
+    {
+        cerr << "Usage: " << commandName << " LANG CONJUGATION.xml VERBS.xml\n";
+        return EXIT_FAILURE;
+    }
+
+    const string langCode = argv[1];
+    const char *conjugationFilename = argv[2];
+    const char *verbsFilename = argv[3];
+
+    DictionaryCompiler compiler;
+    try
+    {
+        xmlDocPtr conjDoc = xmlParseFile(conjugationFilename);
+        if (conjDoc == NULL)
+            throw logic_error("could not parse " + string(conjugationFilename));
+        compiler.readConjugation(conjDoc, langCode);
+        xmlFreeDoc(conjDoc);
+
+        xmlDocPtr verbsDoc = xmlParseFile(verbsFilename);
+        if (verbsDoc == NULL)
+            throw logic_error("could not parse " + string(verbsFilename));
+        compiler.readVerbs(verbsDoc, langCode);
+        xmlFreeDoc(verbsDoc);
+
+        // Keep the constructor from adding the verbs of
+        // $HOME/.verbiste to those of the documents.
+        //
+        unsetenv("HOME");
+
+        FrenchVerbDictionary::Language lang = FrenchVerbDictionary::parseLanguageCode(langCode);
+        for (int includeWithoutAccents = 0; includeWithoutAccents < 2; ++includeWithoutAccents)
+        {
+            FrenchVerbDictionary fvd(conjugationFilename, verbsFilename,
+                                     includeWithoutAccents != 0, lang);
+            compiler.addIndexes(fvd, includeWithoutAccents != 0);
+            if (includeWithoutAccents == 0)
+                compiler.addFrequencyRanks(fvd);
+        }
+    }
+    catch (logic_error &e)
+    {
+        cerr << commandName << ": " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    compiler.write(cout, langCode);
+    return EXIT_SUCCESS;
+}
@@ -112,3 +112,106 @@ ModeTensePersonNumber::dump(Verbiste_ModeTensePersonNumber &destination) const
     destination.plural = (int) plural;
     destination.correct = (int) correct;
 }
+
+
+InflectionSlotTable::InflectionSlotTable()
+  : slots(),
+    slotNumbers(),
+    wordsPerSet(0),
+    setWords(),
+    setIndices(),
+    expandedSets()
+{
+}
+
+
+unsigned
+InflectionSlotTable::registerSlot(const ModeTensePersonNumber &m)
+{
+    assert(wordsPerSet == 0);  // no set added yet
+
+    PackedModeTensePersonNumber packed(m);
+    map<unsigned short, unsigned>::const_iterator it = slotNumbers.find(packed.bits);
+    if (it != slotNumbers.end())
+        return it->second;
+
+    unsigned slotNumber = unsigned(slots.size());
+    slots.push_back(packed);
+    slotNumbers[packed.bits] = slotNumber;
+    return slotNumber;
+}
+
+
+unsigned
+InflectionSlotTable::addSet(const vector<unsigned> &slotNumbersInSet)
+{
+    if (wordsPerSet == 0)  // if first set: slots are now all known
+        wordsPerSet = (slots.size() + BITS_PER_WORD - 1) / BITS_PER_WORD + (slots.empty() ? 1 : 0);
+
+    vector<unsigned> bitset(wordsPerSet, 0);
+    for (vector<unsigned>::const_iterator it = slotNumbersInSet.begin();
+                                          it != slotNumbersInSet.end(); ++it)
+    {
+        assert(*it < slots.size());
+        bitset[*it / BITS_PER_WORD] |= 1u << (*it % BITS_PER_WORD);
+    }
+
+    map<vector<unsigned>, unsigned>::const_iterator it = setIndices.find(bitset);
+    if (it != setIndices.end())
+        return it->second;
+
+    unsigned setIndex = unsigned(expandedSets.size());
+    setWords.insert(setWords.end(), bitset.begin(), bitset.end());
+    setIndices[bitset] = setIndex;
+
+    expandedSets.push_back(vector<ModeTensePersonNumber>());
+    vector<ModeTensePersonNumber> &expanded = expandedSets.back();
+    for (size_t w = 0; w < wordsPerSet; ++w)
+        for (unsigned word = bitset[w]; word != 0; word &= word - 1)
+            expanded.push_back(getSlot(unsigned(w * BITS_PER_WORD + findLowestBit(word))));
+
+    return setIndex;
+}
+
+
+size_t
+InflectionSlotTable::computeMemoryConsumption() const
+{
+    return sizeof(*this)
+           + slots.size() * sizeof(PackedModeTensePersonNumber)
+           + setWords.size() * sizeof(unsigned);
+}
+
+
+ConjugationBuffer::ConjugationBuffer()
+  : chars(),
+    partEnds(),
+    personEnds(),
+    tenseEnds()
+{
+}
+
+
+void
+ConjugationBuffer::clear()
+{
+    chars.clear();
+    partEnds.clear();
+    personEnds.clear();
+    tenseEnds.clear();
+}
+
+
+void
+ConjugationBuffer::appendForm(const char *subordinator, const char *pronoun,
+                              const string &radical, const string &ending)
+{
+    chars.append(subordinator);
+    partEnds.push_back(chars.size());
+    chars.append(pronoun);
+    partEnds.push_back(chars.size());
+    chars.append(radical);
+    partEnds.push_back(chars.size());
+    chars.append(ending);
+    partEnds.push_back(chars.size());
+}
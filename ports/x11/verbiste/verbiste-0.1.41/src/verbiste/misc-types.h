@@ -75,7 +75,24 @@ enum Tense
     PASSIVE_TENSE = VERBISTE_PASSIVE_TENSE,
     IMPERATIVE_ACTIVE_TENSE = VERBISTE_IMPERATIVE_ACTIVE_TENSE,
     IMPERATIVE_PASSIVE_TENSE = VERBISTE_IMPERATIVE_PASSIVE_TENSE,
-    PAST_PERFECT = VERBISTE_PAST_PERFECT
+    PAST_PERFECT = VERBISTE_PAST_PERFECT,
+
+    // Compound tenses, formed with an auxiliary (see PhraseAnalyzer):
+    COMPOUND_PAST_TENSE = VERBISTE_COMPOUND_PAST_TENSE,
+    PLUPERFECT_TENSE = VERBISTE_PLUPERFECT_TENSE,
+    PAST_ANTERIOR_TENSE = VERBISTE_PAST_ANTERIOR_TENSE,
+    FUTURE_ANTERIOR_TENSE = VERBISTE_FUTURE_ANTERIOR_TENSE
+};
+
+
+/**
+    Mode and tense of one of the tenses of a conjugation
+    (e.g., indicative present).
+*/
+struct ModeTense
+{
+    Mode mode;
+    Tense tense;
 };
 
 
@@ -172,12 +189,166 @@ public:
 };
 
 
+/**
+    ModeTensePersonNumber packed in 16 bits.
+    Bits 0-4 contain the mode, bits 5-8 the tense, bits 9-11 the person,
+    bit 12 is set for the plural and bit 13 is set for a correct inflection.
+*/
+class PackedModeTensePersonNumber
+{
+public:
+
+    /** Packed fields. */
+    unsigned short bits;
+
+    PackedModeTensePersonNumber(const ModeTensePersonNumber &m)
+      : bits(static_cast<unsigned short>(
+                  unsigned(m.mode)
+                | (unsigned(m.tense) << 5)
+                | (unsigned(m.person) << 9)
+                | (m.plural ? 1u << 12 : 0u)
+                | (m.correct ? 1u << 13 : 0u)))
+    {
+        assert(unsigned(m.mode) < 32);
+        assert(unsigned(m.tense) < 16);
+        assert(unsigned(m.person) < 8);
+    }
+
+    /** Returns the unpacked version of this object.
+    */
+    ModeTensePersonNumber unpack() const
+    {
+        ModeTensePersonNumber m;
+        m.mode = Mode(bits & 0x1F);
+        m.tense = Tense((bits >> 5) & 0x0F);
+        m.person = static_cast<unsigned char>((bits >> 9) & 0x07);
+        m.plural = (bits & (1u << 12)) != 0;
+        m.correct = (bits & (1u << 13)) != 0;
+        return m;
+    }
+};
+
+
+/**
+    Sets of ModeTensePersonNumber values, represented as bitsets.
+
+    Each distinct ModeTensePersonNumber value (called a slot) that is
+    registered receives a number, in order of first registration.
+    A set of slots is then represented by a bitset in which bit i
+    designates slot i.  All bitsets have the same number of words,
+    which is determined when the first set is added, and identical
+    sets are stored only once.  A set is designated by its index.
+
+    In a FrenchVerbDictionary, the slots are the mode-tense-person
+    combinations of the language, registered in the order in which
+    they appear in the conjugation file.  Since all templates list
+    them in the same order, enumerating a set by increasing slot number
+    gives the same order as in the conjugation file.
+*/
+class InflectionSlotTable
+{
+public:
+
+    /** Number of bits used in each word of a bitset. */
+    enum { BITS_PER_WORD = 32 };
+
+    InflectionSlotTable();
+
+    /** Returns the slot number of the given value, assigning a new
+        number if the value has not been registered yet.
+        Must not be called after addSet().
+    */
+    unsigned registerSlot(const ModeTensePersonNumber &m);
+
+    /** Returns the index of the set that contains the given slots,
+        adding it if no identical set is known yet.
+        @param  slotNumbers     numbers returned by registerSlot()
+    */
+    unsigned addSet(const std::vector<unsigned> &slotNumbers);
+
+    /** Returns the number of registered slots. */
+    size_t getNumSlots() const { return slots.size(); }
+
+    /** Returns the number of distinct sets. */
+    size_t getNumSets() const { return expandedSets.size(); }
+
+    /** Returns the number of words in each bitset. */
+    size_t getNumWordsPerSet() const { return wordsPerSet; }
+
+    /** Returns the words of the bitset of the given set.
+        The array contains getNumWordsPerSet() words.
+    */
+    const unsigned *getSetWords(unsigned setIndex) const
+    {
+        assert(setIndex < getNumSets());
+        return &setWords[setIndex * wordsPerSet];
+    }
+
+    /** Returns the value designated by the given slot number. */
+    ModeTensePersonNumber getSlot(unsigned slotNumber) const
+    {
+        assert(slotNumber < slots.size());
+        return slots[slotNumber].unpack();
+    }
+
+    /** Returns the values of the given set, by increasing slot number.
+    */
+    const std::vector<ModeTensePersonNumber> &getExpandedSet(unsigned setIndex) const
+    {
+        assert(setIndex < getNumSets());
+        return expandedSets[setIndex];
+    }
+
+    /** Returns the index of the lowest bit that is set in 'word',
+        which must not be zero.
+    */
+    static unsigned findLowestBit(unsigned word)
+    {
+        assert(word != 0);
+        #ifdef __GNUC__
+        return unsigned(__builtin_ctz(word));
+        #else
+        unsigned i = 0;
+        while ((word & 1u) == 0)
+            word >>= 1, ++i;
+        return i;
+        #endif
+    }
+
+    /** Computes and returns the number of memory bytes used by the
+        slots and the bitsets, excluding the expanded sets.
+    */
+    size_t computeMemoryConsumption() const;
+
+private:
+
+    std::vector<PackedModeTensePersonNumber> slots;
+    std::map<unsigned short, unsigned> slotNumbers;  // packed value -> slot number
+    size_t wordsPerSet;  // 0 until the first set is added
+    std::vector<unsigned> setWords;  // wordsPerSet words per set
+    std::map<std::vector<unsigned>, unsigned> setIndices;  // bitset -> set index
+    std::vector< std::vector<ModeTensePersonNumber> > expandedSets;
+};
+
+
 struct InflectionSpec
 {
     std::string inflection;
     bool isCorrect;
 
     InflectionSpec(const std::string &inf, bool c) : inflection(inf), isCorrect(c) {}
+
+    bool operator == (const InflectionSpec &s) const
+    {
+        return inflection == s.inflection && isCorrect == s.isCorrect;
+    }
+
+    bool operator < (const InflectionSpec &s) const
+    {
+        if (inflection != s.inflection)
+            return inflection < s.inflection;
+        return isCorrect < s.isCorrect;
+    }
 };
 
 
@@ -210,20 +381,53 @@ typedef std::map<Mode, ModeSpec> TemplateSpec;
 typedef std::map<std::string, TemplateSpec> ConjugationSystem;
 
 
+/**
+    List of persons, as stored by FrenchVerbDictionary.
+    Identical person specifications are stored once per FrenchVerbDictionary
+    and shared by all the tenses that use them.
+*/
+typedef std::vector<const PersonSpec *> SharedTenseSpec;
+
+
+/**
+    Mode specification, as stored by FrenchVerbDictionary.
+    Identical tense specifications (e.g., the imperfect of most "-er"
+    templates) are stored once per FrenchVerbDictionary and shared
+    by all the templates that use them.
+*/
+typedef std::map<Tense, const SharedTenseSpec *> SharedModeSpec;
+
+
+/** Conjugation template specification, as stored by FrenchVerbDictionary. */
+typedef std::map<Mode, SharedModeSpec> SharedTemplateSpec;
+
+
+/**
+    Conjugation system, as stored by FrenchVerbDictionary.
+    FrenchVerbDictionary::getTemplate() copies a template of this table
+    into a TemplateSpec.
+*/
+typedef std::map<std::string, SharedTemplateSpec> SharedConjugationSystem;
+
+
 /**
     Table of template names indexed by verb infinitive.
     If the verb "abaisser" follows the "aim:er" conjugation template,
     then a VerbTable would contain an entry where the key is "abaisser"
     and the value is a set containing "aim:er".
     An infinitive can be associated with more than one template.
+    FrenchVerbDictionary keeps its verbs in a VerbRecordTable; this type
+    is only used by its deprecated beginKnownVerbs() and endKnownVerbs().
 */
 typedef std::map< std::string, std::set<std::string> > VerbTable;
 
 
 /**
     Table that describes the mode, tense and person of a number of inflections.
+    Each inflection is associated with the index of a set of
+    mode-tense-person combinations in an InflectionSlotTable.
     For example, in the "aim:er" conjugation template, the inflection
-    (termination) "e" is associated with:
+    (termination) "e" is associated with a set containing:
 
     - the 1st person singular of the indicative present;
 
@@ -235,11 +439,11 @@ typedef std::map< std::string, std::set<std::string> > VerbTable;
 
     - the 2nd person singular of the imperative present.
 
-    Thus, in this table, the key "e" would be be associated with a vector
-    of five objects representing these five mode-tense-person combinations.
+    Thus, in this table, the key "e" would be be associated with a set
+    of these five mode-tense-person combinations.  The same set is used
+    by all the templates that accept "e" with the same meanings.
 */
-typedef std::map<std::string, std::vector<ModeTensePersonNumber> >
-                                            TemplateInflectionTable;
+typedef std::map<std::string, unsigned> TemplateInflectionTable;
 
 
 /**
@@ -252,6 +456,13 @@ typedef std::map<std::string, std::vector<ModeTensePersonNumber> >
 typedef std::map<std::string, TemplateInflectionTable> InflectionTable;
 
 
+/**
+    Table of template inflection tables, as stored by FrenchVerbDictionary.
+    Templates whose inflection tables are identical share a single copy.
+*/
+typedef std::map<std::string, const TemplateInflectionTable *> SharedInflectionTable;
+
+
 /**
     Description of a conjugated verb's inflection.
 */
@@ -282,4 +493,154 @@ public:
 };
 
 
+/**
+    Conjugated forms of a verb in one or more tenses.
+    This is the flat equivalent of a vector of tenses, where a tense is a
+    vector of persons and a person is a vector of forms (UTF-8 strings).
+    The characters of all the forms are stored contiguously, and the
+    forms, persons and tenses are delimited by arrays of offsets.
+
+    Each form is made of four consecutive parts, any of which may be empty:
+    the subordinator (e.g., "que "), the pronoun (e.g., "j'"), the radical
+    (e.g., "ai") and the ending (e.g., "e").  A form can thus be displayed
+    with or without its pronoun, and the verb itself can be examined,
+    without parsing the form again.
+
+    A buffer is meant to be reused: clear() empties it but keeps its
+    memory, so that filling it again normally allocates nothing.
+    The forms are not terminated by a null character.
+*/
+class ConjugationBuffer
+{
+public:
+
+    /** Parts of a form, in order. */
+    enum FormPart { SUBORDINATOR, PRONOUN, RADICAL, ENDING, NUM_FORM_PARTS };
+
+    ConjugationBuffer();
+
+    /** Empties this buffer without freeing its memory. */
+    void clear();
+
+    /** Returns the number of complete tenses in this buffer. */
+    size_t getNumTenses() const { return tenseEnds.size(); }
+
+    /** Returns the number of persons in the given tense. */
+    size_t getNumPersons(size_t tenseNo) const
+    {
+        assert(tenseNo < tenseEnds.size());
+        return tenseEnds[tenseNo] - getFirstPerson(tenseNo);
+    }
+
+    /** Returns the number of forms of the given person of the given tense. */
+    size_t getNumForms(size_t tenseNo, size_t personNo) const
+    {
+        size_t p = getFirstPerson(tenseNo) + personNo;
+        assert(p < personEnds.size());
+        return personEnds[p] - (p == 0 ? 0 : personEnds[p - 1]);
+    }
+
+    /** Returns the address of the first character of the given form,
+        or of the given part of that form.
+        @param  tenseNo     tense index (0..getNumTenses() - 1)
+        @param  personNo    person index (0..getNumPersons(tenseNo) - 1)
+        @param  formNo      form index (0..getNumForms(tenseNo, personNo) - 1)
+        @param  firstPart   first part of the form to consider;
+                            RADICAL designates the form without its
+                            subordinator and pronoun
+    */
+    const char *getFormData(size_t tenseNo, size_t personNo, size_t formNo,
+                            FormPart firstPart = SUBORDINATOR) const
+    {
+        return chars.data() + getPartStart(getFormIndex(tenseNo, personNo, formNo), firstPart);
+    }
+
+    /** Returns the number of bytes of the given form, from the
+        beginning of 'firstPart' to the end of the form.
+    */
+    size_t getFormLength(size_t tenseNo, size_t personNo, size_t formNo,
+                         FormPart firstPart = SUBORDINATOR) const
+    {
+        size_t f = getFormIndex(tenseNo, personNo, formNo);
+        return getPartEnd(f, ENDING) - getPartStart(f, firstPart);
+    }
+
+    /** Returns a copy of the given form, from the beginning of
+        'firstPart' to the end of the form.
+    */
+    std::string getForm(size_t tenseNo, size_t personNo, size_t formNo,
+                        FormPart firstPart = SUBORDINATOR) const
+    {
+        return std::string(getFormData(tenseNo, personNo, formNo, firstPart),
+                           getFormLength(tenseNo, personNo, formNo, firstPart));
+    }
+
+    /** Returns the address of the first character of a part of a form. */
+    const char *getPartData(size_t tenseNo, size_t personNo, size_t formNo,
+                            FormPart part) const
+    {
+        return getFormData(tenseNo, personNo, formNo, part);
+    }
+
+    /** Returns the number of bytes of a part of a form. */
+    size_t getPartLength(size_t tenseNo, size_t personNo, size_t formNo,
+                         FormPart part) const
+    {
+        size_t f = getFormIndex(tenseNo, personNo, formNo);
+        return getPartEnd(f, part) - getPartStart(f, part);
+    }
+
+    /** Appends a form made of the given parts.
+        @param  subordinator    null-terminated subordinator (may be empty)
+        @param  pronoun         null-terminated pronoun (may be empty)
+        @param  radical         radical of the verb
+        @param  ending          ending of the verb
+    */
+    void appendForm(const char *subordinator, const char *pronoun,
+                    const std::string &radical, const std::string &ending);
+
+    /** Ends the person being written, which contains the forms appended
+        since the previous person.
+    */
+    void endPerson() { personEnds.push_back(partEnds.size() / NUM_FORM_PARTS); }
+
+    /** Ends the tense being written, which contains the persons ended
+        since the previous tense.
+    */
+    void endTense() { tenseEnds.push_back(personEnds.size()); }
+
+private:
+
+    size_t getFirstPerson(size_t tenseNo) const
+    {
+        return tenseNo == 0 ? 0 : tenseEnds[tenseNo - 1];
+    }
+
+    size_t getFormIndex(size_t tenseNo, size_t personNo, size_t formNo) const
+    {
+        size_t p = getFirstPerson(tenseNo) + personNo;
+        assert(p < personEnds.size());
+        size_t f = (p == 0 ? 0 : personEnds[p - 1]) + formNo;
+        assert(f < personEnds[p]);
+        return f;
+    }
+
+    size_t getPartEnd(size_t formIndex, FormPart part) const
+    {
+        return partEnds[formIndex * NUM_FORM_PARTS + part];
+    }
+
+    size_t getPartStart(size_t formIndex, FormPart part) const
+    {
+        size_t i = formIndex * NUM_FORM_PARTS + part;
+        return i == 0 ? 0 : partEnds[i - 1];
+    }
+
+    std::string chars;
+    std::vector<size_t> partEnds;  // offset in 'chars' of the end of each part of each form
+    std::vector<size_t> personEnds;  // number of forms at the end of each person
+    std::vector<size_t> tenseEnds;  // index in 'personEnds' of the end of each tense
+};
+
+
 #endif  /* _H_misc_types */